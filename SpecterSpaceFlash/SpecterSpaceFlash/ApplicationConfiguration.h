@@ -77,6 +77,165 @@ SOFTWARE.
 
 #define STK500_PORT_BAUDRATE 115200
 
+/** @brief Application flash of the target below the boot loader, 32 KB less optiboot on the ATmega328P. */
+#define STK500_FLASH_SIZE 0x7E00UL
+
+/** @brief Size of the target flash page in bytes. */
+#define STK500_PAGE_SIZE 128
+
+/** @brief Time the target takes to erase and write a page in ms. */
+#define STK500_PAGE_WRITE_TIME 5
+
+#pragma endregion
+
+#pragma region Flash Pipeline
+
+/** @brief Number of page buffers decoded ahead of the target. */
+#define FLASH_PIPELINE_DEPTH 2
+
+/** @brief Size of the block buffer the HEX lines are read through. */
+#define HEX_READER_BLOCK_SIZE 512
+
+/** @brief Attempts of a page after the first one failed. */
+#define FLASH_PAGE_RETRIES 2
+
+/** @brief Recent jobs kept in the timeline. */
+#define FLASH_TIMELINE_JOBS 4
+
+/** @brief Power of two histogram buckets of the phase times, the last one takes the rest. */
+#define FLASH_TIMELINE_BUCKETS 20
+
+#pragma endregion
+
+#pragma region Flash Jobs
+
+/** @brief Jobs waiting or running at the same time. */
+#define FLASH_JOB_QUEUE_SIZE 4
+
+/** @brief Jobs kept for the status API, finished ones included. */
+#define FLASH_JOB_SLOTS 8
+
+/** @brief Maximum length of a job file path. */
+#define FLASH_JOB_PATH_SIZE 32
+
+/** @brief Time a job may hold the main loop per call in ms. */
+#define FLASH_JOB_SLICE 20
+
+/** @brief Folder of the target flash dumps. */
+#define FLASH_JOB_DUMP_DIR "/dump"
+
+/** @brief Pin every image that flashed without error as the golden image. */
+#define GOLDEN_AUTO_PIN
+
+#pragma endregion
+
+#pragma region Stream Flash
+
+/** @brief Receive buffer of the stream-through flashing.
+ *  Must hold the TCP window plus one segment, the window is held back while the UART is behind.
+ */
+#define STREAM_FLASH_BUFFER_SIZE 8192
+
+/** @brief Folder of the images stored while streaming. */
+#define STREAM_FLASH_STORE_DIR "/hex"
+
+#pragma endregion
+
+#pragma region Image Store
+
+/** @brief Folder of the images, stored by content hash. */
+#define IMAGE_STORE_DIR "/img"
+
+/** @brief Manifest of the stored images. */
+#define IMAGE_STORE_INDEX "/img/index"
+
+/** @brief Names the manifest can hold. */
+#define IMAGE_STORE_ENTRIES 32
+
+/** @brief Maximum length of an image name, same as a job path. */
+#define IMAGE_NAME_SIZE FLASH_JOB_PATH_SIZE
+
+/** @brief Maximum length of the MCU name of an image. */
+#define IMAGE_MCU_SIZE 12
+
+/** @brief MCU of the images uploaded without one. */
+#define IMAGE_DEFAULT_MCU "atmega328p"
+
+/** @brief Store the images as LZSS compressed pages instead of Intel HEX text. */
+#define IMAGE_STORE_PACKED
+
+/** @brief Intel HEX lines packed per pass of the main loop. */
+#define IMAGE_PACK_STEP_LINES 16
+
+/** @brief Bytes the stored images may use, 0 for the whole file system. */
+#define IMAGE_STORE_QUOTA 0
+
+/** @brief Bytes kept free in the file system for its own housekeeping. */
+#define IMAGE_STORE_HEADROOM 16384
+
+/** @brief Evictions kept for the storage API. */
+#define IMAGE_EVICTION_HISTORY 8
+
+/** @brief Pages tracked one by one while an upload is scanned, 64 KB of 128 byte pages. */
+#define IMAGE_PAGE_MAP_PAGES 512
+
+#pragma endregion
+
+#pragma region Legacy Upload
+
+/** @brief Editor uploads running at the same time. */
+#define UPLOAD_CONTEXTS 4
+
+/** @brief Uploads of the programmer page running at the same time. */
+#define IMAGE_UPLOAD_CONTEXTS 2
+
+#pragma endregion
+
+#pragma region Upload Sessions
+
+/** @brief Folder of the resumable upload sessions and their chunks. */
+#define UPLOAD_SESSION_DIR "/up"
+
+/** @brief Upload sessions kept at the same time. */
+#define UPLOAD_SESSIONS 4
+
+/** @brief Bytes of one chunk, every chunk but the last has this size. */
+#define UPLOAD_CHUNK_SIZE 4096
+
+/** @brief Chunks of one session, limits the image size. */
+#define UPLOAD_SESSION_CHUNKS 128
+
+/** @brief Read buffer of the commit on the stack of the main loop. */
+#define UPLOAD_COMMIT_BUFFER_SIZE 512
+
+#pragma endregion
+
+#pragma region Admission
+
+/** @brief Requests served at the same time, lwIP of the core has 5 TCP connections. */
+#define ADMISSION_MAX_REQUESTS 4
+
+/** @brief Part of ADMISSION_MAX_REQUESTS kept for the upload and flash routes. */
+#define ADMISSION_RESERVED 1
+
+/** @brief Free heap under which requests are refused, upload and flash routes go on down to the half. */
+#define ADMISSION_MIN_HEAP 12288
+
+/** @brief Largest free block under which requests are refused, upload and flash routes go on down to the half. */
+#define ADMISSION_MIN_BLOCK 4096
+
+/** @brief Clients with a request rate limit, the least recently seen one is forgotten. */
+#define ADMISSION_CLIENTS 8
+
+/** @brief Requests per second of one client. */
+#define ADMISSION_RATE 10
+
+/** @brief Requests one client may send at once. */
+#define ADMISSION_BURST 20
+
+/** @brief Seconds in the Retry-After header of a refused request. */
+#define ADMISSION_RETRY_AFTER 2
+
 #pragma endregion
 
 
@@ -97,10 +256,58 @@ SOFTWARE.
 
 #pragma endregion
 
+#pragma region WiFi Scan
+
+/** @brief Networks kept from a scan, the strongest ones. */
+#define SCAN_NETWORKS 16
+
+/** @brief Age in ms after which a request for the networks starts a new scan. */
+#define SCAN_CACHE_TTL 60000UL
+
+/** @brief Minimum time in ms between two scans asked for by the refresh API. */
+#define SCAN_MIN_INTERVAL 10000UL
+
+/** @brief Time in ms without uploads and flashing before a scan may start. */
+#define SCAN_QUIET_TIME 5000UL
+
+#pragma endregion
+
 #pragma region HTTP WEB / Authentication
 
 #define PORT_HTTP 80
 
+/** @brief Server-Sent Events endpoint of the flash progress. */
+#define PROGRESS_EVENTS_PATH "/api/v1/events"
+
+/** @brief Minimum time between two progress events in ms. */
+#define PROGRESS_EVENT_INTERVAL 250
+
+/** @brief Serve the web UI from the program flash, generate it with tools/embed_assets.py.
+ *  Embedded paths shadow files of the same name in the file system.
+ */
+#define WEB_ASSETS_EMBEDDED
+
+/** @brief Size of the JSON document of the status API v2. */
+#define STATUS_JSON_SIZE 1280
+
+/** @brief Buffer of one item of a chunked response, a network or a file of a list. */
+#define CHUNKED_ITEM_SIZE 256
+
+/** @brief Files outside the image store kept in the RAM index with their size and ETag. */
+#define FILE_INDEX_ENTRIES 32
+
+/** @brief Cache time of versioned assets, requested with "?v=", in seconds. */
+#define ASSET_MAX_AGE 31536000UL
+
+/** @brief Lifetime of a session token in seconds. */
+#define SESSION_LIFETIME 3600UL
+
+/** @brief Logged out tokens remembered until they expire. */
+#define SESSION_REVOKED 8
+
+/** @brief Name of the session cookie. */
+#define SESSION_COOKIE "SSF_SESSION"
+
 /** @brief Default HTTP username. */
 #define DEFAULT_HTTP_USERNAME "admin"
 
@@ -116,6 +323,28 @@ SOFTWARE.
 
 #pragma endregion
 
+#pragma region File System
+
+/** @brief Keep the files in LittleFS instead of SPIFFS, needs ESP8266 core 2.6 or newer.
+ *  Both use the same partition, the first boot moves config.json over
+ *  and lists the SPIFFS images that must be uploaded again in STORAGE_LOST_FILE.
+ */
+//#define STORAGE_LITTLEFS
+
+/** @brief Images left behind by the move to LittleFS. */
+#define STORAGE_LOST_FILE "/lost.txt"
+
+/** @brief Time open, list and read with 50, 200 and 500 images at boot. */
+//#define STORAGE_BENCHMARK
+
+/** @brief Size of the images written by the benchmark. */
+#define STORAGE_BENCHMARK_FILE_SIZE 1024
+
+/** @brief Upload chunks are gathered to writes of this size, a multiple of the 256 byte page. */
+#define STORAGE_WRITE_BLOCK 1024
+
+#pragma endregion
+
 #pragma region OTA Updates
 
 #define SERVER_DOMAIN "http://specter.space.flash.com"
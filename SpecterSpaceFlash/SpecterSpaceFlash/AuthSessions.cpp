@@ -0,0 +1,322 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "AuthSessions.h"
+
+#pragma region AuthSessionsClass
+
+/** @brief Draw the key and clear the revocation list.
+ *  @return Void.
+ */
+void AuthSessionsClass::begin()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	rotate();
+}
+
+/** @brief Draw a new key, every issued token stops working.
+ *  @return Void.
+ */
+void AuthSessionsClass::rotate()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	for (uint8 index = 0; index < AUTH_BLOCK_SIZE; index += 4)
+	{
+		uint32 RandomL = RANDOM_REG32;
+		memcpy(&_key[index], &RandomL, 4);
+	}
+
+	// Old tokens fail the MAC check now.
+	memset(_revoked, 0, sizeof(_revoked));
+}
+
+/** @brief Compare credentials with the configured ones in constant time.
+ *  @param username const String&, Given username.
+ *  @param password const String&, Given password.
+ *  @return bool, True when both match.
+ */
+bool AuthSessionsClass::checkCredentials(const String& username, const String& password)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	// Digests of equal length, the time does not depend on the text.
+	uint8 GivenL[AUTH_DIGEST_SIZE];
+	uint8 ExpectedL[AUTH_DIGEST_SIZE];
+
+	sha1(username + ":" + password, GivenL);
+	mac(GivenL, AUTH_DIGEST_SIZE, GivenL);
+
+	sha1(DeviceConfiguration.HTTPUsername + ":" + DeviceConfiguration.HTTPPassword, ExpectedL);
+	mac(ExpectedL, AUTH_DIGEST_SIZE, ExpectedL);
+
+	return equals(GivenL, ExpectedL, AUTH_DIGEST_SIZE);
+}
+
+/** @brief Issue a token.
+ *  @param token char*, Buffer of SESSION_TOKEN_LENGTH + 1 characters.
+ *  @return Void.
+ */
+void AuthSessionsClass::issue(char* token)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	snprintf(token, SESSION_TOKEN_CLAIMS + 1, "%08x%08x", (unsigned int)(now() + SESSION_LIFETIME), (unsigned int)RANDOM_REG32);
+
+	uint8 DigestL[AUTH_DIGEST_SIZE];
+	mac((const uint8*)token, SESSION_TOKEN_CLAIMS, DigestL);
+
+	for (uint8 index = 0; index < AUTH_DIGEST_SIZE; index++)
+	{
+		sprintf(&token[SESSION_TOKEN_CLAIMS + index * 2], "%02x", DigestL[index]);
+	}
+}
+
+/** @brief Check the token of a request, from "Authorization: Bearer" or the session cookie.
+ *  @param request AsyncWebServerRequest*, Request object.
+ *  @return bool, True for a valid token.
+ */
+bool AuthSessionsClass::verify(AsyncWebServerRequest* request)
+{
+	char TokenL[SESSION_TOKEN_LENGTH + 1];
+
+	return tokenOf(request, TokenL) && verify(TokenL);
+}
+
+/** @brief Check a token.
+ *  @param token const char*, Token.
+ *  @return bool, True when signed with the current key, not expired and not revoked.
+ */
+bool AuthSessionsClass::verify(const char* token)
+{
+	if (strlen(token) != SESSION_TOKEN_LENGTH)
+	{
+		return false;
+	}
+
+	uint8 DigestL[AUTH_DIGEST_SIZE];
+	mac((const uint8*)token, SESSION_TOKEN_CLAIMS, DigestL);
+
+	char ExpectedL[AUTH_DIGEST_SIZE * 2 + 1];
+	for (uint8 index = 0; index < AUTH_DIGEST_SIZE; index++)
+	{
+		sprintf(&ExpectedL[index * 2], "%02x", DigestL[index]);
+	}
+
+	if (!equals((const uint8*)&token[SESSION_TOKEN_CLAIMS], (const uint8*)ExpectedL, AUTH_DIGEST_SIZE * 2))
+	{
+		return false;
+	}
+
+	// The claims are ours from here on.
+	char ClaimL[9] = { 0 };
+	memcpy(ClaimL, token, 8);
+	uint32 ExpiresAtL = strtoul(ClaimL, NULL, 16);
+	memcpy(ClaimL, &token[8], 8);
+	uint32 NonceL = strtoul(ClaimL, NULL, 16);
+
+	if (ExpiresAtL <= now())
+	{
+		return false;
+	}
+
+	for (uint8 index = 0; index < SESSION_REVOKED; index++)
+	{
+		if (_revoked[index].ExpiresAt != 0 && _revoked[index].Nonce == NonceL)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/** @brief Revoke the token of a request.
+ *  @param request AsyncWebServerRequest*, Request object.
+ *  @return Void.
+ */
+void AuthSessionsClass::revoke(AsyncWebServerRequest* request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	char TokenL[SESSION_TOKEN_LENGTH + 1];
+	if (!tokenOf(request, TokenL) || !verify(TokenL))
+	{
+		return;
+	}
+
+	char ClaimL[9] = { 0 };
+	memcpy(ClaimL, TokenL, 8);
+	uint32 ExpiresAtL = strtoul(ClaimL, NULL, 16);
+	memcpy(ClaimL, &TokenL[8], 8);
+	uint32 NonceL = strtoul(ClaimL, NULL, 16);
+
+	uint32 NowL = now();
+	for (uint8 index = 0; index < SESSION_REVOKED; index++)
+	{
+		// Expired tokens fail anyway, their entries are free.
+		if (_revoked[index].ExpiresAt <= NowL)
+		{
+			_revoked[index].Nonce = NonceL;
+			_revoked[index].ExpiresAt = ExpiresAtL;
+			return;
+		}
+	}
+
+	// No room to remember it, end all sessions instead.
+	DEBUGLOG("Revocation list is full.\r\n");
+	rotate();
+}
+
+/** @brief Set-Cookie value of a token.
+ *  @param token const char*, Token, NULL to clear the cookie.
+ *  @return String, Header value.
+ */
+String AuthSessionsClass::cookie(const char* token)
+{
+	// Not sent with cross-site requests, the GET routes change state.
+	if (token == NULL)
+	{
+		return String(SESSION_COOKIE) + "=; Path=/; HttpOnly; SameSite=Strict; Max-Age=0";
+	}
+
+	return String(SESSION_COOKIE) + "=" + token + "; Path=/; HttpOnly; SameSite=Strict; Max-Age=" + String(SESSION_LIFETIME);
+}
+
+/** @brief Find the token of a request.
+ *  @param request AsyncWebServerRequest*, Request object.
+ *  @param token char*, Buffer of SESSION_TOKEN_LENGTH + 1 characters.
+ *  @return bool, True when a token was found.
+ */
+bool AuthSessionsClass::tokenOf(AsyncWebServerRequest* request, char* token)
+{
+	String ValueL;
+	int StartL = -1;
+
+	if (request->hasHeader("Authorization"))
+	{
+		ValueL = request->header("Authorization");
+		if (ValueL.startsWith("Bearer "))
+		{
+			StartL = 7;
+		}
+	}
+
+	if (StartL < 0 && request->hasHeader("Cookie"))
+	{
+		ValueL = request->header("Cookie");
+		String NameL = String(SESSION_COOKIE) + "=";
+		StartL = ValueL.indexOf(NameL);
+		if (StartL >= 0)
+		{
+			StartL += NameL.length();
+		}
+	}
+
+	if (StartL < 0 || ValueL.length() < (unsigned int)StartL + SESSION_TOKEN_LENGTH)
+	{
+		return false;
+	}
+
+	memcpy(token, ValueL.c_str() + StartL, SESSION_TOKEN_LENGTH);
+	token[SESSION_TOKEN_LENGTH] = '\0';
+
+	return true;
+}
+
+/** @brief HMAC-SHA1 with the session key.
+ *  @param data const uint8*, Message.
+ *  @param len size_t, Length of the message, up to AUTH_MESSAGE_SIZE.
+ *  @param digest uint8*, AUTH_DIGEST_SIZE bytes.
+ *  @return Void.
+ */
+void AuthSessionsClass::mac(const uint8* data, size_t len, uint8* digest)
+{
+	uint8 BufferL[AUTH_BLOCK_SIZE + AUTH_MESSAGE_SIZE];
+
+	if (len > AUTH_MESSAGE_SIZE)
+	{
+		len = AUTH_MESSAGE_SIZE;
+	}
+
+	// Inner hash, the message may be the digest buffer itself.
+	for (uint8 index = 0; index < AUTH_BLOCK_SIZE; index++)
+	{
+		BufferL[index] = _key[index] ^ 0x36;
+	}
+	memcpy(&BufferL[AUTH_BLOCK_SIZE], data, len);
+	sha1(BufferL, AUTH_BLOCK_SIZE + len, digest);
+
+	// Outer hash.
+	for (uint8 index = 0; index < AUTH_BLOCK_SIZE; index++)
+	{
+		BufferL[index] = _key[index] ^ 0x5C;
+	}
+	memcpy(&BufferL[AUTH_BLOCK_SIZE], digest, AUTH_DIGEST_SIZE);
+	sha1(BufferL, AUTH_BLOCK_SIZE + AUTH_DIGEST_SIZE, digest);
+}
+
+/** @brief Compare without an early exit.
+ *  @param left const uint8*, First buffer.
+ *  @param right const uint8*, Second buffer.
+ *  @param len size_t, Length of both.
+ *  @return bool, True when equal.
+ */
+bool AuthSessionsClass::equals(const uint8* left, const uint8* right, size_t len)
+{
+	uint8 DiffL = 0;
+
+	for (size_t index = 0; index < len; index++)
+	{
+		DiffL |= left[index] ^ right[index];
+	}
+
+	return DiffL == 0;
+}
+
+/** @brief Seconds since boot.
+ *  @return uint32, Time.
+ */
+uint32 AuthSessionsClass::now()
+{
+	// millis() / 1000 wraps after 49.7 days and would bring expired tokens back.
+	return (uint32)(micros64() / 1000000ULL);
+}
+
+#pragma endregion
+
+/* @brief Singelton session instance. */
+AuthSessionsClass AuthSessions;
@@ -0,0 +1,181 @@
+// AuthSessions.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _AUTHSESSIONS_h
+#define _AUTHSESSIONS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <Hash.h>
+#include <ESPAsyncTCP.h>
+#include <ESPAsyncWebServer.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#include "DeviceConfiguration.h"
+
+#pragma endregion
+
+#pragma region Definitions
+
+/** @brief Size of a SHA-1 digest. */
+#define AUTH_DIGEST_SIZE 20
+
+/** @brief Block size of SHA-1, the HMAC key is padded to it. */
+#define AUTH_BLOCK_SIZE 64
+
+/** @brief Largest message signed by the HMAC. */
+#define AUTH_MESSAGE_SIZE 32
+
+/** @brief Hex digits of the expiry and the nonce, the signed part of a token. */
+#define SESSION_TOKEN_CLAIMS 16
+
+/** @brief Length of a token, claims and the hex HMAC. */
+#define SESSION_TOKEN_LENGTH (SESSION_TOKEN_CLAIMS + AUTH_DIGEST_SIZE * 2)
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Revoked token, kept until it expires anyway.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint32 Nonce; ///< Nonce of the token.
+	uint32 ExpiresAt; ///< Expiry of the token, 0 for a free entry.
+} RevokedToken_t;
+
+#pragma endregion
+
+/** @brief Signed session tokens of the web server.
+ *
+ *  A token is "<expiry><nonce><HMAC-SHA1>" in hex, the key is drawn
+ *  from the hardware RNG at boot, so a reset ends every session.
+ *  Checking a token costs one HMAC and a scan of the revocation list,
+ *  the credentials are only compared at the login.
+ */
+class AuthSessionsClass
+{
+public:
+
+	/** @brief Draw the key and clear the revocation list.
+	 *  @return Void.
+	 */
+	void begin();
+
+	/** @brief Draw a new key, every issued token stops working.
+	 *  @return Void.
+	 */
+	void rotate();
+
+	/** @brief Compare credentials with the configured ones in constant time.
+	 *  @param username const String&, Given username.
+	 *  @param password const String&, Given password.
+	 *  @return bool, True when both match.
+	 */
+	bool checkCredentials(const String& username, const String& password);
+
+	/** @brief Issue a token.
+	 *  @param token char*, Buffer of SESSION_TOKEN_LENGTH + 1 characters.
+	 *  @return Void.
+	 */
+	void issue(char* token);
+
+	/** @brief Check the token of a request, from "Authorization: Bearer" or the session cookie.
+	 *  @param request AsyncWebServerRequest*, Request object.
+	 *  @return bool, True for a valid token.
+	 */
+	bool verify(AsyncWebServerRequest* request);
+
+	/** @brief Check a token.
+	 *  @param token const char*, Token.
+	 *  @return bool, True when signed with the current key, not expired and not revoked.
+	 */
+	bool verify(const char* token);
+
+	/** @brief Revoke the token of a request.
+	 *  @param request AsyncWebServerRequest*, Request object.
+	 *  @return Void.
+	 */
+	void revoke(AsyncWebServerRequest* request);
+
+	/** @brief Set-Cookie value of a token.
+	 *  @param token const char*, Token, NULL to clear the cookie.
+	 *  @return String, Header value.
+	 */
+	static String cookie(const char* token);
+
+private:
+
+	/** @brief Find the token of a request.
+	 *  @param request AsyncWebServerRequest*, Request object.
+	 *  @param token char*, Buffer of SESSION_TOKEN_LENGTH + 1 characters.
+	 *  @return bool, True when a token was found.
+	 */
+	static bool tokenOf(AsyncWebServerRequest* request, char* token);
+
+	/** @brief HMAC-SHA1 with the session key.
+	 *  @param data const uint8*, Message.
+	 *  @param len size_t, Length of the message, up to AUTH_MESSAGE_SIZE.
+	 *  @param digest uint8*, AUTH_DIGEST_SIZE bytes.
+	 *  @return Void.
+	 */
+	void mac(const uint8* data, size_t len, uint8* digest);
+
+	/** @brief Compare without an early exit.
+	 *  @param left const uint8*, First buffer.
+	 *  @param right const uint8*, Second buffer.
+	 *  @param len size_t, Length of both.
+	 *  @return bool, True when equal.
+	 */
+	static bool equals(const uint8* left, const uint8* right, size_t len);
+
+	/** @brief Seconds since boot.
+	 *  @return uint32, Time.
+	 */
+	static uint32 now();
+
+	/* @brief Key of the HMAC. */
+	uint8 _key[AUTH_BLOCK_SIZE];
+
+	/* @brief Revoked tokens. */
+	RevokedToken_t _revoked[SESSION_REVOKED];
+};
+
+/* @brief Singelton session instance. */
+extern AuthSessionsClass AuthSessions;
+
+#endif
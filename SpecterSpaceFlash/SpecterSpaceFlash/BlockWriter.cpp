@@ -0,0 +1,204 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "BlockWriter.h"
+
+#pragma region BlockWriter
+
+/** @brief Destructor, the buffer is freed, the data in it is lost.
+ */
+BlockWriter::~BlockWriter()
+{
+	if (_buffer != NULL)
+	{
+		free(_buffer);
+	}
+}
+
+/** @brief Take the file and allocate the buffer.
+ *  @param file File, File open for writing.
+ *  @param size size_t, Block size.
+ *  @return bool, The file is open.
+ */
+bool BlockWriter::begin(File file, size_t size)
+{
+	discard();
+
+	_file = file;
+	_fill = 0;
+	_chunks = 0;
+	_writes = 0;
+	_failed = false;
+	_size = size;
+
+	// Low memory still uploads, only slower.
+	if (_size > 0)
+	{
+		_buffer = (uint8*)malloc(_size);
+	}
+
+	return (bool)_file;
+}
+
+/** @brief Buffer the data, full blocks go to the file.
+ *  @param data const uint8*, Data.
+ *  @param len size_t, Length of the data.
+ *  @return size_t, Accepted bytes, short after a write error.
+ */
+size_t BlockWriter::write(const uint8* data, size_t len)
+{
+	if (!_file || _failed)
+	{
+		return 0;
+	}
+
+	_chunks++;
+
+	if (_buffer == NULL)
+	{
+		return put(data, len) ? len : 0;
+	}
+
+	size_t DoneL = 0;
+	while (DoneL < len)
+	{
+		// Whole blocks skip the copy when the buffer is empty.
+		if (_fill == 0 && len - DoneL >= _size)
+		{
+			size_t BlocksL = ((len - DoneL) / _size) * _size;
+			if (!put(data + DoneL, BlocksL))
+			{
+				return DoneL;
+			}
+			DoneL += BlocksL;
+			continue;
+		}
+
+		size_t PartL = _size - _fill;
+		if (PartL > len - DoneL)
+		{
+			PartL = len - DoneL;
+		}
+
+		memcpy(_buffer + _fill, data + DoneL, PartL);
+		_fill += PartL;
+		DoneL += PartL;
+
+		if (_fill == _size && !flush())
+		{
+			return DoneL - PartL;
+		}
+	}
+
+	return DoneL;
+}
+
+/** @brief Write the buffered data.
+ *  @return bool, No write error so far.
+ */
+bool BlockWriter::flush()
+{
+	if (_fill > 0 && _file && !_failed)
+	{
+		put(_buffer, _fill);
+	}
+	_fill = 0;
+
+	return !_failed;
+}
+
+/** @brief Flush, close the file and free the buffer.
+ *  @return bool, No write error so far.
+ */
+bool BlockWriter::close()
+{
+	bool StateL = flush();
+	discard();
+
+	return StateL;
+}
+
+/** @brief Close the file and free the buffer without writing the buffered data.
+ *  @return Void.
+ */
+void BlockWriter::discard()
+{
+	if (_file)
+	{
+		_file.close();
+	}
+
+	if (_buffer != NULL)
+	{
+		free(_buffer);
+		_buffer = NULL;
+	}
+
+	_fill = 0;
+}
+
+/** @brief Writes handed in.
+ *  @return uint32, Count since begin().
+ */
+uint32 BlockWriter::chunks()
+{
+	return _chunks;
+}
+
+/** @brief Writes done to the file.
+ *  @return uint32, Count since begin().
+ */
+uint32 BlockWriter::writes()
+{
+	return _writes;
+}
+
+/** @brief Check for an open file.
+ *  @return bool, True while open.
+ */
+BlockWriter::operator bool()
+{
+	return (bool)_file;
+}
+
+/** @brief Write to the file and count it.
+ *  @param data const uint8*, Data.
+ *  @param len size_t, Length of the data.
+ *  @return bool, All bytes written.
+ */
+bool BlockWriter::put(const uint8* data, size_t len)
+{
+	_writes++;
+
+	if (_file.write(data, len) != len)
+	{
+		DEBUGLOG("Write error, %u bytes\r\n", len);
+		_failed = true;
+	}
+
+	return !_failed;
+}
+
+#pragma endregion
@@ -0,0 +1,136 @@
+// BlockWriter.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _BLOCKWRITER_h
+#define _BLOCKWRITER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <FS.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#pragma endregion
+
+/** @brief Gathers small writes into whole blocks.
+ *
+ *  Upload handlers get TCP segments of 536 to 1460 bytes, written one
+ *  by one each of them ends in a partial page and a metadata update.
+ *  Without the buffer memory the writes go straight to the file.
+ */
+class BlockWriter
+{
+public:
+
+	/** @brief Destructor, the buffer is freed, the data in it is lost.
+	 */
+	~BlockWriter();
+
+	/** @brief Take the file and allocate the buffer.
+	 *  @param file File, File open for writing.
+	 *  @param size size_t, Block size.
+	 *  @return bool, The file is open.
+	 */
+	bool begin(File file, size_t size = STORAGE_WRITE_BLOCK);
+
+	/** @brief Buffer the data, full blocks go to the file.
+	 *  @param data const uint8*, Data.
+	 *  @param len size_t, Length of the data.
+	 *  @return size_t, Accepted bytes, short after a write error.
+	 */
+	size_t write(const uint8* data, size_t len);
+
+	/** @brief Write the buffered data.
+	 *  @return bool, No write error so far.
+	 */
+	bool flush();
+
+	/** @brief Flush, close the file and free the buffer.
+	 *  @return bool, No write error so far.
+	 */
+	bool close();
+
+	/** @brief Close the file and free the buffer without writing the buffered data.
+	 *  @return Void.
+	 */
+	void discard();
+
+	/** @brief Writes handed in.
+	 *  @return uint32, Count since begin().
+	 */
+	uint32 chunks();
+
+	/** @brief Writes done to the file.
+	 *  @return uint32, Count since begin().
+	 */
+	uint32 writes();
+
+	/** @brief Check for an open file.
+	 *  @return bool, True while open.
+	 */
+	operator bool();
+
+private:
+
+	/** @brief Write to the file and count it.
+	 *  @param data const uint8*, Data.
+	 *  @param len size_t, Length of the data.
+	 *  @return bool, All bytes written.
+	 */
+	bool put(const uint8* data, size_t len);
+
+	/* @brief Destination file. */
+	File _file;
+
+	/* @brief Block buffer, NULL for direct writes. */
+	uint8* _buffer = NULL;
+
+	/* @brief Block size. */
+	size_t _size = 0;
+
+	/* @brief Bytes in the buffer. */
+	size_t _fill = 0;
+
+	/* @brief Writes handed in. */
+	uint32 _chunks = 0;
+
+	/* @brief Writes done to the file. */
+	uint32 _writes = 0;
+
+	/* @brief A write came up short. */
+	bool _failed = false;
+};
+
+#endif
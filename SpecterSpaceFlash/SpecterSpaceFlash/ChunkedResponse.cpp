@@ -0,0 +1,197 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "ChunkedResponse.h"
+
+#pragma region Structures
+
+/** @brief State of a response between two TCP buffers.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct ChunkState_t {
+	ChunkRenderer Renderer; ///< Item writer.
+	char Text[CHUNKED_ITEM_SIZE]; ///< Current item.
+	size_t Length; ///< Length of the current item.
+	size_t Sent; ///< Sent part of the current item.
+	uint16 Item; ///< Next item number.
+	bool Done; ///< The renderer has ended.
+	uint32 StartHeap; ///< Free heap before the response.
+	uint32 LowestHeap; ///< Lowest free heap seen while filling.
+
+	/** @brief Destructor, the response is gone.
+	 */
+	~ChunkState_t()
+	{
+		ChunkedResponse.record(StartHeap - LowestHeap);
+	}
+} ChunkState_t;
+
+#pragma endregion
+
+#pragma region ChunkedResponseClass
+
+/** @brief Create a response that pulls its items from a renderer.
+ *  @param request AsyncWebServerRequest*, Request object.
+ *  @param contentType const String&, MIME type.
+ *  @param renderer ChunkRenderer, Item writer.
+ *  @return AsyncWebServerResponse*, The response to send.
+ */
+AsyncWebServerResponse* ChunkedResponseClass::begin(AsyncWebServerRequest* request, const String& contentType, ChunkRenderer renderer)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	uint32 HeapL = ESP.getFreeHeap();
+
+	std::shared_ptr<ChunkState_t> StateL = std::make_shared<ChunkState_t>();
+	StateL->Renderer = renderer;
+	StateL->Length = 0;
+	StateL->Sent = 0;
+	StateL->Item = 0;
+	StateL->Done = false;
+	StateL->StartHeap = HeapL;
+	StateL->LowestHeap = ESP.getFreeHeap();
+
+	return request->beginChunkedResponse(contentType, [StateL](uint8* buffer, size_t maxLen, size_t index) -> size_t
+	{
+		size_t WrittenL = 0;
+
+		while (WrittenL < maxLen)
+		{
+			// Next item once the current one is out.
+			if (StateL->Sent == StateL->Length)
+			{
+				if (StateL->Done)
+				{
+					break;
+				}
+
+				size_t LengthL = StateL->Renderer(StateL->Item++, StateL->Text, CHUNKED_ITEM_SIZE);
+				if (LengthL == CHUNK_END)
+				{
+					StateL->Done = true;
+					StateL->Length = 0;
+					StateL->Sent = 0;
+					break;
+				}
+
+				StateL->Length = (LengthL < CHUNKED_ITEM_SIZE) ? LengthL : CHUNKED_ITEM_SIZE - 1;
+				StateL->Sent = 0;
+				continue;
+			}
+
+			size_t CountL = StateL->Length - StateL->Sent;
+			if (CountL > maxLen - WrittenL)
+			{
+				CountL = maxLen - WrittenL;
+			}
+
+			memcpy(buffer + WrittenL, StateL->Text + StateL->Sent, CountL);
+			StateL->Sent += CountL;
+			WrittenL += CountL;
+		}
+
+		uint32 HeapL = ESP.getFreeHeap();
+		if (HeapL < StateL->LowestHeap)
+		{
+			StateL->LowestHeap = HeapL;
+		}
+
+		return WrittenL;
+	});
+}
+
+/** @brief Write a JSON string with the quotes, cut to the buffer.
+ *  @param text char*, Buffer.
+ *  @param size size_t, Size of the buffer.
+ *  @param value const char*, Plain text.
+ *  @return size_t, Length written.
+ */
+size_t ChunkedResponseClass::quote(char* text, size_t size, const char* value)
+{
+	size_t LengthL = 0;
+
+	// Room for the closing quote and the terminator.
+	if (size < 3)
+	{
+		if (size > 0)
+		{
+			text[0] = '\0';
+		}
+		return 0;
+	}
+
+	text[LengthL++] = '"';
+	for (; *value != '\0' && LengthL + 8 < size; value++)
+	{
+		char CharL = *value;
+		if (CharL == '"' || CharL == '\\')
+		{
+			text[LengthL++] = '\\';
+			text[LengthL++] = CharL;
+		}
+		else if ((uint8)CharL < 0x20)
+		{
+			LengthL += sprintf(text + LengthL, "\\u%04x", (uint8)CharL);
+		}
+		else
+		{
+			text[LengthL++] = CharL;
+		}
+	}
+	text[LengthL++] = '"';
+	text[LengthL] = '\0';
+
+	return LengthL;
+}
+
+/** @brief Largest heap drop during a response.
+ *  @return uint32, Bytes.
+ */
+uint32 ChunkedResponseClass::peak()
+{
+	return _peak;
+}
+
+/** @brief Record the heap drop of a finished response.
+ *  @param used uint32, Bytes.
+ *  @return Void.
+ */
+void ChunkedResponseClass::record(uint32 used)
+{
+	DEBUGLOG("Chunked response heap use: %u\r\n", used);
+
+	if (used > _peak)
+	{
+		_peak = used;
+	}
+}
+
+#pragma endregion
+
+/* @brief Singelton chunked response instance. */
+ChunkedResponseClass ChunkedResponse;
@@ -0,0 +1,116 @@
+// ChunkedResponse.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _CHUNKEDRESPONSE_h
+#define _CHUNKEDRESPONSE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <functional>
+#include <memory>
+
+#include <ESPAsyncTCP.h>
+#include <ESPAsyncWebServer.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#pragma endregion
+
+#pragma region Definitions
+
+/** @brief Renderer result that ends the response. */
+#define CHUNK_END ((size_t)-1)
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Writes one item of a response.
+ *  @param item uint16, Item number, from 0.
+ *  @param text char*, Item buffer.
+ *  @param size size_t, Size of the buffer.
+ *  @return size_t, Length of the item, 0 for nothing, CHUNK_END after the last one.
+ */
+typedef std::function<size_t(uint16 item, char* text, size_t size)> ChunkRenderer;
+
+#pragma endregion
+
+/** @brief Responses written item by item into the TCP buffer.
+ *
+ *  The body is never held as a whole, a request costs the item buffer
+ *  and the renderer however long the list is. The heap drop of every
+ *  response is measured and the largest one is kept.
+ */
+class ChunkedResponseClass
+{
+public:
+
+	/** @brief Create a response that pulls its items from a renderer.
+	 *  @param request AsyncWebServerRequest*, Request object.
+	 *  @param contentType const String&, MIME type.
+	 *  @param renderer ChunkRenderer, Item writer.
+	 *  @return AsyncWebServerResponse*, The response to send.
+	 */
+	AsyncWebServerResponse* begin(AsyncWebServerRequest* request, const String& contentType, ChunkRenderer renderer);
+
+	/** @brief Write a JSON string with the quotes, cut to the buffer.
+	 *  @param text char*, Buffer.
+	 *  @param size size_t, Size of the buffer.
+	 *  @param value const char*, Plain text.
+	 *  @return size_t, Length written.
+	 */
+	static size_t quote(char* text, size_t size, const char* value);
+
+	/** @brief Largest heap drop during a response.
+	 *  @return uint32, Bytes.
+	 */
+	uint32 peak();
+
+	/** @brief Record the heap drop of a finished response.
+	 *  @param used uint32, Bytes.
+	 *  @return Void.
+	 */
+	void record(uint32 used);
+
+private:
+
+	/* @brief Largest heap drop during a response. */
+	uint32 _peak = 0;
+};
+
+/* @brief Singelton chunked response instance. */
+extern ChunkedResponseClass ChunkedResponse;
+
+#endif
@@ -24,6 +24,8 @@ SOFTWARE.
 
 #include "DeviceConfiguration.h"
 
+#include "FileIndex.h"
+
 /* @brief Singelton device configuration instance. */
 DeviceConfiguration_t DeviceConfiguration;
 
@@ -82,6 +84,7 @@ bool load_device_configuration(FS* fileSystem) {
 	DeviceConfiguration.HTTPPassword = json["HTTPPassword"].as<const char *>();
 	DeviceConfiguration.HTTPAuthentication = json["HTTPAuthentication"];
 	DeviceConfiguration.DeviceName = json["DeviceName"].as<const char *>();
+	DeviceConfiguration.GoldenImage = json["GoldenImage"].as<const char *>();
 
 #ifdef ENABLE_CAYENNE_MODE
 
@@ -110,6 +113,7 @@ void set_default_device_configuration(FS* fileSystem) {
 	DeviceConfiguration.HTTPPassword = DEFAULT_HTTP_PASSWORD;
 	DeviceConfiguration.HTTPAuthentication = false;
 	DeviceConfiguration.DeviceName = DEVICE_BRAND;
+	DeviceConfiguration.GoldenImage = "";
 
 #ifdef ENABLE_CAYENNE_MODE
 
@@ -143,6 +147,7 @@ bool save_device_configuration(FS* fileSystem) {
 	json["HTTPPassword"] = DeviceConfiguration.HTTPPassword;
 	json["HTTPAuthentication"] = DeviceConfiguration.HTTPAuthentication;
 	json["DeviceName"] = DeviceConfiguration.DeviceName;
+	json["GoldenImage"] = DeviceConfiguration.GoldenImage;
 
 #ifdef ENABLE_CAYENNE_MODE
 
@@ -170,6 +175,7 @@ bool save_device_configuration(FS* fileSystem) {
 	json.printTo(configFile);
 	configFile.flush();
 	configFile.close();
+	FileIndex.update(CONFIG_FILE);
 
 	return true;
 }
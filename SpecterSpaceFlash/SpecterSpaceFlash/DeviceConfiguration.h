@@ -61,6 +61,7 @@ typedef struct {
 	String HTTPPassword;
 	bool HTTPAuthentication;
 	String DeviceName;
+	String GoldenImage; ///< Last known good image of the target, empty for none.
 
 #ifdef ENABLE_CAYENNE_MODE
 
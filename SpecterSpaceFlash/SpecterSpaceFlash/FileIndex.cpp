@@ -0,0 +1,297 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "FileIndex.h"
+
+#pragma region FileIndexClass
+
+/** @brief Walk the file system and fill the index.
+ *  @param fs FS*, File system.
+ *  @return Void.
+ */
+void FileIndexClass::begin(FS* fs)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_fileSystem = fs;
+	memset(_entries, 0, sizeof(_entries));
+	_complete = true;
+
+	walk("/");
+
+	DEBUGLOG("File index complete: %d\r\n", _complete);
+}
+
+/** @brief Add the files of a directory and of its subdirectories.
+ *  @param directory String, Path of the directory.
+ *  @return Void.
+ */
+void FileIndexClass::walk(const String& directory)
+{
+	Dir DirL = _fileSystem->openDir(directory);
+	while (DirL.next())
+	{
+		// Keyed by the full path with either backend.
+		String PathL = Storage.entryPath(DirL, directory);
+		if (PathL.length() == 0 || managed(PathL))
+		{
+			continue;
+		}
+
+#if defined(STORAGE_LITTLEFS)
+
+		if (DirL.isDirectory())
+		{
+			walk(PathL);
+			continue;
+		}
+
+#endif // STORAGE_LITTLEFS
+
+		put(PathL, DirL.fileSize(), 0);
+	}
+}
+
+/** @brief Check that the index answers for a path.
+ *  @param path String, File or directory path.
+ *  @return bool, True when the index is complete and the path is not in a managed directory.
+ */
+bool FileIndexClass::covers(const String& path)
+{
+	return _complete && !managed(path);
+}
+
+/** @brief Find a file.
+ *  @param path String, File path.
+ *  @return const FileIndexEntry_t*, The file or NULL.
+ */
+const FileIndexEntry_t* FileIndexClass::find(const String& path)
+{
+	return slot(path);
+}
+
+/** @brief Find the file to serve for a path, the gzipped variant first.
+ *  @param path String, File path without ".gz".
+ *  @return const FileIndexEntry_t*, The file or NULL.
+ */
+const FileIndexEntry_t* FileIndexClass::resolve(const String& path)
+{
+	const FileIndexEntry_t* EntryL = slot(path + ".gz");
+	if (EntryL == NULL)
+	{
+		EntryL = slot(path);
+	}
+
+	return EntryL;
+}
+
+/** @brief Get the ETag of a file, the content is hashed on the first call.
+ *  @param path String, File path.
+ *  @return const char*, Quoted MD5, valid until the next call, NULL when the file is not indexed.
+ */
+const char* FileIndexClass::tag(const String& path)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	FileIndexEntry_t* EntryL = slot(path);
+	if (EntryL == NULL)
+	{
+		return NULL;
+	}
+
+	if (!EntryL->Hashed)
+	{
+		File FileL = _fileSystem->open(path, "r");
+		if (!FileL)
+		{
+			return NULL;
+		}
+
+		MD5Builder Md5L;
+		uint8 BufferL[256];
+		int CountL;
+		Md5L.begin();
+		while ((CountL = FileL.read(BufferL, sizeof(BufferL))) > 0)
+		{
+			Md5L.add(BufferL, CountL);
+		}
+		FileL.close();
+		Md5L.calculate();
+		Md5L.getBytes(EntryL->Md5);
+		EntryL->Hashed = true;
+	}
+
+	_tag[0] = '"';
+	ImageStoreClass::hashToHex(EntryL->Md5, &_tag[1]);
+	_tag[IMAGE_HASH_SIZE * 2 + 1] = '"';
+	_tag[IMAGE_HASH_SIZE * 2 + 2] = '\0';
+
+	return _tag;
+}
+
+/** @brief Read the size of a changed file from the file system.
+ *  @param path String, File path.
+ *  @return Void.
+ */
+void FileIndexClass::update(const String& path)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (_fileSystem == NULL || managed(path))
+	{
+		return;
+	}
+
+	File FileL = _fileSystem->open(path, "r");
+	if (!FileL)
+	{
+		remove(path);
+		return;
+	}
+
+	uint32 SizeL = FileL.size();
+	FileL.close();
+
+	put(path, SizeL, ImageStoreClass::now());
+}
+
+/** @brief Record a changed file of a known size.
+ *  @param path String, File path.
+ *  @param size uint32, Size in bytes.
+ *  @return Void.
+ */
+void FileIndexClass::update(const String& path, uint32 size)
+{
+	if (managed(path))
+	{
+		return;
+	}
+
+	put(path, size, ImageStoreClass::now());
+}
+
+/** @brief Drop a removed file.
+ *  @param path String, File path.
+ *  @return Void.
+ */
+void FileIndexClass::remove(const String& path)
+{
+	FileIndexEntry_t* EntryL = slot(path);
+	if (EntryL != NULL)
+	{
+		memset(EntryL, 0, sizeof(FileIndexEntry_t));
+	}
+}
+
+/** @brief Get a file by slot.
+ *  @param index uint8, Slot.
+ *  @return const FileIndexEntry_t*, The file or NULL for a free slot.
+ */
+const FileIndexEntry_t* FileIndexClass::entry(uint8 index)
+{
+	if (index >= FILE_INDEX_ENTRIES || _entries[index].Path[0] == '\0')
+	{
+		return NULL;
+	}
+
+	return &_entries[index];
+}
+
+/** @brief Check for the directories with their own manifests.
+ *  @param path String, Path.
+ *  @return bool, True for paths of the image store and the upload sessions.
+ */
+bool FileIndexClass::managed(const String& path)
+{
+	// SPIFFS has no directories, the names are prefixes.
+	return path.startsWith(IMAGE_STORE_DIR "/") || path == IMAGE_STORE_DIR
+		|| path.startsWith(STREAM_FLASH_STORE_DIR "/") || path == STREAM_FLASH_STORE_DIR
+		|| path.startsWith(UPLOAD_SESSION_DIR "/") || path == UPLOAD_SESSION_DIR;
+}
+
+/** @brief Find the slot of a file.
+ *  @param path String, File path.
+ *  @return FileIndexEntry_t*, The file or NULL.
+ */
+FileIndexEntry_t* FileIndexClass::slot(const String& path)
+{
+	if (path.length() >= IMAGE_NAME_SIZE)
+	{
+		return NULL;
+	}
+
+	for (uint8 index = 0; index < FILE_INDEX_ENTRIES; index++)
+	{
+		if (_entries[index].Path[0] != '\0' && path == _entries[index].Path)
+		{
+			return &_entries[index];
+		}
+	}
+
+	return NULL;
+}
+
+/** @brief Add a file or update its entry.
+ *  @param path String, File path.
+ *  @param size uint32, Size in bytes.
+ *  @param modifiedAt uint32, Time of the change.
+ *  @return Void.
+ */
+void FileIndexClass::put(const String& path, uint32 size, uint32 modifiedAt)
+{
+	FileIndexEntry_t* EntryL = slot(path);
+
+	for (uint8 index = 0; EntryL == NULL && index < FILE_INDEX_ENTRIES; index++)
+	{
+		if (_entries[index].Path[0] == '\0')
+		{
+			EntryL = &_entries[index];
+		}
+	}
+
+	// A file the index can not hold makes every answer doubtful.
+	if (EntryL == NULL || path.length() >= IMAGE_NAME_SIZE)
+	{
+		DEBUGLOG("File index is full at %s\r\n", path.c_str());
+		_complete = false;
+		return;
+	}
+
+	memset(EntryL, 0, sizeof(FileIndexEntry_t));
+	strncpy(EntryL->Path, path.c_str(), IMAGE_NAME_SIZE - 1);
+	EntryL->Size = size;
+	EntryL->ModifiedAt = modifiedAt;
+}
+
+#pragma endregion
+
+/* @brief Singelton file index instance. */
+FileIndexClass FileIndex;
@@ -0,0 +1,177 @@
+// FileIndex.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _FILEINDEX_h
+#define _FILEINDEX_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <FS.h>
+#include <MD5Builder.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#include "ImageStore.h"
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Metadata of a file in the index.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	char Path[IMAGE_NAME_SIZE]; ///< Full path, empty for a free entry.
+	uint32 Size; ///< Size in bytes.
+	uint32 ModifiedAt; ///< Seconds of the last change seen, 0 when it was found at boot.
+	uint8 Md5[IMAGE_HASH_SIZE]; ///< Hash of the content, valid with Hashed.
+	bool Hashed; ///< The hash was calculated.
+} FileIndexEntry_t;
+
+#pragma endregion
+
+/** @brief Paths, sizes and hashes of the files served by the web server.
+ *
+ *  Built with one walk at boot and updated by the handlers that change
+ *  the files, so serving and listing do not touch the file system.
+ *  The directories of the image store and the upload sessions keep
+ *  their own manifests and are left out. When the files do not fit
+ *  the index is incomplete and the callers go to the file system.
+ */
+class FileIndexClass
+{
+public:
+
+	/** @brief Walk the file system and fill the index.
+	 *  @param fs FS*, File system.
+	 *  @return Void.
+	 */
+	void begin(FS* fs);
+
+	/** @brief Check that the index answers for a path.
+	 *  @param path String, File or directory path.
+	 *  @return bool, True when the index is complete and the path is not in a managed directory.
+	 */
+	bool covers(const String& path);
+
+	/** @brief Find a file.
+	 *  @param path String, File path.
+	 *  @return const FileIndexEntry_t*, The file or NULL.
+	 */
+	const FileIndexEntry_t* find(const String& path);
+
+	/** @brief Find the file to serve for a path, the gzipped variant first.
+	 *  @param path String, File path without ".gz".
+	 *  @return const FileIndexEntry_t*, The file or NULL.
+	 */
+	const FileIndexEntry_t* resolve(const String& path);
+
+	/** @brief Get the ETag of a file, the content is hashed on the first call.
+	 *  @param path String, File path.
+	 *  @return const char*, Quoted MD5, valid until the next call, NULL when the file is not indexed.
+	 */
+	const char* tag(const String& path);
+
+	/** @brief Read the size of a changed file from the file system.
+	 *  @param path String, File path.
+	 *  @return Void.
+	 */
+	void update(const String& path);
+
+	/** @brief Record a changed file of a known size.
+	 *  @param path String, File path.
+	 *  @param size uint32, Size in bytes.
+	 *  @return Void.
+	 */
+	void update(const String& path, uint32 size);
+
+	/** @brief Drop a removed file.
+	 *  @param path String, File path.
+	 *  @return Void.
+	 */
+	void remove(const String& path);
+
+	/** @brief Get a file by slot.
+	 *  @param index uint8, Slot.
+	 *  @return const FileIndexEntry_t*, The file or NULL for a free slot.
+	 */
+	const FileIndexEntry_t* entry(uint8 index);
+
+private:
+
+	/** @brief Check for the directories with their own manifests.
+	 *  @param path String, Path.
+	 *  @return bool, True for paths of the image store and the upload sessions.
+	 */
+	static bool managed(const String& path);
+
+	/** @brief Add the files of a directory and of its subdirectories.
+	 *  @param directory String, Path of the directory.
+	 *  @return Void.
+	 */
+	void walk(const String& directory);
+
+	/** @brief Find the slot of a file.
+	 *  @param path String, File path.
+	 *  @return FileIndexEntry_t*, The file or NULL.
+	 */
+	FileIndexEntry_t* slot(const String& path);
+
+	/** @brief Add a file or update its entry.
+	 *  @param path String, File path.
+	 *  @param size uint32, Size in bytes.
+	 *  @param modifiedAt uint32, Time of the change.
+	 *  @return Void.
+	 */
+	void put(const String& path, uint32 size, uint32 modifiedAt);
+
+	/* @brief File system object. */
+	FS* _fileSystem = NULL;
+
+	/* @brief Indexed files. */
+	FileIndexEntry_t _entries[FILE_INDEX_ENTRIES];
+
+	/* @brief All files outside the managed directories fit. */
+	bool _complete = false;
+
+	/* @brief Last formatted ETag. */
+	char _tag[IMAGE_HASH_SIZE * 2 + 3];
+};
+
+/* @brief Singelton file index instance. */
+extern FileIndexClass FileIndex;
+
+#endif
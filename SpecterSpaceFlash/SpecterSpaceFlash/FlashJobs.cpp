@@ -0,0 +1,646 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "FlashJobs.h"
+
+#include "FileIndex.h"
+
+/** @brief Attach the file system.
+ *  @param fs FS*, File system with the images.
+ *  @return Void.
+ */
+void FlashJobQueueClass::begin(FS* fs)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_fileSystem = fs;
+	memset(_jobs, 0, sizeof(_jobs));
+	_current = NULL;
+}
+
+/** @brief Run a slice of the current job. Call it from the main loop.
+ *  @return Void.
+ */
+void FlashJobQueueClass::handle()
+{
+	if (_current == NULL)
+	{
+		// Rollbacks go first, then the oldest queued job.
+		for (uint8 index = 0; index < FLASH_JOB_SLOTS; index++)
+		{
+			FlashJob_t* JobL = &_jobs[index];
+			if (JobL->State != JobStates::JobQueued)
+			{
+				continue;
+			}
+
+			if (_current == NULL ||
+				(JobL->RollbackOf != 0 && _current->RollbackOf == 0) ||
+				((JobL->RollbackOf != 0) == (_current->RollbackOf != 0) && JobL->Id < _current->Id))
+			{
+				_current = JobL;
+			}
+		}
+
+		if (_current == NULL)
+		{
+			return;
+		}
+
+		uint8 StartL = start(_current);
+		if (StartL != StatusCodes::Ok)
+		{
+			finish(_current, StartL);
+		}
+
+		return;
+	}
+
+	if (_current->Cancelled)
+	{
+		finish(_current, StatusCodes::Error);
+		return;
+	}
+
+	if (_current->Source != NULL && _current->SourceClosed)
+	{
+		FlashPipeline.endOfSource();
+	}
+
+	uint8 StateL = StatusCodes::Busy;
+	unsigned long SliceL = millis();
+
+	while (StateL == StatusCodes::Busy && (millis() - SliceL) < FLASH_JOB_SLICE)
+	{
+		StateL = FlashPipeline.process();
+	}
+
+	_current->PagesDone = FlashPipeline.pagesDone();
+	_current->SourceDone = FlashPipeline.sourcePosition();
+
+	if (StateL != StatusCodes::Busy)
+	{
+		finish(_current, StateL);
+	}
+}
+
+/** @brief Queue a job.
+ *  @param type uint8, Kind of the job.
+ *  @param path const char*, Image or dump file.
+ *  @param size uint32, Bytes to read for read jobs.
+ *  @param id uint16*, ID of the new job.
+ *  @return uint8, Ok, Busy when the queue is full, Error for bad arguments.
+ *  @see StatusCodes.h
+ */
+uint8 FlashJobQueueClass::enqueue(uint8 type, const char* path, uint32 size, uint16* id)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (type < JobTypes::JobFlash || type > JobTypes::JobRead)
+	{
+		return StatusCodes::Error;
+	}
+
+	char PathL[FLASH_JOB_PATH_SIZE];
+
+	if (type == JobTypes::JobRead)
+	{
+		if (size == 0)
+		{
+			return StatusCodes::Error;
+		}
+	}
+	else if (!ImageStore.resolve(path, PathL) || ImageStore.precheck(path, NULL) != StatusCodes::Ok)
+	{
+		return StatusCodes::Error;
+	}
+
+	FlashJob_t* SlotL = allocate();
+	if (SlotL == NULL)
+	{
+		return StatusCodes::Busy;
+	}
+
+	SlotL->Type = type;
+	SlotL->Size = size;
+	SlotL->Error = "";
+
+	if (type == JobTypes::JobRead)
+	{
+		snprintf(SlotL->Path, FLASH_JOB_PATH_SIZE, "%s/%u.bin", FLASH_JOB_DUMP_DIR, SlotL->Id);
+	}
+	else
+	{
+		strncpy(SlotL->Path, path, FLASH_JOB_PATH_SIZE - 1);
+	}
+
+	SlotL->State = JobStates::JobQueued;
+	*id = SlotL->Id;
+
+	DEBUGLOG("Job %u queued: %s %s\r\n", SlotL->Id, typeName(type), SlotL->Path);
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Queue a flash job fed from a stream while it is received.
+ *  @param source Stream*, Intel HEX source, valid until the job finishes.
+ *  @param name const char*, Name shown for the job.
+ *  @param size uint32, Expected size of the image, 0 if unknown.
+ *  @param id uint16*, ID of the new job.
+ *  @return uint8, Ok, Busy when the queue is full, Error for bad arguments.
+ *  @see StatusCodes.h
+ */
+uint8 FlashJobQueueClass::enqueueStream(Stream* source, const char* name, uint32 size, uint16* id)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (source == NULL)
+	{
+		return StatusCodes::Error;
+	}
+
+	FlashJob_t* SlotL = allocate();
+	if (SlotL == NULL)
+	{
+		return StatusCodes::Busy;
+	}
+
+	SlotL->Type = JobTypes::JobFlash;
+	SlotL->Size = size;
+	SlotL->Source = source;
+	SlotL->Error = "";
+	strncpy(SlotL->Path, name, FLASH_JOB_PATH_SIZE - 1);
+	SlotL->State = JobStates::JobQueued;
+	*id = SlotL->Id;
+
+	DEBUGLOG("Job %u queued: stream %s\r\n", SlotL->Id, SlotL->Path);
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Tell the job that its stream will not get more data.
+ *  @param id uint16, Job ID.
+ *  @return Void.
+ */
+void FlashJobQueueClass::closeSource(uint16 id)
+{
+	FlashJob_t* JobL = (FlashJob_t*)find(id);
+
+	if (JobL != NULL)
+	{
+		JobL->SourceClosed = true;
+	}
+}
+
+/** @brief Stop a queued or running job.
+ *  @param id uint16, Job ID.
+ *  @param reason const char*, Reason reported as the job error.
+ *  @return Void.
+ */
+void FlashJobQueueClass::cancel(uint16 id, const char* reason)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	FlashJob_t* JobL = (FlashJob_t*)find(id);
+
+	if (JobL == NULL || (JobL->State != JobStates::JobQueued && JobL->State != JobStates::JobRunning))
+	{
+		return;
+	}
+
+	JobL->Error = reason;
+	JobL->Cancelled = true;
+
+	if (JobL->State == JobStates::JobQueued)
+	{
+		JobL->State = JobStates::JobFailed;
+		JobL->FinishedAt = millis();
+	}
+}
+
+/** @brief Find a job.
+ *  @param id uint16, Job ID.
+ *  @return const FlashJob_t*, The job or NULL.
+ */
+const FlashJob_t* FlashJobQueueClass::find(uint16 id)
+{
+	for (uint8 index = 0; index < FLASH_JOB_SLOTS; index++)
+	{
+		if (id != 0 && _jobs[index].Id == id && _jobs[index].State != JobStates::JobFree)
+		{
+			return &_jobs[index];
+		}
+	}
+
+	return NULL;
+}
+
+/** @brief Get a job slot for listing.
+ *  @param index uint8, Slot index below FLASH_JOB_SLOTS.
+ *  @return const FlashJob_t*, The job or NULL for a free slot.
+ */
+const FlashJob_t* FlashJobQueueClass::slot(uint8 index)
+{
+	if (index >= FLASH_JOB_SLOTS || _jobs[index].State == JobStates::JobFree)
+	{
+		return NULL;
+	}
+
+	return &_jobs[index];
+}
+
+/** @brief Check for a job talking to the target.
+ *  @return bool, True while a job is running.
+ */
+bool FlashJobQueueClass::isBusy()
+{
+	return _current != NULL;
+}
+
+/** @brief Get the running job.
+ *  @return const FlashJob_t*, The job or NULL.
+ */
+const FlashJob_t* FlashJobQueueClass::current()
+{
+	return _current;
+}
+
+/** @brief Pin the last known good image of the target, by content so renames and deletes keep it.
+ *  @param path const char*, Image name or file, NULL or empty to unpin.
+ *  @return uint8, Ok, Error when the image is missing.
+ *  @see StatusCodes.h
+ */
+uint8 FlashJobQueueClass::pinGolden(const char* path)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	char PathL[FLASH_JOB_PATH_SIZE];
+	String PreviousL = DeviceConfiguration.GoldenImage;
+
+	if (path == NULL || path[0] == '\0')
+	{
+		DeviceConfiguration.GoldenImage = "";
+	}
+	else if (!ImageStore.resolve(path, PathL))
+	{
+		return StatusCodes::Error;
+	}
+	else
+	{
+		DeviceConfiguration.GoldenImage = PathL;
+	}
+
+	DEBUGLOG("Golden image: %s\r\n", DeviceConfiguration.GoldenImage.c_str());
+	save_device_configuration(_fileSystem);
+
+	// The previous image may have been kept only for the rollback.
+	if (PreviousL.length() > 0 && PreviousL != DeviceConfiguration.GoldenImage)
+	{
+		ImageStore.releaseFile(PreviousL.c_str());
+	}
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Get the last known good image of the target.
+ *  @return const char*, Image file, empty for none.
+ */
+const char* FlashJobQueueClass::golden()
+{
+	return DeviceConfiguration.GoldenImage.c_str();
+}
+
+/** @brief Estimate the page count of a job from its source.
+ *  @param job const FlashJob_t*, The job.
+ *  @return uint32, Expected pages.
+ */
+uint32 FlashJobQueueClass::pagesTotal(const FlashJob_t* job)
+{
+	if (job->State == JobStates::JobDone)
+	{
+		return job->PagesDone;
+	}
+
+	if (job->Type == JobTypes::JobRead)
+	{
+		return (job->SourceSize + STK500_PAGE_SIZE - 1) / STK500_PAGE_SIZE;
+	}
+
+	// HEX records are uniform, so extrapolate from the part already parsed.
+	if (job->SourceDone == 0 || job->PagesDone == 0)
+	{
+		return 0;
+	}
+
+	return (uint32)((uint64_t)job->PagesDone * job->SourceSize / job->SourceDone);
+}
+
+/** @brief Transfer rate of a job.
+ *  @param job const FlashJob_t*, The job.
+ *  @return uint32, Bytes per second.
+ */
+uint32 FlashJobQueueClass::bytesPerSecond(const FlashJob_t* job)
+{
+	if (job->State != JobStates::JobRunning && job->FinishedAt == 0)
+	{
+		return 0;
+	}
+
+	unsigned long EndL = (job->State == JobStates::JobRunning) ? millis() : job->FinishedAt;
+	unsigned long ElapsedL = EndL - job->StartedAt;
+
+	if (ElapsedL == 0)
+	{
+		return 0;
+	}
+
+	return (uint32)((uint64_t)job->PagesDone * STK500_PAGE_SIZE * 1000UL / ElapsedL);
+}
+
+/** @brief Name of a job type.
+ *  @param type uint8, Kind of the job.
+ *  @return const char*, Name used by the API.
+ */
+const char* FlashJobQueueClass::typeName(uint8 type)
+{
+	switch (type)
+	{
+	case JobTypes::JobFlash: return "flash";
+	case JobTypes::JobVerify: return "verify";
+	case JobTypes::JobRead: return "read";
+	}
+
+	return "unknown";
+}
+
+/** @brief Name of a job state.
+ *  @param state uint8, Life cycle state.
+ *  @return const char*, Name used by the API.
+ */
+const char* FlashJobQueueClass::stateName(uint8 state)
+{
+	switch (state)
+	{
+	case JobStates::JobQueued: return "queued";
+	case JobStates::JobRunning: return "running";
+	case JobStates::JobDone: return "done";
+	case JobStates::JobFailed: return "failed";
+	}
+
+	return "free";
+}
+
+/** @brief Open the files and prepare the target.
+ *  @param job FlashJob_t*, The job.
+ *  @return uint8, State of the start.
+ *  @see StatusCodes.h
+ */
+uint8 FlashJobQueueClass::start(FlashJob_t* job)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	job->State = JobStates::JobRunning;
+	job->StartedAt = millis();
+	FlashTimeline.begin(job->Id, job->Type);
+
+	if (job->Type == JobTypes::JobRead)
+	{
+		_file = _fileSystem->open(job->Path, "w");
+		if (!_file)
+		{
+			job->Error = "Can not create dump file";
+			return StatusCodes::Error;
+		}
+
+		job->SourceSize = job->Size;
+		_prepared = true;
+		return FlashPipeline.beginRead(&_file, job->Size);
+	}
+
+	if (job->Source != NULL)
+	{
+		job->SourceSize = job->Size;
+		_prepared = true;
+		return FlashPipeline.begin(job->Source, PipelineModes::PipelineProgram, job->SourceClosed);
+	}
+
+	char PathL[FLASH_JOB_PATH_SIZE];
+	if (ImageStore.resolve(job->Path, PathL))
+	{
+		_file = _fileSystem->open(PathL, "r");
+	}
+
+	if (!_file)
+	{
+		job->Error = "Image not found";
+		return StatusCodes::Error;
+	}
+
+	uint8 ModeL = (job->Type == JobTypes::JobVerify) ? PipelineModes::PipelineVerify : PipelineModes::PipelineProgram;
+
+	// Packed images carry a header, plain Intel HEX starts over.
+	PackedImageHeader_t HeaderL;
+	bool PackedL = (_file.read((uint8*)&HeaderL, sizeof(HeaderL)) == sizeof(HeaderL) &&
+		HeaderL.Magic == PACKED_IMAGE_MAGIC && HeaderL.Version == PACKED_IMAGE_VERSION);
+	if (!PackedL)
+	{
+		_file.seek(0, SeekSet);
+	}
+
+	job->SourceSize = _file.size();
+	_prepared = true;
+	return FlashPipeline.begin(&_file, ModeL, true, PackedL);
+}
+
+/** @brief Close the files and record the result.
+ *  @param job FlashJob_t*, The job.
+ *  @param state uint8, Result of the pipeline.
+ *  @return Void.
+ */
+void FlashJobQueueClass::finish(FlashJob_t* job, uint8 state)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	// Only a flash that wrote a page can leave the target half programmed.
+	bool WrittenL = false;
+
+	if (_prepared)
+	{
+		job->PagesDone = FlashPipeline.pagesDone();
+		job->SourceDone = FlashPipeline.sourcePosition();
+		WrittenL = (job->Type == JobTypes::JobFlash) && (job->PagesDone > 0);
+		FlashPipeline.end();
+		_prepared = false;
+	}
+
+	if (_file)
+	{
+		_file.close();
+	}
+
+	// The dump is a new file for the web server.
+	if (job->Type == JobTypes::JobRead)
+	{
+		FileIndex.update(job->Path);
+	}
+
+	FlashTimeline.end(state);
+	job->FinishedAt = millis();
+
+	if (state == StatusCodes::Ok)
+	{
+		job->State = JobStates::JobDone;
+
+		// Recently flashed images are the last to be evicted.
+		if (job->Type == JobTypes::JobFlash && job->Source == NULL)
+		{
+			ImageStore.touch(job->Path);
+		}
+
+#ifdef GOLDEN_AUTO_PIN
+
+		char PathL[FLASH_JOB_PATH_SIZE];
+		if (job->Type == JobTypes::JobFlash && job->Source == NULL && job->RollbackOf == 0 &&
+			ImageStore.resolve(job->Path, PathL) && strcmp(PathL, golden()) != 0)
+		{
+			pinGolden(PathL);
+		}
+
+#endif // GOLDEN_AUTO_PIN
+	}
+	else
+	{
+		job->State = JobStates::JobFailed;
+
+		if (job->Error == NULL || job->Error[0] == '\0')
+		{
+			if (FlashPipeline.hasMismatch()) job->Error = "Verify mismatch";
+			else if (state == StatusCodes::TimeOut) job->Error = "Target timeout";
+			else job->Error = "Target error";
+		}
+
+		// A verify only reads, its mismatch is reported and the target is left as it is.
+		if (WrittenL && job->RollbackOf == 0)
+		{
+			rollback(job);
+		}
+	}
+
+	DEBUGLOG("Job %u %s, pages: %u\r\n", job->Id, stateName(job->State), job->PagesDone);
+
+	_current = NULL;
+}
+
+/** @brief Queue the golden image after a failed job left the target half programmed.
+ *  @param job FlashJob_t*, The failed job.
+ *  @return Void.
+ */
+void FlashJobQueueClass::rollback(FlashJob_t* job)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	const char* GoldenL = golden();
+	if (GoldenL[0] == '\0' || !_fileSystem->exists(GoldenL))
+	{
+		DEBUGLOG("No golden image to roll back to.\r\n");
+		return;
+	}
+
+	FlashJob_t* SlotL = allocate();
+	if (SlotL == NULL)
+	{
+		DEBUGLOG("No slot for the rollback.\r\n");
+		return;
+	}
+
+	SlotL->Type = JobTypes::JobFlash;
+	SlotL->Error = "";
+	SlotL->RollbackOf = job->Id;
+	strncpy(SlotL->Path, GoldenL, FLASH_JOB_PATH_SIZE - 1);
+	SlotL->State = JobStates::JobQueued;
+	job->RollbackId = SlotL->Id;
+
+	DEBUGLOG("Job %u rolls back job %u to %s\r\n", SlotL->Id, job->Id, SlotL->Path);
+}
+
+/** @brief Take a slot for a new job.
+ *  @return FlashJob_t*, Cleared job with ID or NULL when the queue is full.
+ */
+FlashJob_t* FlashJobQueueClass::allocate()
+{
+	uint8 ActiveL = 0;
+	FlashJob_t* SlotL = NULL;
+
+	for (uint8 index = 0; index < FLASH_JOB_SLOTS; index++)
+	{
+		FlashJob_t* JobL = &_jobs[index];
+
+		if (JobL->State == JobStates::JobQueued || JobL->State == JobStates::JobRunning)
+		{
+			ActiveL++;
+			continue;
+		}
+
+		// Reuse a free slot, else the oldest finished one.
+		if (SlotL == NULL || JobL->State == JobStates::JobFree ||
+			(SlotL->State != JobStates::JobFree && JobL->Id < SlotL->Id))
+		{
+			SlotL = JobL;
+		}
+	}
+
+	if (ActiveL >= FLASH_JOB_QUEUE_SIZE || SlotL == NULL)
+	{
+		return NULL;
+	}
+
+	memset(SlotL, 0, sizeof(FlashJob_t));
+	SlotL->Id = _nextId++;
+	if (_nextId == 0)
+	{
+		_nextId = 1;
+	}
+
+	return SlotL;
+}
+
+/* @brief Singelton flash job queue instance. */
+FlashJobQueueClass FlashJobs;
@@ -0,0 +1,262 @@
+// FlashJobs.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _FLASHJOBS_h
+#define _FLASHJOBS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <FS.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#include "StatusCodes.h"
+
+#include "DeviceConfiguration.h"
+
+#include "ImageStore.h"
+
+#include "FlashPipeline.h"
+
+#include "FlashTimeline.h"
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Kinds of jobs. */
+enum JobTypes : uint8
+{
+	JobFlash = 1U, ///< Program an image to the target.
+	JobVerify, ///< Compare an image with the target.
+	JobRead, ///< Dump the target flash to a file.
+};
+
+/** @brief Life cycle of a job. */
+enum JobStates : uint8
+{
+	JobFree = 0U, ///< Slot is not used.
+	JobQueued, ///< Waiting for the target.
+	JobRunning, ///< Talking to the target.
+	JobDone, ///< Finished successfully.
+	JobFailed, ///< Finished with an error.
+};
+
+/** @brief Flash job.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint16 Id; ///< Job ID, never 0.
+	uint8 Type; ///< Kind of the job.
+	uint8 State; ///< Life cycle state.
+	char Path[FLASH_JOB_PATH_SIZE]; ///< Image name or dump file.
+	uint32 Size; ///< Bytes to read for read jobs.
+	uint32 PagesDone; ///< Pages acknowledged by the target.
+	uint32 SourceSize; ///< Size of the image or bytes to read.
+	uint32 SourceDone; ///< Bytes of the source already handled.
+	unsigned long StartedAt; ///< millis() when the job started.
+	unsigned long FinishedAt; ///< millis() when the job finished.
+	const char* Error; ///< Reason of the failure.
+	Stream* Source; ///< Image source instead of the file, NULL for files.
+	bool SourceClosed; ///< The source will not get more data.
+	bool Cancelled; ///< Stop the job at the next slice.
+	uint16 RollbackId; ///< Job re-programming the golden image after this one failed, 0 for none.
+	uint16 RollbackOf; ///< Failed job this rollback recovers from, 0 for none.
+} FlashJob_t;
+
+#pragma endregion
+
+/** @brief Bounded queue of jobs, run one after another on the target.
+ *
+ *  Jobs are stepped from the main loop in short slices,
+ *  so HTTP handlers only queue work and return.
+ */
+class FlashJobQueueClass
+{
+public:
+
+	/** @brief Attach the file system.
+	 *  @param fs FS*, File system with the images.
+	 *  @return Void.
+	 */
+	void begin(FS* fs);
+
+	/** @brief Run a slice of the current job. Call it from the main loop.
+	 *  @return Void.
+	 */
+	void handle();
+
+	/** @brief Queue a job.
+	 *  @param type uint8, Kind of the job.
+	 *  @param path const char*, Image or dump file.
+	 *  @param size uint32, Bytes to read for read jobs.
+	 *  @param id uint16*, ID of the new job.
+	 *  @return uint8, Ok, Busy when the queue is full, Error for bad arguments.
+	 *  @see StatusCodes.h
+	 */
+	uint8 enqueue(uint8 type, const char* path, uint32 size, uint16* id);
+
+	/** @brief Queue a flash job fed from a stream while it is received.
+	 *  @param source Stream*, Intel HEX source, valid until the job finishes.
+	 *  @param name const char*, Name shown for the job.
+	 *  @param size uint32, Expected size of the image, 0 if unknown.
+	 *  @param id uint16*, ID of the new job.
+	 *  @return uint8, Ok, Busy when the queue is full, Error for bad arguments.
+	 *  @see StatusCodes.h
+	 */
+	uint8 enqueueStream(Stream* source, const char* name, uint32 size, uint16* id);
+
+	/** @brief Tell the job that its stream will not get more data.
+	 *  @param id uint16, Job ID.
+	 *  @return Void.
+	 */
+	void closeSource(uint16 id);
+
+	/** @brief Stop a queued or running job.
+	 *  @param id uint16, Job ID.
+	 *  @param reason const char*, Reason reported as the job error.
+	 *  @return Void.
+	 */
+	void cancel(uint16 id, const char* reason);
+
+	/** @brief Find a job.
+	 *  @param id uint16, Job ID.
+	 *  @return const FlashJob_t*, The job or NULL.
+	 */
+	const FlashJob_t* find(uint16 id);
+
+	/** @brief Get a job slot for listing.
+	 *  @param index uint8, Slot index below FLASH_JOB_SLOTS.
+	 *  @return const FlashJob_t*, The job or NULL for a free slot.
+	 */
+	const FlashJob_t* slot(uint8 index);
+
+	/** @brief Check for a job talking to the target.
+	 *  @return bool, True while a job is running.
+	 */
+	bool isBusy();
+
+	/** @brief Get the running job.
+	 *  @return const FlashJob_t*, The job or NULL.
+	 */
+	const FlashJob_t* current();
+
+	/** @brief Pin the last known good image of the target, by content so renames and deletes keep it.
+	 *  @param path const char*, Image name or file, NULL or empty to unpin.
+	 *  @return uint8, Ok, Error when the image is missing.
+	 *  @see StatusCodes.h
+	 */
+	uint8 pinGolden(const char* path);
+
+	/** @brief Get the last known good image of the target.
+	 *  @return const char*, Image file, empty for none.
+	 */
+	const char* golden();
+
+	/** @brief Estimate the page count of a job from its source.
+	 *  @param job const FlashJob_t*, The job.
+	 *  @return uint32, Expected pages.
+	 */
+	static uint32 pagesTotal(const FlashJob_t* job);
+
+	/** @brief Transfer rate of a job.
+	 *  @param job const FlashJob_t*, The job.
+	 *  @return uint32, Bytes per second.
+	 */
+	static uint32 bytesPerSecond(const FlashJob_t* job);
+
+	/** @brief Name of a job type.
+	 *  @param type uint8, Kind of the job.
+	 *  @return const char*, Name used by the API.
+	 */
+	static const char* typeName(uint8 type);
+
+	/** @brief Name of a job state.
+	 *  @param state uint8, Life cycle state.
+	 *  @return const char*, Name used by the API.
+	 */
+	static const char* stateName(uint8 state);
+
+private:
+
+	/** @brief Open the files and prepare the target.
+	 *  @param job FlashJob_t*, The job.
+	 *  @return uint8, State of the start.
+	 *  @see StatusCodes.h
+	 */
+	uint8 start(FlashJob_t* job);
+
+	/** @brief Close the files and record the result.
+	 *  @param job FlashJob_t*, The job.
+	 *  @param state uint8, Result of the pipeline.
+	 *  @return Void.
+	 */
+	void finish(FlashJob_t* job, uint8 state);
+
+	/** @brief Queue the golden image after a failed job left the target half programmed.
+	 *  @param job FlashJob_t*, The failed job.
+	 *  @return Void.
+	 */
+	void rollback(FlashJob_t* job);
+
+	/** @brief Take a slot for a new job.
+	 *  @return FlashJob_t*, Cleared job with ID or NULL when the queue is full.
+	 */
+	FlashJob_t* allocate();
+
+	/* @brief File system with the images. */
+	FS* _fileSystem = NULL;
+
+	/* @brief Job slots. */
+	FlashJob_t _jobs[FLASH_JOB_SLOTS];
+
+	/* @brief Running job. */
+	FlashJob_t* _current = NULL;
+
+	/* @brief Image or dump of the running job. */
+	File _file;
+
+	/* @brief The target is in programming mode. */
+	bool _prepared = false;
+
+	/* @brief ID of the next job. */
+	uint16 _nextId = 1;
+};
+
+/* @brief Singelton flash job queue instance. */
+extern FlashJobQueueClass FlashJobs;
+
+#endif
@@ -0,0 +1,449 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "FlashPipeline.h"
+
+/** @brief Constructor.
+ *  @return FlashPipelineClass
+ */
+FlashPipelineClass::FlashPipelineClass()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+}
+
+/** @brief Prepare the target and start a new image.
+ *  @param source Stream*, Intel HEX source, or LZSS compressed pages when packed.
+ *  @param mode uint8, Program or verify the image.
+ *  @param finite bool, False for sources still receiving data.
+ *  @param packed bool, The source is a packed image after its header.
+ *  @return uint8, State of the pipeline.
+ *  @see StatusCodes.h
+ */
+uint8 FlashPipelineClass::begin(Stream* source, uint8 mode, bool finite, bool packed)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_mode = mode;
+	_mismatch = false;
+	_retries = 0;
+	_sink = NULL;
+	_source = source;
+	_reader.begin(source, finite);
+	_head = 0;
+	_count = 0;
+	_inFlight = false;
+	_endOfImage = false;
+	_pagesDone = 0;
+	_parser.Reset();
+	_packed = packed;
+	_decodeTime = 0;
+
+	if (_packed)
+	{
+		_unpack.begin(source);
+	}
+
+	STK500.prepareTarget();
+
+	return StatusCodes::Ok;
+}
+
+/** @brief The source will not get more data.
+ *  @return Void.
+ */
+void FlashPipelineClass::endOfSource()
+{
+	_reader.setFinite(true);
+}
+
+/** @brief Prepare the target and start reading its flash.
+ *  @param sink Print*, Destination of the flash content.
+ *  @param size uint32, Bytes to read.
+ *  @return uint8, State of the pipeline.
+ *  @see StatusCodes.h
+ */
+uint8 FlashPipelineClass::beginRead(Print* sink, uint32 size)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_mode = PipelineModes::PipelineRead;
+	_mismatch = false;
+	_retries = 0;
+	_sink = sink;
+	_readSize = size;
+	_source = NULL;
+	_head = 0;
+	_count = 0;
+	_inFlight = false;
+	_endOfImage = false;
+	_pagesDone = 0;
+
+	STK500.prepareTarget();
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Do one non blocking step of the pipeline.
+ *  @return uint8, Busy while running, else the result of the image.
+ *  @see StatusCodes.h
+ */
+uint8 FlashPipelineClass::process()
+{
+	if (_mode == PipelineModes::PipelineRead)
+	{
+		return processRead();
+	}
+
+	if (_source == NULL)
+	{
+		return StatusCodes::Error;
+	}
+
+	// Move the page in flight forward first, so the UART never waits for the parser.
+	if (_inFlight)
+	{
+		uint8 StateL = STK500.pollPage();
+
+		if (StateL == StatusCodes::Busy)
+		{
+			// The target is busy, use the time to decode ahead.
+			return decodeLine() == StatusCodes::Error ? StatusCodes::Error : StatusCodes::Busy;
+		}
+
+		_inFlight = false;
+
+		if (StateL != StatusCodes::Ok)
+		{
+			DEBUGLOG("Page %u failed: %d\r\n", _pagesDone, StateL);
+			if (!retryPage())
+			{
+				return StateL;
+			}
+
+			startHead();
+			return StatusCodes::Busy;
+		}
+
+		if (_mode == PipelineModes::PipelineVerify &&
+			memcmp(_readBack, _pages[_head].Data, STK500_PAGE_SIZE) != 0)
+		{
+			DEBUGLOG("Page %u differs.\r\n", _pagesDone);
+			_mismatch = true;
+			return StatusCodes::Error;
+		}
+
+		_head = (_head + 1) % FLASH_PIPELINE_DEPTH;
+		_count--;
+		_pagesDone++;
+		_retries = 0;
+	}
+
+	if (_count > 0)
+	{
+		startHead();
+		return StatusCodes::Busy;
+	}
+
+	if (_endOfImage)
+	{
+		return StatusCodes::Ok;
+	}
+
+	return decodeLine() == StatusCodes::Error ? StatusCodes::Error : StatusCodes::Busy;
+}
+
+/** @brief Run the pipeline until the image is done.
+ *  @return uint8, Result of the image.
+ *  @see StatusCodes.h
+ */
+uint8 FlashPipelineClass::run()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	uint8 StateL = StatusCodes::Busy;
+
+	while (StateL == StatusCodes::Busy)
+	{
+		StateL = process();
+
+#if defined(ARDUINO_ARCH_ESP8266)
+		ESP.wdtFeed();
+#endif
+	}
+
+	DEBUGLOG("Pages flashed: %u\r\n", _pagesDone);
+
+	return StateL;
+}
+
+/** @brief Take the target out of programming mode.
+ *  @return Void.
+ */
+void FlashPipelineClass::end()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	STK500.exitProgMode();
+	_source = NULL;
+	_sink = NULL;
+}
+
+/** @brief Pages acknowledged by the target.
+ *  @return uint32, Page count.
+ */
+uint32 FlashPipelineClass::pagesDone()
+{
+	return _pagesDone;
+}
+
+/** @brief Bytes consumed from the image source.
+ *  @return uint32, Byte count.
+ */
+uint32 FlashPipelineClass::sourcePosition()
+{
+	if (_mode == PipelineModes::PipelineRead)
+	{
+		return _pagesDone * STK500_PAGE_SIZE;
+	}
+
+	if (_packed)
+	{
+		return _unpack.consumed();
+	}
+
+	return _reader.position();
+}
+
+/** @brief Check if the last verify found a difference.
+ *  @return bool, True when the target differs from the image.
+ */
+bool FlashPipelineClass::hasMismatch()
+{
+	return _mismatch;
+}
+
+/** @brief Start the transfer of the head page.
+ *  @return Void.
+ */
+void FlashPipelineClass::startHead()
+{
+	FlashPage_t* PageL = &_pages[_head];
+
+	if (_mode == PipelineModes::PipelineVerify)
+	{
+		STK500.beginReadPage(PageL->Address, _readBack);
+	}
+	else
+	{
+		STK500.beginPage(PageL->Address, PageL->Data);
+	}
+
+	_inFlight = true;
+}
+
+/** @brief Do one step of reading the target.
+ *  @return uint8, Busy while running, else the result.
+ *  @see StatusCodes.h
+ */
+uint8 FlashPipelineClass::processRead()
+{
+	uint32 OffsetL = _pagesDone * STK500_PAGE_SIZE;
+
+	if (_inFlight)
+	{
+		uint8 StateL = STK500.pollPage();
+
+		if (StateL == StatusCodes::Busy)
+		{
+			return StatusCodes::Busy;
+		}
+
+		_inFlight = false;
+
+		if (StateL != StatusCodes::Ok)
+		{
+			DEBUGLOG("Page %u failed: %d\r\n", _pagesDone, StateL);
+			if (!retryPage())
+			{
+				return StateL;
+			}
+		}
+		else
+		{
+			uint32 LeftL = _readSize - OffsetL;
+			_sink->write(_readBack, (LeftL < STK500_PAGE_SIZE) ? LeftL : STK500_PAGE_SIZE);
+			_pagesDone++;
+			_retries = 0;
+			OffsetL += STK500_PAGE_SIZE;
+		}
+	}
+
+	if (OffsetL >= _readSize)
+	{
+		return StatusCodes::Ok;
+	}
+
+	// Load address is in words.
+	uint16 WordL = OffsetL / 2;
+	uint8 AddressL[2] = { (uint8)(WordL >> 8), (uint8)(WordL & 0xFF) };
+	STK500.beginReadPage(AddressL, _readBack);
+	_inFlight = true;
+
+	return StatusCodes::Busy;
+}
+
+/** @brief Decode from the source if there is a free page buffer, timing each page.
+ *  @return uint8, State of the source.
+ *  @see StatusCodes.h
+ */
+uint8 FlashPipelineClass::decodeLine()
+{
+	if (_endOfImage || _count >= FLASH_PIPELINE_DEPTH)
+	{
+		return StatusCodes::Busy;
+	}
+
+	uint8 CountL = _count;
+	unsigned long MarkL = micros();
+	uint8 StateL = _packed ? decodePage() : decodeRecord();
+	_decodeTime += micros() - MarkL;
+
+	if (_count != CountL)
+	{
+		FlashTimeline.record(PhaseDecode, _decodeTime);
+		_decodeTime = 0;
+	}
+
+	return StateL;
+}
+
+/** @brief Decompress one page of a packed image.
+ *  @return uint8, State of the source.
+ *  @see StatusCodes.h
+ */
+uint8 FlashPipelineClass::decodePage()
+{
+	FlashPage_t* PageL = &_pages[(_head + _count) % FLASH_PIPELINE_DEPTH];
+	size_t LengthL = _unpack.readBytes((char*)PageL, sizeof(FlashPage_t));
+
+	if (LengthL == 0)
+	{
+		_endOfImage = true;
+		return StatusCodes::Ok;
+	}
+
+	if (LengthL != sizeof(FlashPage_t))
+	{
+		DEBUGLOG("Packed image is truncated.\r\n");
+		return StatusCodes::Error;
+	}
+
+	_count++;
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Read and decode one Intel HEX line.
+ *  @return uint8, State of the source.
+ *  @see StatusCodes.h
+ */
+uint8 FlashPipelineClass::decodeRecord()
+{
+	byte* LineL;
+	size_t LengthL;
+	uint8 StateL = _reader.next(&LineL, &LengthL);
+
+	if (StateL == StatusCodes::Busy && _reader.isEnd())
+	{
+		// Source drained without an end of file record.
+		DEBUGLOG("Unexpected end of image.\r\n");
+		return StatusCodes::Error;
+	}
+
+	if (StateL != StatusCodes::Ok)
+	{
+		return StateL;
+	}
+
+	if (LengthL < HEX_RECORD_MIN_LENGTH)
+	{
+		return StatusCodes::Ok;
+	}
+
+	if (!_parser.IsRecordValid(LineL, LengthL))
+	{
+		DEBUGLOG("Invalid record before %u.\r\n", _reader.position());
+		return StatusCodes::Error;
+	}
+
+	_parser.ParseLine(LineL);
+
+	if (_parser.IsPageReady())
+	{
+		FlashPage_t* PageL = &_pages[(_head + _count) % FLASH_PIPELINE_DEPTH];
+		byte* AddressL = _parser.GetLoadAddress();
+		PageL->Address[0] = AddressL[0];
+		PageL->Address[1] = AddressL[1];
+		memcpy(PageL->Data, _parser.GetMemoryPage(), STK500_PAGE_SIZE);
+		_count++;
+	}
+
+	if (_parser.IsEndOfFile())
+	{
+		_endOfImage = true;
+	}
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Count a retry of the current page.
+ *  @return bool, True when the page may be sent again.
+ */
+bool FlashPipelineClass::retryPage()
+{
+	if (_retries >= FLASH_PAGE_RETRIES)
+	{
+		return false;
+	}
+
+	_retries++;
+	FlashTimeline.retry();
+	DEBUGLOG("Page %u retry %u\r\n", _pagesDone, _retries);
+
+	return true;
+}
+
+/* @brief Singelton flash pipeline instance. */
+FlashPipelineClass FlashPipeline;
@@ -0,0 +1,239 @@
+// FlashPipeline.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _FLASHPIPELINE_h
+#define _FLASHPIPELINE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#include "StatusCodes.h"
+
+#include "IntelHexParser.h"
+
+#include "HexLineReader.h"
+
+#include "ImageCodec.h"
+
+#include "STK500.h"
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief What the pipeline does with the pages. */
+enum PipelineModes : uint8
+{
+	PipelineProgram = 1U, ///< Write the image to the target.
+	PipelineVerify, ///< Compare the image with the target.
+	PipelineRead, ///< Read the target flash to a sink.
+};
+
+/** @brief Decoded page waiting for the target.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint8 Address[2]; ///< Load address as returned by the parser.
+	uint8 Data[STK500_PAGE_SIZE]; ///< Page content.
+} FlashPage_t;
+
+#pragma endregion
+
+/** @brief Double buffered parse/program pipeline.
+ *
+ *  While one page is in flight or being committed by the bootloader,
+ *  the next pages are read and decoded into a ring of page buffers.
+ */
+class FlashPipelineClass
+{
+public:
+
+	/** @brief Constructor.
+	 *  @return FlashPipelineClass
+	 */
+	FlashPipelineClass();
+
+	/** @brief Prepare the target and start a new image.
+	 *  @param source Stream*, Intel HEX source, or LZSS compressed pages when packed.
+	 *  @param mode uint8, Program or verify the image.
+	 *  @param finite bool, False for sources still receiving data.
+	 *  @param packed bool, The source is a packed image after its header.
+	 *  @return uint8, State of the pipeline.
+	 *  @see StatusCodes.h
+	 */
+	uint8 begin(Stream* source, uint8 mode = PipelineModes::PipelineProgram, bool finite = true, bool packed = false);
+
+	/** @brief The source will not get more data.
+	 *  @return Void.
+	 */
+	void endOfSource();
+
+	/** @brief Prepare the target and start reading its flash.
+	 *  @param sink Print*, Destination of the flash content.
+	 *  @param size uint32, Bytes to read.
+	 *  @return uint8, State of the pipeline.
+	 *  @see StatusCodes.h
+	 */
+	uint8 beginRead(Print* sink, uint32 size);
+
+	/** @brief Do one non blocking step of the pipeline.
+	 *  @return uint8, Busy while running, else the result of the image.
+	 *  @see StatusCodes.h
+	 */
+	uint8 process();
+
+	/** @brief Run the pipeline until the image is done.
+	 *  @return uint8, Result of the image.
+	 *  @see StatusCodes.h
+	 */
+	uint8 run();
+
+	/** @brief Take the target out of programming mode.
+	 *  @return Void.
+	 */
+	void end();
+
+	/** @brief Pages acknowledged by the target.
+	 *  @return uint32, Page count.
+	 */
+	uint32 pagesDone();
+
+	/** @brief Bytes consumed from the image source.
+	 *  @return uint32, Byte count.
+	 */
+	uint32 sourcePosition();
+
+	/** @brief Check if the last verify found a difference.
+	 *  @return bool, True when the target differs from the image.
+	 */
+	bool hasMismatch();
+
+private:
+
+	/** @brief Start the transfer of the head page.
+	 *  @return Void.
+	 */
+	void startHead();
+
+	/** @brief Do one step of reading the target.
+	 *  @return uint8, Busy while running, else the result.
+	 *  @see StatusCodes.h
+	 */
+	uint8 processRead();
+
+	/** @brief Decode from the source if there is a free page buffer, timing each page.
+	 *  @return uint8, State of the source.
+	 *  @see StatusCodes.h
+	 */
+	uint8 decodeLine();
+
+	/** @brief Read and decode one Intel HEX line.
+	 *  @return uint8, State of the source.
+	 *  @see StatusCodes.h
+	 */
+	uint8 decodeRecord();
+
+	/** @brief Decompress one page of a packed image.
+	 *  @return uint8, State of the source.
+	 *  @see StatusCodes.h
+	 */
+	uint8 decodePage();
+
+	/** @brief Count a retry of the current page.
+	 *  @return bool, True when the page may be sent again.
+	 */
+	bool retryPage();
+
+	/* @brief Ring of decoded pages. */
+	FlashPage_t _pages[FLASH_PIPELINE_DEPTH];
+
+	/* @brief Oldest decoded page, the one sent to the target. */
+	uint8 _head = 0;
+
+	/* @brief Count of decoded pages in the ring. */
+	uint8 _count = 0;
+
+	/* @brief The head page is in flight. */
+	bool _inFlight = false;
+
+	/* @brief The end of the image has been decoded. */
+	bool _endOfImage = false;
+
+	/* @brief Pages acknowledged by the target. */
+	uint32 _pagesDone = 0;
+
+	/* @brief What the pipeline does with the pages. */
+	uint8 _mode = PipelineModes::PipelineProgram;
+
+	/* @brief Verify found a difference. */
+	bool _mismatch = false;
+
+	/* @brief Retries of the current page. */
+	uint8 _retries = 0;
+
+	/* @brief Page read back from the target. */
+	uint8 _readBack[STK500_PAGE_SIZE];
+
+	/* @brief Destination of the read mode. */
+	Print* _sink = NULL;
+
+	/* @brief Bytes to read in read mode. */
+	uint32 _readSize = 0;
+
+	/* @brief Intel HEX source. */
+	Stream* _source = NULL;
+
+	/* @brief Line reader over the source. */
+	HexLineReader _reader;
+
+	/* @brief Parser of the image. */
+	IntelHexParserClass _parser;
+
+	/* @brief Decompressor of a packed image. */
+	LzssStream _unpack;
+
+	/* @brief The source is a packed image. */
+	bool _packed = false;
+
+	/* @brief Decode time of the page being decoded in us. */
+	unsigned long _decodeTime = 0;
+};
+
+/* @brief Singelton flash pipeline instance. */
+extern FlashPipelineClass FlashPipeline;
+
+#endif
@@ -0,0 +1,237 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "FlashTimeline.h"
+
+#include "STK500.h"
+
+/** @brief Start the timeline of a job.
+ *  @param jobId uint16, Job ID.
+ *  @param type uint8, Kind of the job.
+ *  @return Void.
+ */
+void FlashTimelineClass::begin(uint16 jobId, uint8 type)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_current = &_jobs[_next];
+	_next = (_next + 1) % FLASH_TIMELINE_JOBS;
+	if (_count < FLASH_TIMELINE_JOBS)
+	{
+		_count++;
+	}
+
+	memset(_current, 0, sizeof(JobTimeline_t));
+	_current->JobId = jobId;
+	_current->Type = type;
+	_current->Result = StatusCodes::Busy;
+	_current->StartedAt = micros();
+
+	for (uint8 phase = 0; phase < PhaseCount; phase++)
+	{
+		_current->Phases[phase].Min = UINT32_MAX;
+	}
+}
+
+/** @brief Close the timeline of the running job.
+ *  @param result uint8, Result of the job.
+ *  @return Void.
+ */
+void FlashTimelineClass::end(uint8 result)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (_current == NULL)
+	{
+		return;
+	}
+
+	_current->Result = result;
+	_current->Duration = micros() - _current->StartedAt;
+
+	DEBUGLOG("Decode %u B/s, UART %u B/s\r\n", decodeBytesPerSecond(_current), STK500_PORT_BAUDRATE / 10);
+
+	_current = NULL;
+}
+
+/** @brief Add a sample to the running job.
+ *  @param phase uint8, Timed phase.
+ *  @param duration uint32, Duration in micro seconds.
+ *  @return Void.
+ */
+void FlashTimelineClass::record(uint8 phase, uint32 duration)
+{
+	if (_current == NULL || phase >= PhaseCount)
+	{
+		return;
+	}
+
+	PhaseStats_t* StatsL = &_current->Phases[phase];
+	StatsL->Count++;
+	StatsL->Sum += duration;
+	if (duration < StatsL->Min) StatsL->Min = duration;
+	if (duration > StatsL->Max) StatsL->Max = duration;
+
+	// Bucket n holds [2^n, 2^(n+1)) us.
+	uint8 BucketL = 0;
+	while (BucketL < FLASH_TIMELINE_BUCKETS - 1 && (duration >> (BucketL + 1)) != 0)
+	{
+		BucketL++;
+	}
+
+	if (StatsL->Histogram[BucketL] < UINT16_MAX)
+	{
+		StatsL->Histogram[BucketL]++;
+	}
+}
+
+/** @brief Count a page retry of the running job.
+ *  @return Void.
+ */
+void FlashTimelineClass::retry()
+{
+	if (_current != NULL)
+	{
+		_current->Retries++;
+	}
+}
+
+/** @brief Count of the kept timelines.
+ *  @return uint8, Timelines.
+ */
+uint8 FlashTimelineClass::count()
+{
+	return _count;
+}
+
+/** @brief Get a kept timeline.
+ *  @param index uint8, 0 is the newest.
+ *  @return const JobTimeline_t*, The timeline or NULL.
+ */
+const JobTimeline_t* FlashTimelineClass::get(uint8 index)
+{
+	if (index >= _count)
+	{
+		return NULL;
+	}
+
+	return &_jobs[(_next + FLASH_TIMELINE_JOBS - 1 - index) % FLASH_TIMELINE_JOBS];
+}
+
+/** @brief Percentile of a phase from its histogram.
+ *  @param stats const PhaseStats_t*, Phase statistics.
+ *  @param percent uint8, Percentile.
+ *  @return uint32, Upper bound of the percentile in micro seconds.
+ */
+uint32 FlashTimelineClass::percentile(const PhaseStats_t* stats, uint8 percent)
+{
+	if (stats->Count == 0)
+	{
+		return 0;
+	}
+
+	uint32 RankL = (stats->Count * percent + 99) / 100;
+	uint32 SeenL = 0;
+
+	for (uint8 bucket = 0; bucket < FLASH_TIMELINE_BUCKETS; bucket++)
+	{
+		SeenL += stats->Histogram[bucket];
+		if (SeenL >= RankL)
+		{
+			uint32 UpperL = (bucket < 31) ? ((1UL << (bucket + 1)) - 1) : UINT32_MAX;
+			return (UpperL < stats->Max) ? UpperL : stats->Max;
+		}
+	}
+
+	return stats->Max;
+}
+
+/** @brief Decoded image bytes per second of a job.
+ *  @param timeline const JobTimeline_t*, Timeline of the job.
+ *  @return uint32, Bytes per second, 0 without decoded pages.
+ */
+uint32 FlashTimelineClass::decodeBytesPerSecond(const JobTimeline_t* timeline)
+{
+	const PhaseStats_t* StatsL = &timeline->Phases[PhaseDecode];
+	if (StatsL->Sum == 0)
+	{
+		return 0;
+	}
+
+	// Every decoded page carries its address and its data.
+	return (uint32)((uint64_t)StatsL->Count * (STK500_PAGE_SIZE + 2) * 1000000ULL / StatsL->Sum);
+}
+
+/** @brief Add the samples of one phase statistic to another.
+ *  @param stats PhaseStats_t*, Destination, Min starts at UINT32_MAX.
+ *  @param other const PhaseStats_t*, Source.
+ *  @return Void.
+ */
+void FlashTimelineClass::merge(PhaseStats_t* stats, const PhaseStats_t* other)
+{
+	if (other->Count == 0)
+	{
+		return;
+	}
+
+	stats->Count += other->Count;
+	stats->Sum += other->Sum;
+	if (other->Min < stats->Min) stats->Min = other->Min;
+	if (other->Max > stats->Max) stats->Max = other->Max;
+
+	for (uint8 bucket = 0; bucket < FLASH_TIMELINE_BUCKETS; bucket++)
+	{
+		uint32 CountL = (uint32)stats->Histogram[bucket] + other->Histogram[bucket];
+		stats->Histogram[bucket] = (CountL < UINT16_MAX) ? CountL : UINT16_MAX;
+	}
+}
+
+/** @brief Name of a phase.
+ *  @param phase uint8, Timed phase.
+ *  @return const char*, Name used by the API.
+ */
+const char* FlashTimelineClass::phaseName(uint8 phase)
+{
+	switch (phase)
+	{
+	case TimelinePhases::PhaseReset: return "reset";
+	case TimelinePhases::PhaseSync: return "sync";
+	case TimelinePhases::PhaseParams: return "params";
+	case TimelinePhases::PhaseEnter: return "enter";
+	case TimelinePhases::PhasePageTx: return "pageTx";
+	case TimelinePhases::PhasePageWait: return "pageWait";
+	case TimelinePhases::PhaseExit: return "exit";
+	case TimelinePhases::PhaseDecode: return "decode";
+	}
+
+	return "unknown";
+}
+
+/* @brief Singelton flash timeline instance. */
+FlashTimelineClass FlashTimeline;
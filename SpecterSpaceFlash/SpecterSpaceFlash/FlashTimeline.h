@@ -0,0 +1,176 @@
+// FlashTimeline.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _FLASHTIMELINE_h
+#define _FLASHTIMELINE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#include "StatusCodes.h"
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Timed phases of a job. */
+enum TimelinePhases : uint8
+{
+	PhaseReset = 0U, ///< Reset pulses of the target.
+	PhaseSync, ///< Sync with the bootloader.
+	PhaseParams, ///< Programming parameters.
+	PhaseEnter, ///< Enter programming mode.
+	PhasePageTx, ///< Load address and page data on the UART.
+	PhasePageWait, ///< Wait for the bootloader reply of a page.
+	PhaseExit, ///< Leave programming mode.
+	PhaseDecode, ///< Decode one page from the image.
+	PhaseCount, ///< Count of the phases.
+};
+
+/** @brief Statistics of one phase in micro seconds.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint32 Count; ///< Samples.
+	uint32 Min; ///< Shortest sample.
+	uint32 Max; ///< Longest sample.
+	uint64_t Sum; ///< Sum of the samples.
+	uint16 Histogram[FLASH_TIMELINE_BUCKETS]; ///< Samples per power of two bucket.
+} PhaseStats_t;
+
+/** @brief Timeline of one job.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint16 JobId; ///< Job of the timeline.
+	uint8 Type; ///< Kind of the job.
+	uint8 Result; ///< Result of the job, Busy while running.
+	unsigned long StartedAt; ///< micros() at the start.
+	uint32 Duration; ///< Whole job in micro seconds.
+	uint32 Retries; ///< Pages sent again.
+	PhaseStats_t Phases[PhaseCount]; ///< Times per phase.
+} JobTimeline_t;
+
+#pragma endregion
+
+/** @brief Per job timing capture of the flash phases in a ring of recent jobs. */
+class FlashTimelineClass
+{
+public:
+
+	/** @brief Start the timeline of a job.
+	 *  @param jobId uint16, Job ID.
+	 *  @param type uint8, Kind of the job.
+	 *  @return Void.
+	 */
+	void begin(uint16 jobId, uint8 type);
+
+	/** @brief Close the timeline of the running job.
+	 *  @param result uint8, Result of the job.
+	 *  @return Void.
+	 */
+	void end(uint8 result);
+
+	/** @brief Add a sample to the running job.
+	 *  @param phase uint8, Timed phase.
+	 *  @param duration uint32, Duration in micro seconds.
+	 *  @return Void.
+	 */
+	void record(uint8 phase, uint32 duration);
+
+	/** @brief Count a page retry of the running job.
+	 *  @return Void.
+	 */
+	void retry();
+
+	/** @brief Count of the kept timelines.
+	 *  @return uint8, Timelines.
+	 */
+	uint8 count();
+
+	/** @brief Get a kept timeline.
+	 *  @param index uint8, 0 is the newest.
+	 *  @return const JobTimeline_t*, The timeline or NULL.
+	 */
+	const JobTimeline_t* get(uint8 index);
+
+	/** @brief Percentile of a phase from its histogram.
+	 *  @param stats const PhaseStats_t*, Phase statistics.
+	 *  @param percent uint8, Percentile.
+	 *  @return uint32, Upper bound of the percentile in micro seconds.
+	 */
+	static uint32 percentile(const PhaseStats_t* stats, uint8 percent);
+
+	/** @brief Decoded image bytes per second of a job.
+	 *  @param timeline const JobTimeline_t*, Timeline of the job.
+	 *  @return uint32, Bytes per second, 0 without decoded pages.
+	 */
+	static uint32 decodeBytesPerSecond(const JobTimeline_t* timeline);
+
+	/** @brief Add the samples of one phase statistic to another.
+	 *  @param stats PhaseStats_t*, Destination, Min starts at UINT32_MAX.
+	 *  @param other const PhaseStats_t*, Source.
+	 *  @return Void.
+	 */
+	static void merge(PhaseStats_t* stats, const PhaseStats_t* other);
+
+	/** @brief Name of a phase.
+	 *  @param phase uint8, Timed phase.
+	 *  @return const char*, Name used by the API.
+	 */
+	static const char* phaseName(uint8 phase);
+
+private:
+
+	/* @brief Ring of recent timelines. */
+	JobTimeline_t _jobs[FLASH_TIMELINE_JOBS];
+
+	/* @brief Next slot of the ring. */
+	uint8 _next = 0;
+
+	/* @brief Used slots of the ring. */
+	uint8 _count = 0;
+
+	/* @brief Timeline of the running job. */
+	JobTimeline_t* _current = NULL;
+};
+
+/* @brief Singelton flash timeline instance. */
+extern FlashTimelineClass FlashTimeline;
+
+#endif
@@ -24,6 +24,13 @@ SOFTWARE.
 
 #include "GeneralHelper.h"
 
+extern "C" {
+#include "umm_malloc/umm_malloc.h"
+}
+
+/** @brief Block of the umm_malloc heap of the core, header and body. */
+#define UMM_BLOCK_SIZE 8
+
 /** @brief Get MAC address.
  *  @return String, Returns the string of MAC address.
  */
@@ -68,6 +75,39 @@ void bin_to_strhex(uint8 *input, unsigned int input_size, uint8 *output)
 	}
 }
 
+/** @brief Continue a CRC-32 (IEEE 802.3) over more data.
+ *  @param crc uint32, CRC so far, 0 to start.
+ *  @param data const uint8*, Data.
+ *  @param len size_t, Length of the data.
+ *  @return uint32, CRC including the data.
+ */
+uint32 crc32_update(uint32 crc, const uint8 *data, size_t len)
+{
+	// Bit by bit, a table would cost 1 KB for a few ms per image.
+	crc = ~crc;
+	for (size_t index = 0; index < len; index++)
+	{
+		crc ^= data[index];
+		for (uint8 bit = 0; bit < 8; bit++)
+		{
+			crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+		}
+	}
+
+	return ~crc;
+}
+
+/** @brief Largest block the heap can give at once.
+ *  @return uint32, Size of the block in bytes.
+ */
+uint32 max_free_block()
+{
+	// The core 2.4.2 has no ESP.getMaxFreeBlockSize(), the heap is walked.
+	umm_info(NULL, 0);
+
+	return (uint32)ummHeapInfo.maxFreeContiguousBlocks * UMM_BLOCK_SIZE;
+}
+
 /** @brief Check the Values is between: [0 - 255].
  *  @param value String, Value of the octet.
  *  @return boolean, Returns the true if value is in the range.
@@ -63,6 +63,19 @@ unsigned char hex2dec(char c);
  */
 void bin_to_strhex(uint8 *input, unsigned int input_size, uint8 *output);
 
+/** @brief Continue a CRC-32 (IEEE 802.3) over more data.
+ *  @param crc uint32, CRC so far, 0 to start.
+ *  @param data const uint8*, Data.
+ *  @param len size_t, Length of the data.
+ *  @return uint32, CRC including the data.
+ */
+uint32 crc32_update(uint32 crc, const uint8 *data, size_t len);
+
+/** @brief Largest block the heap can give at once.
+ *  @return uint32, Size of the block in bytes.
+ */
+uint32 max_free_block();
+
 /** @brief Check the Values is between: [0 - 255].
  *  @param value String, Value of the octet.
  *  @return boolean, Returns the true if value is in the range.
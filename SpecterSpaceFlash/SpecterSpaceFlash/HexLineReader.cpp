@@ -0,0 +1,145 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "HexLineReader.h"
+
+/** @brief Attach the reader to a source.
+ *  @param source Stream*, Source of the lines.
+ *  @param finite bool, No data available means end of the source.
+ *  @return Void.
+ */
+void HexLineReader::begin(Stream* source, bool finite)
+{
+	_source = source;
+	_finite = finite;
+	_start = 0;
+	_end = 0;
+	_position = 0;
+}
+
+/** @brief Mark the source as finite, no data available means end of it.
+ *  @param finite bool, The source will not get more data.
+ *  @return Void.
+ */
+void HexLineReader::setFinite(bool finite)
+{
+	_finite = finite;
+}
+
+/** @brief Get the next line without the line ending.
+ *  The view is valid until the next call.
+ *  @param line byte**, Start of the line.
+ *  @param length size_t*, Length of the line.
+ *  @return uint8, Ok with a line, Busy waiting for data, Error for too long line.
+ *  @see StatusCodes.h
+ */
+uint8 HexLineReader::next(byte** line, size_t* length)
+{
+	for (;;)
+	{
+		byte* StartL = _buffer + _start;
+		byte* NewLineL = (byte*)memchr(StartL, '\n', _end - _start);
+
+		if (NewLineL != NULL)
+		{
+			size_t LengthL = NewLineL - StartL;
+			_start += LengthL + 1;
+			_position += LengthL + 1;
+
+			if (LengthL > 0 && StartL[LengthL - 1] == '\r')
+			{
+				LengthL--;
+			}
+
+			*line = StartL;
+			*length = LengthL;
+			return StatusCodes::Ok;
+		}
+
+		if (fill() > 0)
+		{
+			continue;
+		}
+
+		if (_start == 0 && _end == HEX_READER_BLOCK_SIZE)
+		{
+			return StatusCodes::Error;
+		}
+
+		// Last line of a finite source may have no line ending.
+		if (_finite && _end > _start && !_source->available())
+		{
+			*line = StartL;
+			*length = _end - _start;
+			_position += _end - _start;
+			_start = _end;
+			return StatusCodes::Ok;
+		}
+
+		return StatusCodes::Busy;
+	}
+}
+
+/** @brief Check for the end of the source.
+ *  @return bool, True when all lines are consumed.
+ */
+bool HexLineReader::isEnd()
+{
+	return _finite && _start >= _end && !_source->available();
+}
+
+/** @brief Bytes consumed from the source.
+ *  @return uint32, Byte count.
+ */
+uint32 HexLineReader::position()
+{
+	return _position;
+}
+
+/** @brief Move the unread bytes to the front and read a new block.
+ *  @return size_t, Count of the new bytes.
+ */
+size_t HexLineReader::fill()
+{
+	if (_start > 0)
+	{
+		memmove(_buffer, _buffer + _start, _end - _start);
+		_end -= _start;
+		_start = 0;
+	}
+
+	size_t FreeL = HEX_READER_BLOCK_SIZE - _end;
+	size_t AvailableL = _source->available();
+
+	if (FreeL == 0 || AvailableL == 0)
+	{
+		return 0;
+	}
+
+	size_t CountL = _source->readBytes((char*)(_buffer + _end), (AvailableL < FreeL) ? AvailableL : FreeL);
+	_end += CountL;
+
+	return CountL;
+}
@@ -0,0 +1,115 @@
+// HexLineReader.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _HEXLINEREADER_h
+#define _HEXLINEREADER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include "ApplicationConfiguration.h"
+
+#include "StatusCodes.h"
+
+#pragma endregion
+
+/** @brief Intel HEX minimal record length ":LLAAAATTCC". */
+#define HEX_RECORD_MIN_LENGTH 11
+
+/** @brief Fixed buffer line reader.
+ *
+ *  Reads the source in blocks and hands out views of the lines
+ *  inside its own buffer, so reading an image does not touch the heap.
+ */
+class HexLineReader
+{
+public:
+
+	/** @brief Attach the reader to a source.
+	 *  @param source Stream*, Source of the lines.
+	 *  @param finite bool, No data available means end of the source.
+	 *  @return Void.
+	 */
+	void begin(Stream* source, bool finite = true);
+
+	/** @brief Mark the source as finite, no data available means end of it.
+	 *  @param finite bool, The source will not get more data.
+	 *  @return Void.
+	 */
+	void setFinite(bool finite);
+
+	/** @brief Get the next line without the line ending.
+	 *  The view is valid until the next call.
+	 *  @param line byte**, Start of the line.
+	 *  @param length size_t*, Length of the line.
+	 *  @return uint8, Ok with a line, Busy waiting for data, Error for too long line.
+	 *  @see StatusCodes.h
+	 */
+	uint8 next(byte** line, size_t* length);
+
+	/** @brief Check for the end of the source.
+	 *  @return bool, True when all lines are consumed.
+	 */
+	bool isEnd();
+
+	/** @brief Bytes consumed from the source.
+	 *  @return uint32, Byte count.
+	 */
+	uint32 position();
+
+private:
+
+	/** @brief Move the unread bytes to the front and read a new block.
+	 *  @return size_t, Count of the new bytes.
+	 */
+	size_t fill();
+
+	/* @brief Block buffer. */
+	byte _buffer[HEX_READER_BLOCK_SIZE];
+
+	/* @brief First unread byte. */
+	size_t _start = 0;
+
+	/* @brief End of the valid data. */
+	size_t _end = 0;
+
+	/* @brief Bytes consumed from the source. */
+	uint32 _position = 0;
+
+	/* @brief No data available means end of the source. */
+	bool _finite = true;
+
+	/* @brief Source of the lines. */
+	Stream* _source = NULL;
+};
+
+#endif
@@ -0,0 +1,322 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "ImageCodec.h"
+
+#pragma region LzssEncoder
+
+/** @brief Start a new stream.
+ *  @param sink Print*, Destination of the compressed data.
+ *  @return Void.
+ */
+void LzssEncoder::begin(Print* sink)
+{
+	_sink = sink;
+	_position = 0;
+	_end = 0;
+	_flags = 0;
+	_items = 0;
+	_groupLength = 0;
+	_size = 0;
+}
+
+/** @brief Compress data.
+ *  @param data const uint8*, Data.
+ *  @param len size_t, Length of the data.
+ *  @return Void.
+ */
+void LzssEncoder::write(const uint8* data, size_t len)
+{
+	while (len > 0)
+	{
+		if (_end == sizeof(_buffer))
+		{
+			// Keep one window of history in front of the lookahead.
+			uint16 DropL = _position - LZSS_WINDOW_SIZE;
+			memmove(_buffer, _buffer + DropL, _end - DropL);
+			_position -= DropL;
+			_end -= DropL;
+		}
+
+		size_t CountL = sizeof(_buffer) - _end;
+		if (CountL > len)
+		{
+			CountL = len;
+		}
+
+		memcpy(_buffer + _end, data, CountL);
+		_end += CountL;
+		data += CountL;
+		len -= CountL;
+
+		encode(false);
+	}
+}
+
+/** @brief Compress the rest and flush the last group.
+ *  @return Void.
+ */
+void LzssEncoder::end()
+{
+	encode(true);
+
+	if (_items > 0)
+	{
+		flushGroup();
+	}
+}
+
+/** @brief Compressed bytes written.
+ *  @return uint32, Size of the output.
+ */
+uint32 LzssEncoder::size()
+{
+	return _size;
+}
+
+/** @brief Encode while there is enough lookahead.
+ *  @param final bool, Encode up to the end of the data.
+ *  @return Void.
+ */
+void LzssEncoder::encode(bool final)
+{
+	while ((_end - _position) >= LZSS_MAX_MATCH || (final && _position < _end))
+	{
+		uint16 LimitL = _end - _position;
+		if (LimitL > LZSS_MAX_MATCH)
+		{
+			LimitL = LZSS_MAX_MATCH;
+		}
+
+		uint16 StartL = (_position > LZSS_WINDOW_SIZE) ? _position - LZSS_WINDOW_SIZE : 0;
+		uint16 BestLengthL = 0;
+		uint16 BestDistanceL = 0;
+
+		// Nearest first, so equal matches get the shorter distance.
+		for (int candidate = _position - 1; candidate >= StartL && BestLengthL < LimitL; candidate--)
+		{
+			uint16 LengthL = 0;
+			while (LengthL < LimitL && _buffer[candidate + LengthL] == _buffer[_position + LengthL])
+			{
+				LengthL++;
+			}
+
+			if (LengthL > BestLengthL)
+			{
+				BestLengthL = LengthL;
+				BestDistanceL = _position - candidate;
+			}
+		}
+
+		if (BestLengthL >= LZSS_MIN_MATCH)
+		{
+			uint16 DistanceL = BestDistanceL - 1;
+			_group[_groupLength++] = DistanceL & 0xFF;
+			_group[_groupLength++] = ((DistanceL >> 8) << 6) | (BestLengthL - LZSS_MIN_MATCH);
+			_position += BestLengthL;
+		}
+		else
+		{
+			_flags |= (1 << _items);
+			_group[_groupLength++] = _buffer[_position++];
+		}
+
+		if (++_items == 8)
+		{
+			flushGroup();
+		}
+	}
+}
+
+/** @brief Write the flag byte and the items of the group.
+ *  @return Void.
+ */
+void LzssEncoder::flushGroup()
+{
+	_sink->write(_flags);
+	_sink->write(_group, _groupLength);
+	_size += 1 + _groupLength;
+
+	_flags = 0;
+	_items = 0;
+	_groupLength = 0;
+}
+
+#pragma endregion
+
+#pragma region LzssStream
+
+/** @brief Start decoding a source.
+ *  @param source Stream*, Compressed data.
+ *  @return Void.
+ */
+void LzssStream::begin(Stream* source)
+{
+	_source = source;
+	_windowPosition = 0;
+	_inputLength = 0;
+	_inputIndex = 0;
+	_consumed = 0;
+	_flags = 0;
+	_items = 0;
+	_matchDistance = 0;
+	_matchLeft = 0;
+	_end = false;
+	memset(_window, 0, sizeof(_window));
+}
+
+/** @brief Compressed bytes taken from the source.
+ *  @return uint32, Position in the source.
+ */
+uint32 LzssStream::consumed()
+{
+	return _consumed;
+}
+
+int LzssStream::available()
+{
+	return (_matchLeft > 0 || _inputIndex < _inputLength || (!_end && _source->available() > 0)) ? 1 : 0;
+}
+
+int LzssStream::read()
+{
+	return decode();
+}
+
+int LzssStream::peek()
+{
+	// Not needed by the page pipeline.
+	return -1;
+}
+
+size_t LzssStream::readBytes(char* buffer, size_t length)
+{
+	size_t CountL = 0;
+
+	while (CountL < length)
+	{
+		int DataL = decode();
+		if (DataL < 0)
+		{
+			break;
+		}
+
+		buffer[CountL++] = (char)DataL;
+	}
+
+	return CountL;
+}
+
+size_t LzssStream::write(uint8_t data)
+{
+	return 0;
+}
+
+void LzssStream::flush()
+{
+}
+
+/** @brief Next compressed byte.
+ *  @return int, The byte or -1 at the end.
+ */
+int LzssStream::input()
+{
+	if (_inputIndex >= _inputLength)
+	{
+		if (_end)
+		{
+			return -1;
+		}
+
+		_inputLength = _source->readBytes((char*)_input, sizeof(_input));
+		_inputIndex = 0;
+
+		if (_inputLength == 0)
+		{
+			_end = true;
+			return -1;
+		}
+	}
+
+	_consumed++;
+	return _input[_inputIndex++];
+}
+
+/** @brief Decode one byte.
+ *  @return int, The byte or -1 at the end.
+ */
+int LzssStream::decode()
+{
+	if (_matchLeft == 0)
+	{
+		if (_items == 0)
+		{
+			int FlagsL = input();
+			if (FlagsL < 0)
+			{
+				return -1;
+			}
+
+			_flags = FlagsL;
+			_items = 8;
+		}
+
+		bool LiteralL = (_flags & 1) != 0;
+		_flags >>= 1;
+		_items--;
+
+		if (LiteralL)
+		{
+			int DataL = input();
+			if (DataL < 0)
+			{
+				return -1;
+			}
+
+			_window[_windowPosition] = DataL;
+			_windowPosition = (_windowPosition + 1) % LZSS_WINDOW_SIZE;
+			return DataL;
+		}
+
+		int LowL = input();
+		int HighL = input();
+		if (LowL < 0 || HighL < 0)
+		{
+			return -1;
+		}
+
+		_matchDistance = (LowL | ((HighL >> 6) << 8)) + 1;
+		_matchLeft = (HighL & 0x3F) + LZSS_MIN_MATCH;
+	}
+
+	uint8 DataL = _window[(_windowPosition + LZSS_WINDOW_SIZE - _matchDistance) % LZSS_WINDOW_SIZE];
+	_window[_windowPosition] = DataL;
+	_windowPosition = (_windowPosition + 1) % LZSS_WINDOW_SIZE;
+	_matchLeft--;
+
+	return DataL;
+}
+
+#pragma endregion
@@ -0,0 +1,226 @@
+// ImageCodec.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _IMAGECODEC_h
+#define _IMAGECODEC_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#pragma endregion
+
+#pragma region Definitions
+
+/** @brief Window of the LZSS codec, 10 bits of distance. */
+#define LZSS_WINDOW_SIZE 1024
+
+/** @brief Shortest match worth a reference. */
+#define LZSS_MIN_MATCH 3
+
+/** @brief Longest match, 6 bits of length. */
+#define LZSS_MAX_MATCH (LZSS_MIN_MATCH + 63)
+
+/** @brief Compressed bytes read from the source at once. */
+#define LZSS_INPUT_SIZE 128
+
+/** @brief Magic number of a packed image, "SSFP". */
+#define PACKED_IMAGE_MAGIC 0x50465353UL
+
+/** @brief Layout version of a packed image. */
+#define PACKED_IMAGE_VERSION 1
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Header of a packed image, followed by the LZSS compressed pages.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint32 Magic; ///< PACKED_IMAGE_MAGIC.
+	uint16 Version; ///< PACKED_IMAGE_VERSION.
+	uint16 Reserved; ///< Zero.
+} PackedImageHeader_t;
+
+#pragma endregion
+
+/** @brief Streaming LZSS compressor.
+ *
+ *  Groups of eight items follow a flag byte, a set bit is a literal,
+ *  a clear bit a two byte reference of 10 bits distance and 6 bits length.
+ */
+class LzssEncoder
+{
+public:
+
+	/** @brief Start a new stream.
+	 *  @param sink Print*, Destination of the compressed data.
+	 *  @return Void.
+	 */
+	void begin(Print* sink);
+
+	/** @brief Compress data.
+	 *  @param data const uint8*, Data.
+	 *  @param len size_t, Length of the data.
+	 *  @return Void.
+	 */
+	void write(const uint8* data, size_t len);
+
+	/** @brief Compress the rest and flush the last group.
+	 *  @return Void.
+	 */
+	void end();
+
+	/** @brief Compressed bytes written.
+	 *  @return uint32, Size of the output.
+	 */
+	uint32 size();
+
+private:
+
+	/** @brief Encode while there is enough lookahead.
+	 *  @param final bool, Encode up to the end of the data.
+	 *  @return Void.
+	 */
+	void encode(bool final);
+
+	/** @brief Write the flag byte and the items of the group.
+	 *  @return Void.
+	 */
+	void flushGroup();
+
+	/* @brief Destination of the compressed data. */
+	Print* _sink = NULL;
+
+	/* @brief Window and lookahead. */
+	uint8 _buffer[LZSS_WINDOW_SIZE * 2];
+
+	/* @brief Next byte to encode. */
+	uint16 _position = 0;
+
+	/* @brief End of the buffered data. */
+	uint16 _end = 0;
+
+	/* @brief Flags of the group. */
+	uint8 _flags = 0;
+
+	/* @brief Items of the group. */
+	uint8 _items = 0;
+
+	/* @brief Encoded items of the group. */
+	uint8 _group[16];
+
+	/* @brief Bytes in the group. */
+	uint8 _groupLength = 0;
+
+	/* @brief Compressed bytes written. */
+	uint32 _size = 0;
+};
+
+/** @brief Streaming LZSS decompressor, reads compressed data and returns the original bytes. */
+class LzssStream : public Stream
+{
+public:
+
+	/** @brief Start decoding a source.
+	 *  @param source Stream*, Compressed data.
+	 *  @return Void.
+	 */
+	void begin(Stream* source);
+
+	/** @brief Compressed bytes taken from the source.
+	 *  @return uint32, Position in the source.
+	 */
+	uint32 consumed();
+
+	int available() override;
+	int read() override;
+	int peek() override;
+	size_t readBytes(char* buffer, size_t length) override;
+	size_t write(uint8_t data) override;
+	void flush() override;
+
+private:
+
+	/** @brief Next compressed byte.
+	 *  @return int, The byte or -1 at the end.
+	 */
+	int input();
+
+	/** @brief Decode one byte.
+	 *  @return int, The byte or -1 at the end.
+	 */
+	int decode();
+
+	/* @brief Compressed data. */
+	Stream* _source = NULL;
+
+	/* @brief History of the output. */
+	uint8 _window[LZSS_WINDOW_SIZE];
+
+	/* @brief Next position in the history. */
+	uint16 _windowPosition = 0;
+
+	/* @brief Block of compressed data. */
+	uint8 _input[LZSS_INPUT_SIZE];
+
+	/* @brief Bytes in the block. */
+	uint8 _inputLength = 0;
+
+	/* @brief Next byte of the block. */
+	uint8 _inputIndex = 0;
+
+	/* @brief Compressed bytes taken from the source. */
+	uint32 _consumed = 0;
+
+	/* @brief Flags of the group. */
+	uint8 _flags = 0;
+
+	/* @brief Items left in the group. */
+	uint8 _items = 0;
+
+	/* @brief Distance of the reference being copied. */
+	uint16 _matchDistance = 0;
+
+	/* @brief Bytes left of the reference being copied. */
+	uint8 _matchLeft = 0;
+
+	/* @brief The source is drained. */
+	bool _end = false;
+};
+
+#endif
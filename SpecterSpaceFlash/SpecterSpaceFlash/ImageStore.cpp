@@ -0,0 +1,1079 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include <time.h>
+
+#include "ImageStore.h"
+
+#include "GeneralHelper.h"
+
+#include "DeviceConfiguration.h"
+
+#include "FlashPipeline.h"
+
+#include "FlashJobs.h"
+
+#pragma region ImageStoreClass
+
+/** @brief Load the manifest and take over the images of the old /hex folder.
+ *  @param fs FS*, File system.
+ *  @return Void.
+ */
+void ImageStoreClass::begin(FS* fs)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_fileSystem = fs;
+	memset(_entries, 0, sizeof(_entries));
+	_count = 0;
+
+	if (!load())
+	{
+		DEBUGLOG("No image manifest.\r\n");
+	}
+
+	// Collect first, the folders change while the files are handled.
+	String PathsL = "";
+
+	// Drop uploads cut by a reset, names are taken relative to the folder on both backends.
+	Dir DirL = _fileSystem->openDir(IMAGE_STORE_DIR);
+	while (DirL.next())
+	{
+		if (Storage.entryName(DirL, IMAGE_STORE_DIR).startsWith("tmp"))
+		{
+			PathsL += Storage.entryPath(DirL, IMAGE_STORE_DIR) + "\n";
+		}
+	}
+
+	for (int start = 0, end = PathsL.indexOf('\n'); end >= 0; start = end + 1, end = PathsL.indexOf('\n', start))
+	{
+		_fileSystem->remove(PathsL.substring(start, end));
+	}
+
+	// Images stored by name before the manifest existed.
+	PathsL = "";
+	DirL = _fileSystem->openDir(STREAM_FLASH_STORE_DIR);
+	while (DirL.next())
+	{
+		String PathL = Storage.entryPath(DirL, STREAM_FLASH_STORE_DIR);
+		if (PathL.length() > 0)
+		{
+			PathsL += PathL + "\n";
+		}
+	}
+
+	for (int start = 0, end = PathsL.indexOf('\n'); end >= 0; start = end + 1, end = PathsL.indexOf('\n', start))
+	{
+		import(PathsL.substring(start, end).c_str());
+	}
+
+	DEBUGLOG("Images: %u\r\n", _count);
+
+#ifdef IMAGE_STORE_PACKED
+
+	// Images left as Intel HEX by a reset are packed too.
+	_packCursor = 0;
+
+#endif // IMAGE_STORE_PACKED
+}
+
+/** @brief Start an upload, reserving its declared size and evicting images when needed.
+ *  @param writer ImageWriter*, Writer of the upload.
+ *  @param size uint32, Declared size of the upload, 0 when unknown.
+ *  @return bool, Successful opening, false when there is no room.
+ */
+bool ImageStoreClass::open(ImageWriter* writer, uint32 size)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (!makeRoom(size))
+	{
+		DEBUGLOG("No room for %u bytes.\r\n", size);
+		return false;
+	}
+
+	char PathL[IMAGE_NAME_SIZE];
+	snprintf(PathL, sizeof(PathL), "%s/tmp%u", IMAGE_STORE_DIR, _nextTemp++);
+
+	if (!writer->begin(_fileSystem, PathL))
+	{
+		return false;
+	}
+
+	writer->setReserved(size);
+	_reserved += size;
+
+	return true;
+}
+
+/** @brief Drop an upload and its reservation.
+ *  @param writer ImageWriter*, Writer of the upload.
+ *  @return Void.
+ */
+void ImageStoreClass::cancel(ImageWriter* writer)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_reserved -= (writer->reserved() < _reserved) ? writer->reserved() : _reserved;
+	writer->setReserved(0);
+	writer->discard();
+}
+
+/** @brief Store a finished upload under a name, the content is kept only once.
+ *  @param writer ImageWriter*, Writer of the upload.
+ *  @param name const char*, Name of the image.
+ *  @param mcu const char*, Target MCU, NULL for IMAGE_DEFAULT_MCU.
+ *  @return uint8, Ok, Busy when the manifest is full, Error otherwise.
+ *  @see StatusCodes.h
+ */
+uint8 ImageStoreClass::commit(ImageWriter* writer, const char* name, const char* mcu)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	// The last block is written here, it may fail too.
+	writer->close();
+
+	if (name == NULL || name[0] == '\0' || strlen(name) >= IMAGE_NAME_SIZE || writer->hasFailed())
+	{
+		cancel(writer);
+		return StatusCodes::Error;
+	}
+
+	// The file is on disk now, it is counted as used space.
+	_reserved -= (writer->reserved() < _reserved) ? writer->reserved() : _reserved;
+	writer->setReserved(0);
+
+	ImageEntry_t* EntryL = lookup(name);
+	for (uint8 attempt = 0; EntryL == NULL && attempt <= IMAGE_STORE_ENTRIES; attempt++)
+	{
+		for (uint8 index = 0; index < IMAGE_STORE_ENTRIES && EntryL == NULL; index++)
+		{
+			if (_entries[index].Name[0] == '\0')
+			{
+				EntryL = &_entries[index];
+			}
+		}
+
+		// Manifest is full, the least recently used name gives way.
+		if (EntryL == NULL && !evict())
+		{
+			break;
+		}
+	}
+
+	if (EntryL == NULL)
+	{
+		writer->discard();
+		return StatusCodes::Busy;
+	}
+
+	char BlobL[IMAGE_NAME_SIZE];
+	blobPath(writer->hash(), BlobL);
+
+	// Same content is already stored, the upload costs no flash.
+	if (_fileSystem->exists(BlobL))
+	{
+		DEBUGLOG("Duplicate of %s\r\n", BlobL);
+		writer->discard();
+	}
+	// Stored as it came, handle() packs it later from the main loop.
+	else if (!_fileSystem->rename(writer->path(), BlobL))
+	{
+		writer->discard();
+		return StatusCodes::Error;
+	}
+
+	bool ReplaceL = (EntryL->Name[0] != '\0');
+	uint8 OldHashL[IMAGE_HASH_SIZE];
+	memcpy(OldHashL, EntryL->Hash, IMAGE_HASH_SIZE);
+
+	memset(EntryL, 0, sizeof(ImageEntry_t));
+	strncpy(EntryL->Name, name, IMAGE_NAME_SIZE - 1);
+	memcpy(EntryL->Hash, writer->hash(), IMAGE_HASH_SIZE);
+	EntryL->Size = writer->size();
+	strncpy(EntryL->Mcu, (mcu != NULL && mcu[0] != '\0') ? mcu : IMAGE_DEFAULT_MCU, IMAGE_MCU_SIZE - 1);
+	EntryL->Pages = writer->pages();
+	memcpy(&EntryL->Info, writer->info(), sizeof(ImageInfo_t));
+
+	File BlobFileL = _fileSystem->open(BlobL, "r");
+	if (BlobFileL)
+	{
+		EntryL->StoredSize = BlobFileL.size();
+		BlobFileL.close();
+	}
+
+	EntryL->UploadedAt = now();
+
+	if (!ReplaceL)
+	{
+		_count++;
+	}
+
+	save();
+
+#ifdef IMAGE_STORE_PACKED
+
+	if ((uint8)(EntryL - _entries) < _packCursor)
+	{
+		_packCursor = EntryL - _entries;
+	}
+
+#endif // IMAGE_STORE_PACKED
+
+	if (ReplaceL && memcmp(OldHashL, EntryL->Hash, IMAGE_HASH_SIZE) != 0)
+	{
+		release(OldHashL);
+	}
+
+	DEBUGLOG("Image %s: %u bytes, %u stored, %u pages, 0x%X-0x%X, about %u ms to flash\r\n", EntryL->Name, EntryL->Size,
+		EntryL->StoredSize, EntryL->Pages, EntryL->Info.MinAddress, EntryL->Info.MaxAddress, EntryL->Info.FlashTime);
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Pack the stored Intel HEX images a few lines at a time. Call it from the main loop.
+ *  @return Void.
+ */
+void ImageStoreClass::handle()
+{
+#ifdef IMAGE_STORE_PACKED
+
+	// A running job reads the images, the file is not replaced under it.
+	if (FlashJobs.isBusy())
+	{
+		return;
+	}
+
+	if (_packEncoder == NULL)
+	{
+		if (_packCursor < IMAGE_STORE_ENTRIES)
+		{
+			ImageEntry_t* EntryL = &_entries[_packCursor++];
+			if (EntryL->Name[0] != '\0')
+			{
+				beginPack(EntryL->Hash);
+			}
+		}
+		return;
+	}
+
+	uint8 StateL = stepPack();
+	if (StateL != StatusCodes::Busy)
+	{
+		endPack(StateL == StatusCodes::Ok);
+	}
+
+#endif // IMAGE_STORE_PACKED
+}
+
+/** @brief Remove a name, the content goes when nothing points to it.
+ *  @param name const char*, Name of the image.
+ *  @return uint8, Ok, Error for an unknown name.
+ *  @see StatusCodes.h
+ */
+uint8 ImageStoreClass::remove(const char* name)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	ImageEntry_t* EntryL = lookup(name);
+	if (EntryL == NULL)
+	{
+		return StatusCodes::Error;
+	}
+
+	uint8 HashL[IMAGE_HASH_SIZE];
+	memcpy(HashL, EntryL->Hash, IMAGE_HASH_SIZE);
+
+	memset(EntryL, 0, sizeof(ImageEntry_t));
+	_count--;
+
+	save();
+	release(HashL);
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Remove a content file of the store that no name and not the golden image points to.
+ *  @param path const char*, The file, other files stay.
+ *  @return Void.
+ */
+void ImageStoreClass::releaseFile(const char* path)
+{
+	if (!isOrphan(path))
+	{
+		return;
+	}
+
+	// The golden image stays for the rollback.
+	if (DeviceConfiguration.GoldenImage == path)
+	{
+		return;
+	}
+
+#ifdef IMAGE_STORE_PACKED
+
+	// The file being packed goes, so does its packing.
+	if (_packEncoder != NULL)
+	{
+		char PackL[IMAGE_NAME_SIZE];
+		blobPath(_packHash, PackL);
+		if (strcmp(PackL, path) == 0)
+		{
+			endPack(false);
+		}
+	}
+
+#endif // IMAGE_STORE_PACKED
+
+	DEBUGLOG("Release %s\r\n", path);
+	_fileSystem->remove(path);
+}
+
+/** @brief Record a successful flash for the eviction order.
+ *  @param name const char*, Name of the image.
+ *  @return Void.
+ */
+void ImageStoreClass::touch(const char* name)
+{
+	ImageEntry_t* EntryL = lookup(name);
+	if (EntryL == NULL)
+	{
+		return;
+	}
+
+	EntryL->FlashedAt = now();
+	save();
+}
+
+/** @brief Keep an image from eviction.
+ *  @param name const char*, Name of the image.
+ *  @param pinned bool, Pin or unpin.
+ *  @return uint8, Ok, Error for an unknown name.
+ *  @see StatusCodes.h
+ */
+uint8 ImageStoreClass::pin(const char* name, bool pinned)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	ImageEntry_t* EntryL = lookup(name);
+	if (EntryL == NULL)
+	{
+		return StatusCodes::Error;
+	}
+
+	EntryL->Pinned = pinned ? 1 : 0;
+	save();
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Evict least recently used images until the size fits.
+ *  @param size uint32, Bytes to fit beside the reservations.
+ *  @return bool, True when the size fits.
+ */
+bool ImageStoreClass::makeRoom(uint32 size)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	while (!fits(size))
+	{
+		if (!evict())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/** @brief Bytes used by the stored images, shared content counted once.
+ *  @return uint32, Bytes.
+ */
+uint32 ImageStoreClass::usage()
+{
+	uint32 UsageL = 0;
+
+	for (uint8 index = 0; index < IMAGE_STORE_ENTRIES; index++)
+	{
+		if (_entries[index].Name[0] == '\0')
+		{
+			continue;
+		}
+
+		bool SeenL = false;
+		for (uint8 other = 0; other < index && !SeenL; other++)
+		{
+			SeenL = (_entries[other].Name[0] != '\0' &&
+				memcmp(_entries[other].Hash, _entries[index].Hash, IMAGE_HASH_SIZE) == 0);
+		}
+
+		if (!SeenL)
+		{
+			UsageL += _entries[index].StoredSize;
+		}
+	}
+
+	// The golden image keeps its file after its names are gone.
+	if (isOrphan(DeviceConfiguration.GoldenImage.c_str()))
+	{
+		File FileL = _fileSystem->open(DeviceConfiguration.GoldenImage, "r");
+		if (FileL)
+		{
+			UsageL += FileL.size();
+			FileL.close();
+		}
+	}
+
+	return UsageL;
+}
+
+/** @brief Bytes reserved by the running uploads.
+ *  @return uint32, Bytes.
+ */
+uint32 ImageStoreClass::reserved()
+{
+	return _reserved;
+}
+
+/** @brief Get a recent eviction.
+ *  @param index uint8, 0 is the newest.
+ *  @return const ImageEviction_t*, The eviction or NULL.
+ */
+const ImageEviction_t* ImageStoreClass::eviction(uint8 index)
+{
+	if (index >= _evictionCount)
+	{
+		return NULL;
+	}
+
+	return &_evictions[(_nextEviction + IMAGE_EVICTION_HISTORY - 1 - index) % IMAGE_EVICTION_HISTORY];
+}
+
+/** @brief Find an image by name.
+ *  @param name const char*, Name of the image.
+ *  @return const ImageEntry_t*, The entry or NULL.
+ */
+const ImageEntry_t* ImageStoreClass::find(const char* name)
+{
+	return lookup(name);
+}
+
+/** @brief Get a manifest entry for listing.
+ *  @param index uint8, Index below IMAGE_STORE_ENTRIES.
+ *  @return const ImageEntry_t*, The entry or NULL for a free one.
+ */
+const ImageEntry_t* ImageStoreClass::entry(uint8 index)
+{
+	if (index >= IMAGE_STORE_ENTRIES || _entries[index].Name[0] == '\0')
+	{
+		return NULL;
+	}
+
+	return &_entries[index];
+}
+
+/** @brief Count of the stored names.
+ *  @return uint8, Names.
+ */
+uint8 ImageStoreClass::count()
+{
+	return _count;
+}
+
+/** @brief Get the file of an image name or of a plain file.
+ *  @param name const char*, Name of the image or file path.
+ *  @param path char*, IMAGE_NAME_SIZE buffer for the file.
+ *  @return bool, True when the file exists.
+ */
+bool ImageStoreClass::resolve(const char* name, char* path)
+{
+	if (name == NULL || strlen(name) >= IMAGE_NAME_SIZE)
+	{
+		return false;
+	}
+
+	const ImageEntry_t* EntryL = lookup(name);
+	if (EntryL != NULL)
+	{
+		blobPath(EntryL->Hash, path);
+		return true;
+	}
+
+	if (!_fileSystem->exists(name))
+	{
+		return false;
+	}
+
+	strcpy(path, name);
+	return true;
+}
+
+/** @brief Check an image against the target before it is queued.
+ *  @param name const char*, Name of the image.
+ *  @param error const char**, Reason of a refusal, may be NULL.
+ *  @return uint8, Ok, also for files without properties, Error when it can not be programmed.
+ *  @see StatusCodes.h
+ */
+uint8 ImageStoreClass::precheck(const char* name, const char** error)
+{
+	const char* ErrorL = NULL;
+	const ImageEntry_t* EntryL = lookup(name);
+
+	// Plain files and images stored before have no properties.
+	if (EntryL != NULL && EntryL->Info.RecordTypes != 0)
+	{
+		if (EntryL->Info.UsedBytes == 0)
+		{
+			ErrorL = "Image has no data";
+		}
+		else if (EntryL->Info.MaxAddress >= STK500_FLASH_SIZE)
+		{
+			ErrorL = "Image does not fit the target";
+		}
+	}
+
+	if (error != NULL)
+	{
+		*error = ErrorL;
+	}
+
+	return (ErrorL == NULL) ? StatusCodes::Ok : StatusCodes::Error;
+}
+
+/** @brief File of a content hash.
+ *  @param hash const uint8*, Content hash.
+ *  @param path char*, IMAGE_NAME_SIZE buffer for the file.
+ *  @return Void.
+ */
+void ImageStoreClass::blobPath(const uint8* hash, char* path)
+{
+	int LengthL = snprintf(path, IMAGE_NAME_SIZE, "%s/", IMAGE_STORE_DIR);
+
+	for (uint8 index = 0; index < IMAGE_BLOB_HASH_SIZE; index++)
+	{
+		LengthL += snprintf(path + LengthL, IMAGE_NAME_SIZE - LengthL, "%02x", hash[index]);
+	}
+}
+
+/** @brief Text form of a content hash.
+ *  @param hash const uint8*, Content hash.
+ *  @param text char*, Buffer of IMAGE_HASH_SIZE * 2 + 1 characters.
+ *  @return Void.
+ */
+void ImageStoreClass::hashToHex(const uint8* hash, char* text)
+{
+	for (uint8 index = 0; index < IMAGE_HASH_SIZE; index++)
+	{
+		sprintf(text + index * 2, "%02x", hash[index]);
+	}
+}
+
+/** @brief Read the manifest file.
+ *  @return bool, Successful loading.
+ */
+bool ImageStoreClass::load()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	File FileL = _fileSystem->open(IMAGE_STORE_INDEX, "r");
+	if (!FileL)
+	{
+		return false;
+	}
+
+	ImageIndexHeader_t HeaderL;
+	if (FileL.read((uint8*)&HeaderL, sizeof(HeaderL)) != sizeof(HeaderL) ||
+		HeaderL.Magic != IMAGE_INDEX_MAGIC ||
+		HeaderL.Version != IMAGE_INDEX_VERSION ||
+		HeaderL.RecordSize == 0 ||
+		HeaderL.RecordSize > sizeof(ImageEntry_t))
+	{
+		DEBUGLOG("Bad image manifest.\r\n");
+		FileL.close();
+		return false;
+	}
+
+	while (_count < IMAGE_STORE_ENTRIES &&
+		FileL.read((uint8*)&_entries[_count], HeaderL.RecordSize) == HeaderL.RecordSize)
+	{
+		_entries[_count].Name[IMAGE_NAME_SIZE - 1] = '\0';
+		_entries[_count].Mcu[IMAGE_MCU_SIZE - 1] = '\0';
+		_count++;
+	}
+
+	FileL.close();
+
+	return true;
+}
+
+/** @brief Write the manifest file.
+ *  @return bool, Successful saving.
+ */
+bool ImageStoreClass::save()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	File FileL = _fileSystem->open(IMAGE_STORE_INDEX, "w");
+	if (!FileL)
+	{
+		DEBUGLOG("Can not write the image manifest.\r\n");
+		return false;
+	}
+
+	ImageIndexHeader_t HeaderL = { IMAGE_INDEX_MAGIC, IMAGE_INDEX_VERSION, sizeof(ImageEntry_t) };
+	FileL.write((uint8*)&HeaderL, sizeof(HeaderL));
+
+	for (uint8 index = 0; index < IMAGE_STORE_ENTRIES; index++)
+	{
+		if (_entries[index].Name[0] != '\0')
+		{
+			FileL.write((uint8*)&_entries[index], sizeof(ImageEntry_t));
+		}
+	}
+
+	FileL.close();
+
+	return true;
+}
+
+#ifdef IMAGE_STORE_PACKED
+
+/** @brief Start packing the file of a content hash.
+ *  @param hash const uint8*, Content hash.
+ *  @return bool, True when an Intel HEX file is being packed, false when it is packed already.
+ */
+bool ImageStoreClass::beginPack(const uint8* hash)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	char BlobL[IMAGE_NAME_SIZE];
+	blobPath(hash, BlobL);
+
+	_packSource = _fileSystem->open(BlobL, "r");
+	if (!_packSource)
+	{
+		return false;
+	}
+
+	PackedImageHeader_t HeaderL;
+	if (_packSource.read((uint8*)&HeaderL, sizeof(HeaderL)) == sizeof(HeaderL) &&
+		HeaderL.Magic == PACKED_IMAGE_MAGIC && HeaderL.Version == PACKED_IMAGE_VERSION)
+	{
+		_packSource.close();
+		return false;
+	}
+	_packSource.seek(0, SeekSet);
+
+	char PathL[IMAGE_NAME_SIZE];
+	snprintf(PathL, sizeof(PathL), "%s/tmpp", IMAGE_STORE_DIR);
+	_packDestination = _fileSystem->open(PathL, "w");
+	if (!_packDestination)
+	{
+		_packSource.close();
+		return false;
+	}
+
+	memcpy(_packHash, hash, IMAGE_HASH_SIZE);
+
+	_packReader = new HexLineReader();
+	_packParser = new IntelHexParserClass();
+	_packEncoder = new LzssEncoder();
+
+	PackedImageHeader_t PackedL = { PACKED_IMAGE_MAGIC, PACKED_IMAGE_VERSION, 0 };
+	_packDestination.write((uint8*)&PackedL, sizeof(PackedL));
+
+	_packReader->begin(&_packSource, true);
+	_packParser->Reset();
+	_packEncoder->begin(&_packDestination);
+
+	DEBUGLOG("Packing %s\r\n", BlobL);
+
+	return true;
+}
+
+/** @brief Pack up to IMAGE_PACK_STEP_LINES lines.
+ *  @return uint8, Busy while lines are left, Ok at the end of the file, Error when it does not parse.
+ *  @see StatusCodes.h
+ */
+uint8 ImageStoreClass::stepPack()
+{
+	FlashPage_t PageL;
+
+	for (uint8 line = 0; line < IMAGE_PACK_STEP_LINES; line++)
+	{
+		byte* LineL;
+		size_t LengthL;
+		uint8 StateL = _packReader->next(&LineL, &LengthL);
+
+		if (StateL == StatusCodes::Busy)
+		{
+			// Drained without an end of file record.
+			if (_packReader->isEnd())
+			{
+				return StatusCodes::Error;
+			}
+			continue;
+		}
+
+		if (StateL != StatusCodes::Ok)
+		{
+			return StatusCodes::Error;
+		}
+
+		if (LengthL < HEX_RECORD_MIN_LENGTH)
+		{
+			continue;
+		}
+
+		if (!_packParser->IsRecordValid(LineL, LengthL))
+		{
+			return StatusCodes::Error;
+		}
+
+		_packParser->ParseLine(LineL);
+
+		if (_packParser->IsPageReady())
+		{
+			byte* AddressL = _packParser->GetLoadAddress();
+			PageL.Address[0] = AddressL[0];
+			PageL.Address[1] = AddressL[1];
+			memcpy(PageL.Data, _packParser->GetMemoryPage(), STK500_PAGE_SIZE);
+			_packEncoder->write((uint8*)&PageL, sizeof(PageL));
+		}
+
+		if (_packParser->IsEndOfFile())
+		{
+			return StatusCodes::Ok;
+		}
+	}
+
+	return StatusCodes::Busy;
+}
+
+/** @brief Stop packing, a complete packed image replaces the Intel HEX file.
+ *  @param keep bool, The packed image is complete.
+ *  @return Void.
+ */
+void ImageStoreClass::endPack(bool keep)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	uint32 SizeL = 0;
+	if (keep)
+	{
+		_packEncoder->end();
+		SizeL = sizeof(PackedImageHeader_t) + _packEncoder->size();
+	}
+
+	_packSource.close();
+	_packDestination.close();
+
+	delete _packReader;
+	delete _packParser;
+	delete _packEncoder;
+	_packReader = NULL;
+	_packParser = NULL;
+	_packEncoder = NULL;
+
+	char PathL[IMAGE_NAME_SIZE];
+	snprintf(PathL, sizeof(PathL), "%s/tmpp", IMAGE_STORE_DIR);
+
+	char BlobL[IMAGE_NAME_SIZE];
+	blobPath(_packHash, BlobL);
+
+	// Images that do not parse are kept as they came.
+	if (!keep || !_fileSystem->remove(BlobL))
+	{
+		DEBUGLOG("Not packed, kept as is: %s\r\n", BlobL);
+		_fileSystem->remove(PathL);
+		return;
+	}
+
+	if (!_fileSystem->rename(PathL, BlobL))
+	{
+		DEBUGLOG("Can not move the packed image to %s\r\n", BlobL);
+		return;
+	}
+
+	for (uint8 index = 0; index < IMAGE_STORE_ENTRIES; index++)
+	{
+		if (_entries[index].Name[0] != '\0' && memcmp(_entries[index].Hash, _packHash, IMAGE_HASH_SIZE) == 0)
+		{
+			_entries[index].StoredSize = SizeL;
+		}
+	}
+
+	save();
+
+	DEBUGLOG("Packed %s, %u bytes\r\n", BlobL, SizeL);
+}
+
+#endif // IMAGE_STORE_PACKED
+
+/** @brief Move a plain file in to the store.
+ *  @param path const char*, The file, its path becomes the name.
+ *  @return Void.
+ */
+void ImageStoreClass::import(const char* path)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	File SourceL = _fileSystem->open(path, "r");
+	if (!SourceL)
+	{
+		return;
+	}
+
+	ImageWriter WriterL;
+	if (!open(&WriterL, SourceL.size()))
+	{
+		SourceL.close();
+		return;
+	}
+
+	uint8 BufferL[256];
+	int CountL = 0;
+	while ((CountL = SourceL.read(BufferL, sizeof(BufferL))) > 0)
+	{
+		WriterL.write(BufferL, CountL);
+	}
+	SourceL.close();
+
+	// Keep the file when the manifest is full.
+	if (commit(&WriterL, path, NULL) == StatusCodes::Ok)
+	{
+		_fileSystem->remove(path);
+	}
+}
+
+/** @brief Remove the file of a content hash nothing points to any more.
+ *  @param hash const uint8*, Content hash.
+ *  @return Void.
+ */
+void ImageStoreClass::release(const uint8* hash)
+{
+	char BlobL[IMAGE_NAME_SIZE];
+	blobPath(hash, BlobL);
+
+	releaseFile(BlobL);
+}
+
+/** @brief Check for a content file of the store no name points to.
+ *  @param path const char*, The file.
+ *  @return bool, True for a content file of IMAGE_STORE_DIR without names.
+ */
+bool ImageStoreClass::isOrphan(const char* path)
+{
+	// Only content files, the manifest and the temporary files have other names.
+	const size_t DirLengthL = strlen(IMAGE_STORE_DIR "/");
+	if (strncmp(path, IMAGE_STORE_DIR "/", DirLengthL) != 0 ||
+		strlen(path) != DirLengthL + IMAGE_BLOB_HASH_SIZE * 2 ||
+		strspn(path + DirLengthL, "0123456789abcdef") != IMAGE_BLOB_HASH_SIZE * 2)
+	{
+		return false;
+	}
+
+	char BlobL[IMAGE_NAME_SIZE];
+	for (uint8 index = 0; index < IMAGE_STORE_ENTRIES; index++)
+	{
+		if (_entries[index].Name[0] == '\0')
+		{
+			continue;
+		}
+
+		blobPath(_entries[index].Hash, BlobL);
+		if (strcmp(BlobL, path) == 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/** @brief Find an entry by name.
+ *  @param name const char*, Name of the image.
+ *  @return ImageEntry_t*, The entry or NULL.
+ */
+ImageEntry_t* ImageStoreClass::lookup(const char* name)
+{
+	if (name == NULL || name[0] == '\0')
+	{
+		return NULL;
+	}
+
+	for (uint8 index = 0; index < IMAGE_STORE_ENTRIES; index++)
+	{
+		if (strncmp(_entries[index].Name, name, IMAGE_NAME_SIZE) == 0)
+		{
+			return &_entries[index];
+		}
+	}
+
+	return NULL;
+}
+
+/** @brief Check if a size fits in the file system and the quota.
+ *  @param size uint32, Bytes to fit beside the reservations.
+ *  @return bool, True when it fits.
+ */
+bool ImageStoreClass::fits(uint32 size)
+{
+	FSInfo InfoL;
+	if (!_fileSystem->info(InfoL))
+	{
+		return false;
+	}
+
+	uint32 FreeL = (InfoL.totalBytes > InfoL.usedBytes) ? InfoL.totalBytes - InfoL.usedBytes : 0;
+	if ((uint64_t)size + _reserved + IMAGE_STORE_HEADROOM > FreeL)
+	{
+		return false;
+	}
+
+#if IMAGE_STORE_QUOTA > 0
+
+	if ((uint64_t)usage() + _reserved + size > IMAGE_STORE_QUOTA)
+	{
+		return false;
+	}
+
+#endif // IMAGE_STORE_QUOTA
+
+	return true;
+}
+
+/** @brief Remove the least recently used image that may go.
+ *  @return bool, True when an image was evicted.
+ */
+bool ImageStoreClass::evict()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	ImageEntry_t* VictimL = NULL;
+	uint32 VictimUsedL = 0;
+	char BlobL[IMAGE_NAME_SIZE];
+
+	for (uint8 index = 0; index < IMAGE_STORE_ENTRIES; index++)
+	{
+		ImageEntry_t* EntryL = &_entries[index];
+		if (EntryL->Name[0] == '\0' || EntryL->Pinned)
+		{
+			continue;
+		}
+
+		// The golden image stays for the rollback.
+		blobPath(EntryL->Hash, BlobL);
+		if (DeviceConfiguration.GoldenImage == BlobL)
+		{
+			continue;
+		}
+
+		// Jobs waiting for the image keep it.
+		bool UsedL = false;
+		for (uint8 slot = 0; slot < FLASH_JOB_SLOTS && !UsedL; slot++)
+		{
+			const FlashJob_t* JobL = FlashJobs.slot(slot);
+			UsedL = (JobL != NULL && (JobL->State == JobStates::JobQueued || JobL->State == JobStates::JobRunning) &&
+				strncmp(JobL->Path, EntryL->Name, IMAGE_NAME_SIZE) == 0);
+		}
+
+		if (UsedL)
+		{
+			continue;
+		}
+
+		// A fresh upload counts as used, so it is not evicted before its first flash.
+		uint32 LastUsedL = (EntryL->FlashedAt > EntryL->UploadedAt) ? EntryL->FlashedAt : EntryL->UploadedAt;
+		if (VictimL == NULL || LastUsedL < VictimUsedL)
+		{
+			VictimL = EntryL;
+			VictimUsedL = LastUsedL;
+		}
+	}
+
+	if (VictimL == NULL)
+	{
+		DEBUGLOG("Nothing to evict.\r\n");
+		return false;
+	}
+
+	ImageEviction_t* EvictionL = &_evictions[_nextEviction];
+	_nextEviction = (_nextEviction + 1) % IMAGE_EVICTION_HISTORY;
+	if (_evictionCount < IMAGE_EVICTION_HISTORY)
+	{
+		_evictionCount++;
+	}
+
+	strncpy(EvictionL->Name, VictimL->Name, IMAGE_NAME_SIZE);
+	EvictionL->StoredSize = VictimL->StoredSize;
+	EvictionL->EvictedAt = now();
+
+	DEBUGLOG("Evict %s, %u bytes\r\n", VictimL->Name, VictimL->StoredSize);
+	remove(VictimL->Name);
+
+	return true;
+}
+
+/** @brief Current time in seconds, since boot when the clock is not set.
+ *  @return uint32, Time.
+ */
+uint32 ImageStoreClass::now()
+{
+	// Without a clock the time since boot still orders the events.
+	time_t NowL = time(NULL);
+	return (NowL > 0) ? (uint32)NowL : millis() / 1000;
+}
+
+#pragma endregion
+
+/* @brief Singelton image store instance. */
+ImageStoreClass ImageStore;
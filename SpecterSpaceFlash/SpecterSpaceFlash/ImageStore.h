@@ -0,0 +1,382 @@
+// ImageStore.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _IMAGESTORE_h
+#define _IMAGESTORE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <FS.h>
+
+#include <MD5Builder.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#include "StatusCodes.h"
+
+#include "STK500.h"
+
+#include "Storage.h"
+
+#include "ImageWriter.h"
+
+class HexLineReader;
+
+class IntelHexParserClass;
+
+class LzssEncoder;
+
+#pragma endregion
+
+#pragma region Definitions
+
+/** @brief Bytes of the hash used in the file name, SPIFFS names are limited to 31 characters. */
+#define IMAGE_BLOB_HASH_SIZE 8
+
+/** @brief Magic number of the manifest file, "SSFI". */
+#define IMAGE_INDEX_MAGIC 0x49465353UL
+
+/** @brief Layout version of the manifest file. */
+#define IMAGE_INDEX_VERSION 1
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Manifest entry of a stored image.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	char Name[IMAGE_NAME_SIZE]; ///< Name the image was uploaded as, empty for a free entry.
+	uint8 Hash[IMAGE_HASH_SIZE]; ///< MD5 of the content.
+	uint32 Size; ///< Bytes of the HEX file.
+	char Mcu[IMAGE_MCU_SIZE]; ///< Target MCU.
+	uint16 Pages; ///< Flash pages of the image.
+	uint32 UploadedAt; ///< Upload time in seconds, since boot when the clock is not set.
+	uint32 StoredSize; ///< Bytes used in the file system.
+	uint32 FlashedAt; ///< Time of the last successful flash, 0 for never.
+	uint8 Pinned; ///< Never evicted.
+	ImageInfo_t Info; ///< Found at the upload, cleared for images stored before.
+} ImageEntry_t;
+
+/** @brief Image removed to make room.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	char Name[IMAGE_NAME_SIZE]; ///< Name of the image.
+	uint32 StoredSize; ///< Bytes it used.
+	uint32 EvictedAt; ///< Time of the eviction.
+} ImageEviction_t;
+
+/** @brief Header of the manifest file.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint32 Magic; ///< IMAGE_INDEX_MAGIC.
+	uint16 Version; ///< IMAGE_INDEX_VERSION.
+	uint16 RecordSize; ///< Size of one entry, older shorter entries are read with the new fields cleared.
+} ImageIndexHeader_t;
+
+#pragma endregion
+
+/** @brief Deduplicated image store.
+ *
+ *  Images are kept once per content under IMAGE_STORE_DIR/<hash>,
+ *  the names point to them through a manifest that lives in RAM
+ *  and is written to IMAGE_STORE_INDEX on every change.
+ */
+class ImageStoreClass
+{
+public:
+
+	/** @brief Load the manifest and take over the images of the old /hex folder.
+	 *  @param fs FS*, File system.
+	 *  @return Void.
+	 */
+	void begin(FS* fs);
+
+	/** @brief Start an upload, reserving its declared size and evicting images when needed.
+	 *  @param writer ImageWriter*, Writer of the upload.
+	 *  @param size uint32, Declared size of the upload.
+	 *  @return bool, Successful opening, false when there is no room.
+	 */
+	bool open(ImageWriter* writer, uint32 size);
+
+	/** @brief Drop an upload and its reservation.
+	 *  @param writer ImageWriter*, Writer of the upload.
+	 *  @return Void.
+	 */
+	void cancel(ImageWriter* writer);
+
+	/** @brief Store a finished upload under a name, the content is kept only once.
+	 *  @param writer ImageWriter*, Writer of the upload.
+	 *  @param name const char*, Name of the image.
+	 *  @param mcu const char*, Target MCU, NULL for IMAGE_DEFAULT_MCU.
+	 *  @return uint8, Ok, Busy when the manifest is full, Error otherwise.
+	 *  @see StatusCodes.h
+	 */
+	uint8 commit(ImageWriter* writer, const char* name, const char* mcu);
+
+	/** @brief Pack the stored Intel HEX images a few lines at a time. Call it from the main loop.
+	 *  @return Void.
+	 */
+	void handle();
+
+	/** @brief Remove a name, the content goes when nothing points to it.
+	 *  @param name const char*, Name of the image.
+	 *  @return uint8, Ok, Error for an unknown name.
+	 *  @see StatusCodes.h
+	 */
+	uint8 remove(const char* name);
+
+	/** @brief Remove a content file of the store that no name and not the golden image points to.
+	 *  @param path const char*, The file, other files stay.
+	 *  @return Void.
+	 */
+	void releaseFile(const char* path);
+
+	/** @brief Record a successful flash for the eviction order.
+	 *  @param name const char*, Name of the image.
+	 *  @return Void.
+	 */
+	void touch(const char* name);
+
+	/** @brief Keep an image from eviction.
+	 *  @param name const char*, Name of the image.
+	 *  @param pinned bool, Pin or unpin.
+	 *  @return uint8, Ok, Error for an unknown name.
+	 *  @see StatusCodes.h
+	 */
+	uint8 pin(const char* name, bool pinned);
+
+	/** @brief Evict least recently used images until the size fits.
+	 *  @param size uint32, Bytes to fit beside the reservations.
+	 *  @return bool, True when the size fits.
+	 */
+	bool makeRoom(uint32 size);
+
+	/** @brief Bytes used by the stored images, shared content counted once.
+	 *  @return uint32, Bytes.
+	 */
+	uint32 usage();
+
+	/** @brief Bytes reserved by the running uploads.
+	 *  @return uint32, Bytes.
+	 */
+	uint32 reserved();
+
+	/** @brief Get a recent eviction.
+	 *  @param index uint8, 0 is the newest.
+	 *  @return const ImageEviction_t*, The eviction or NULL.
+	 */
+	const ImageEviction_t* eviction(uint8 index);
+
+	/** @brief Find an image by name.
+	 *  @param name const char*, Name of the image.
+	 *  @return const ImageEntry_t*, The entry or NULL.
+	 */
+	const ImageEntry_t* find(const char* name);
+
+	/** @brief Get a manifest entry for listing.
+	 *  @param index uint8, Index below IMAGE_STORE_ENTRIES.
+	 *  @return const ImageEntry_t*, The entry or NULL for a free one.
+	 */
+	const ImageEntry_t* entry(uint8 index);
+
+	/** @brief Count of the stored names.
+	 *  @return uint8, Names.
+	 */
+	uint8 count();
+
+	/** @brief Get the file of an image name or of a plain file.
+	 *  @param name const char*, Name of the image or file path.
+	 *  @param path char*, IMAGE_NAME_SIZE buffer for the file.
+	 *  @return bool, True when the file exists.
+	 */
+	bool resolve(const char* name, char* path);
+
+	/** @brief Check an image against the target before it is queued.
+	 *  @param name const char*, Name of the image.
+	 *  @param error const char**, Reason of a refusal, may be NULL.
+	 *  @return uint8, Ok, also for files without properties, Error when it can not be programmed.
+	 *  @see StatusCodes.h
+	 */
+	uint8 precheck(const char* name, const char** error);
+
+	/** @brief File of a content hash.
+	 *  @param hash const uint8*, Content hash.
+	 *  @param path char*, IMAGE_NAME_SIZE buffer for the file.
+	 *  @return Void.
+	 */
+	static void blobPath(const uint8* hash, char* path);
+
+	/** @brief Text form of a content hash.
+	 *  @param hash const uint8*, Content hash.
+	 *  @param text char*, Buffer of IMAGE_HASH_SIZE * 2 + 1 characters.
+	 *  @return Void.
+	 */
+	static void hashToHex(const uint8* hash, char* text);
+
+	/** @brief Current time in seconds, since boot when the clock is not set.
+	 *  @return uint32, Time.
+	 */
+	static uint32 now();
+
+private:
+
+	/** @brief Read the manifest file.
+	 *  @return bool, Successful loading.
+	 */
+	bool load();
+
+	/** @brief Write the manifest file.
+	 *  @return bool, Successful saving.
+	 */
+	bool save();
+
+#ifdef IMAGE_STORE_PACKED
+
+	/** @brief Start packing the file of a content hash.
+	 *  @param hash const uint8*, Content hash.
+	 *  @return bool, True when an Intel HEX file is being packed, false when it is packed already.
+	 */
+	bool beginPack(const uint8* hash);
+
+	/** @brief Pack up to IMAGE_PACK_STEP_LINES lines.
+	 *  @return uint8, Busy while lines are left, Ok at the end of the file, Error when it does not parse.
+	 *  @see StatusCodes.h
+	 */
+	uint8 stepPack();
+
+	/** @brief Stop packing, a complete packed image replaces the Intel HEX file.
+	 *  @param keep bool, The packed image is complete.
+	 *  @return Void.
+	 */
+	void endPack(bool keep);
+
+#endif // IMAGE_STORE_PACKED
+
+	/** @brief Move a plain file in to the store.
+	 *  @param path const char*, The file, its path becomes the name.
+	 *  @return Void.
+	 */
+	void import(const char* path);
+
+	/** @brief Remove the file of a content hash nothing points to any more.
+	 *  @param hash const uint8*, Content hash.
+	 *  @return Void.
+	 */
+	void release(const uint8* hash);
+
+	/** @brief Check for a content file of the store no name points to.
+	 *  @param path const char*, The file.
+	 *  @return bool, True for a content file of IMAGE_STORE_DIR without names.
+	 */
+	bool isOrphan(const char* path);
+
+	/** @brief Find an entry by name.
+	 *  @param name const char*, Name of the image.
+	 *  @return ImageEntry_t*, The entry or NULL.
+	 */
+	ImageEntry_t* lookup(const char* name);
+
+	/** @brief Check if a size fits in the file system and the quota.
+	 *  @param size uint32, Bytes to fit beside the reservations.
+	 *  @return bool, True when it fits.
+	 */
+	bool fits(uint32 size);
+
+	/** @brief Remove the least recently used image that may go.
+	 *  @return bool, True when an image was evicted.
+	 */
+	bool evict();
+
+	/* @brief File system of the store. */
+	FS* _fileSystem = NULL;
+
+	/* @brief Manifest. */
+	ImageEntry_t _entries[IMAGE_STORE_ENTRIES];
+
+	/* @brief Used entries. */
+	uint8 _count = 0;
+
+	/* @brief Number of the next temporary file. */
+	uint8 _nextTemp = 0;
+
+	/* @brief Bytes reserved by the running uploads. */
+	uint32 _reserved = 0;
+
+	/* @brief Ring of recent evictions. */
+	ImageEviction_t _evictions[IMAGE_EVICTION_HISTORY];
+
+	/* @brief Next slot of the eviction ring. */
+	uint8 _nextEviction = 0;
+
+	/* @brief Used slots of the eviction ring. */
+	uint8 _evictionCount = 0;
+
+#ifdef IMAGE_STORE_PACKED
+
+	/* @brief Next manifest entry to pack, IMAGE_STORE_ENTRIES when all were seen. */
+	uint8 _packCursor = IMAGE_STORE_ENTRIES;
+
+	/* @brief Content hash of the image being packed. */
+	uint8 _packHash[IMAGE_HASH_SIZE];
+
+	/* @brief Intel HEX file being packed. */
+	File _packSource;
+
+	/* @brief Packed image being written. */
+	File _packDestination;
+
+	/* @brief Lines of the Intel HEX file, held only while an image is packed. */
+	HexLineReader* _packReader = NULL;
+
+	/* @brief Pages of the Intel HEX file, held only while an image is packed. */
+	IntelHexParserClass* _packParser = NULL;
+
+	/* @brief Compressor of the pages, held only while an image is packed. */
+	LzssEncoder* _packEncoder = NULL;
+
+#endif // IMAGE_STORE_PACKED
+};
+
+/* @brief Singelton image store instance. */
+extern ImageStoreClass ImageStore;
+
+#endif
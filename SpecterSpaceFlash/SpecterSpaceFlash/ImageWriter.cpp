@@ -0,0 +1,355 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "ImageWriter.h"
+
+#include "GeneralHelper.h"
+
+#pragma region ImageWriter
+
+/** @brief Create the temporary file.
+ *  @param fs FS*, File system.
+ *  @param path const char*, Temporary file.
+ *  @return bool, Successful opening.
+ */
+bool ImageWriter::begin(FS* fs, const char* path)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_fileSystem = fs;
+	strncpy(_path, path, IMAGE_NAME_SIZE - 1);
+	_path[IMAGE_NAME_SIZE - 1] = '\0';
+
+	if (!_file.begin(_fileSystem->open(_path, "w")))
+	{
+		return false;
+	}
+
+	_md5.begin();
+	memset(_hash, 0, sizeof(_hash));
+	_size = 0;
+	_reserved = 0;
+	_failed = false;
+	memset(&_info, 0, sizeof(_info));
+	_info.MinAddress = UINT32_MAX;
+	memset(_pageMap, 0, sizeof(_pageMap));
+	_lastPage = UINT32_MAX;
+	_baseAddress = 0;
+	_headerIndex = 0;
+
+	return true;
+}
+
+/** @brief Append data.
+ *  @param data const uint8*, Data.
+ *  @param len size_t, Length of the data.
+ *  @return size_t, Written bytes.
+ */
+size_t ImageWriter::write(const uint8* data, size_t len)
+{
+	if (!_file)
+	{
+		return 0;
+	}
+
+	// Beyond the reservation the file system may run full mid write.
+	if (_reserved > 0 && _size + len > _reserved)
+	{
+		DEBUGLOG("Upload is bigger than its reservation.\r\n");
+		_failed = true;
+		return 0;
+	}
+
+	size_t WrittenL = _file.write(data, len);
+	if (WrittenL != len)
+	{
+		DEBUGLOG("Write error during upload.\r\n");
+		_failed = true;
+	}
+
+	// MD5Builder takes at most 64 KB per call.
+	for (size_t offset = 0; offset < WrittenL; offset += 0xFFFF)
+	{
+		size_t PartL = WrittenL - offset;
+		_md5.add((uint8_t*)data + offset, (PartL > 0xFFFF) ? 0xFFFF : PartL);
+	}
+
+	_info.Crc32 = crc32_update(_info.Crc32, data, WrittenL);
+	scan(data, WrittenL);
+	_size += WrittenL;
+
+	return WrittenL;
+}
+
+/** @brief Close the file and finish the hash.
+ *  @return Void.
+ */
+void ImageWriter::close()
+{
+	if (!_file)
+	{
+		return;
+	}
+
+	if (!_file.close())
+	{
+		_failed = true;
+	}
+
+	DEBUGLOG("Upload %u bytes, %u chunks, %u file writes\r\n", _size, _file.chunks(), _file.writes());
+
+	if (_info.UsedBytes == 0)
+	{
+		_info.MinAddress = 0;
+	}
+	_info.FlashTime = flashTime(_info.UsedPages);
+
+	_md5.calculate();
+	_md5.getBytes(_hash);
+}
+
+/** @brief Close and remove the temporary file.
+ *  @return Void.
+ */
+void ImageWriter::discard()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_file.discard();
+
+	if (_fileSystem != NULL && _fileSystem->exists(_path))
+	{
+		_fileSystem->remove(_path);
+	}
+}
+
+/** @brief Check for an upload in progress.
+ *  @return bool, True while the file is open.
+ */
+bool ImageWriter::isOpen()
+{
+	return (bool)_file;
+}
+
+/** @brief Path of the temporary file.
+ *  @return const char*, Path.
+ */
+const char* ImageWriter::path()
+{
+	return _path;
+}
+
+/** @brief Written bytes.
+ *  @return uint32, Size of the file.
+ */
+uint32 ImageWriter::size()
+{
+	return _size;
+}
+
+/** @brief Flash pages of the data records seen so far.
+ *  @return uint16, Pages.
+ */
+uint16 ImageWriter::pages()
+{
+	return _info.UsedPages;
+}
+
+/** @brief Properties of the image, complete after close().
+ *  @return const ImageInfo_t*, Properties.
+ */
+const ImageInfo_t* ImageWriter::info()
+{
+	return &_info;
+}
+
+/** @brief Content hash, valid after close().
+ *  @return const uint8*, IMAGE_HASH_SIZE bytes.
+ */
+const uint8* ImageWriter::hash()
+{
+	return _hash;
+}
+
+/** @brief Check for a refused or short write.
+ *  @return bool, True when the upload is incomplete.
+ */
+bool ImageWriter::hasFailed()
+{
+	return _failed;
+}
+
+/** @brief Bytes reserved for the upload.
+ *  @return uint32, Reservation, 0 for none.
+ */
+uint32 ImageWriter::reserved()
+{
+	return _reserved;
+}
+
+/** @brief Set the reservation, writes beyond it are refused.
+ *  @param size uint32, Reservation, 0 for none.
+ *  @return Void.
+ */
+void ImageWriter::setReserved(uint32 size)
+{
+	_reserved = size;
+}
+
+/** @brief Follow the records, they may span writes.
+ *  @param data const uint8*, Data.
+ *  @param len size_t, Length of the data.
+ *  @return Void.
+ */
+void ImageWriter::scan(const uint8* data, size_t len)
+{
+	for (size_t index = 0; index < len; index++)
+	{
+		char CharL = (char)data[index];
+
+		if (CharL == ':')
+		{
+			_headerIndex = 1;
+			_recordLength = 0;
+			_recordAddress = 0;
+			_recordType = 0;
+			_recordValue = 0;
+			continue;
+		}
+
+		if (_headerIndex == 0)
+		{
+			continue;
+		}
+
+		// Record is :LLAAAATT and the data, the base records carry a 16 bit word.
+		if (_headerIndex <= 2)
+		{
+			_recordLength = (_recordLength << 4) | hex2dec(CharL);
+		}
+		else if (_headerIndex <= 6)
+		{
+			_recordAddress = (_recordAddress << 4) | hex2dec(CharL);
+		}
+		else if (_headerIndex <= 8)
+		{
+			_recordType = (_recordType << 4) | hex2dec(CharL);
+		}
+		else
+		{
+			_recordValue = (_recordValue << 4) | hex2dec(CharL);
+		}
+
+		if (_headerIndex == 8)
+		{
+			if (_recordType < 8)
+			{
+				_info.RecordTypes |= (1 << _recordType);
+			}
+
+			if (_recordType == 0)
+			{
+				addRecord();
+			}
+
+			// Only the address records are read further.
+			if ((_recordType != 2 && _recordType != 4) || _recordLength < 2)
+			{
+				_headerIndex = 0;
+				continue;
+			}
+		}
+
+		if (_headerIndex == 12)
+		{
+			_baseAddress = (_recordType == 2) ? ((uint32)_recordValue << 4) : ((uint32)_recordValue << 16);
+			_headerIndex = 0;
+			continue;
+		}
+
+		_headerIndex++;
+	}
+}
+
+/** @brief Account a complete data record header.
+ *  @return Void.
+ */
+void ImageWriter::addRecord()
+{
+	if (_recordLength == 0)
+	{
+		return;
+	}
+
+	uint32 FirstL = _baseAddress + _recordAddress;
+	uint32 LastL = FirstL + _recordLength - 1;
+
+	_info.UsedBytes += _recordLength;
+	if (FirstL < _info.MinAddress)
+	{
+		_info.MinAddress = FirstL;
+	}
+	if (LastL > _info.MaxAddress)
+	{
+		_info.MaxAddress = LastL;
+	}
+
+	for (uint32 page = FirstL / STK500_PAGE_SIZE; page <= LastL / STK500_PAGE_SIZE; page++)
+	{
+		if (page < IMAGE_PAGE_MAP_PAGES)
+		{
+			if ((_pageMap[page / 8] & (1 << (page % 8))) == 0)
+			{
+				_pageMap[page / 8] |= (1 << (page % 8));
+				_info.UsedPages++;
+			}
+		}
+		// Above the map only the pages of consecutive records merge.
+		else if (page != _lastPage)
+		{
+			_lastPage = page;
+			_info.UsedPages++;
+		}
+	}
+}
+
+/** @brief Expected time to program pages at STK500_PORT_BAUDRATE.
+ *  @param pages uint16, Flash pages.
+ *  @return uint32, Time in ms.
+ */
+uint32 ImageWriter::flashTime(uint16 pages)
+{
+	// Load address is 4 bytes out and 2 back, program page 5 and the data out and 2 back.
+	const uint32 WireBytesL = 4 + 2 + 5 + STK500_PAGE_SIZE + 2;
+	const uint32 PageTimeL = (WireBytesL * 10UL * 1000000UL) / STK500_PORT_BAUDRATE + STK500_PAGE_WRITE_TIME * 1000UL;
+
+	return ((uint32)pages * PageTimeL) / 1000UL;
+}
+
+#pragma endregion
@@ -0,0 +1,223 @@
+// ImageWriter.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _IMAGEWRITER_h
+#define _IMAGEWRITER_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <FS.h>
+
+#include <MD5Builder.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "BlockWriter.h"
+
+#include "DebugPort.h"
+
+#pragma endregion
+
+#pragma region Definitions
+
+/** @brief Size of the MD5 content hash. */
+#define IMAGE_HASH_SIZE 16
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Properties of an image found while it is uploaded.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint32 MinAddress; ///< Lowest data address.
+	uint32 MaxAddress; ///< Highest data address.
+	uint32 UsedBytes; ///< Data bytes of the records.
+	uint16 UsedPages; ///< Flash pages holding data.
+	uint8 RecordTypes; ///< Bit per Intel HEX record type seen, 0 for an image without records.
+	uint32 Crc32; ///< CRC-32 of the file.
+	uint32 FlashTime; ///< Expected time to program it in ms at STK500_PORT_BAUDRATE.
+} ImageInfo_t;
+
+#pragma endregion
+
+/** @brief Writes an upload to a temporary file while hashing it and counting its pages. */
+class ImageWriter
+{
+public:
+
+	/** @brief Create the temporary file.
+	 *  @param fs FS*, File system.
+	 *  @param path const char*, Temporary file.
+	 *  @return bool, Successful opening.
+	 */
+	bool begin(FS* fs, const char* path);
+
+	/** @brief Append data.
+	 *  @param data const uint8*, Data.
+	 *  @param len size_t, Length of the data.
+	 *  @return size_t, Written bytes.
+	 */
+	size_t write(const uint8* data, size_t len);
+
+	/** @brief Close the file and finish the hash.
+	 *  @return Void.
+	 */
+	void close();
+
+	/** @brief Close and remove the temporary file.
+	 *  @return Void.
+	 */
+	void discard();
+
+	/** @brief Check for an upload in progress.
+	 *  @return bool, True while the file is open.
+	 */
+	bool isOpen();
+
+	/** @brief Path of the temporary file.
+	 *  @return const char*, Path.
+	 */
+	const char* path();
+
+	/** @brief Written bytes.
+	 *  @return uint32, Size of the file.
+	 */
+	uint32 size();
+
+	/** @brief Flash pages of the data records seen so far.
+	 *  @return uint16, Pages.
+	 */
+	uint16 pages();
+
+	/** @brief Properties of the image, complete after close().
+	 *  @return const ImageInfo_t*, Properties.
+	 */
+	const ImageInfo_t* info();
+
+	/** @brief Content hash, valid after close().
+	 *  @return const uint8*, IMAGE_HASH_SIZE bytes.
+	 */
+	const uint8* hash();
+
+	/** @brief Check for a refused or short write.
+	 *  @return bool, True when the upload is incomplete.
+	 */
+	bool hasFailed();
+
+	/** @brief Bytes reserved for the upload.
+	 *  @return uint32, Reservation, 0 for none.
+	 */
+	uint32 reserved();
+
+	/** @brief Set the reservation, writes beyond it are refused.
+	 *  @param size uint32, Reservation, 0 for none.
+	 *  @return Void.
+	 */
+	void setReserved(uint32 size);
+
+	/** @brief Expected time to program pages at STK500_PORT_BAUDRATE.
+	 *  @param pages uint16, Flash pages.
+	 *  @return uint32, Time in ms.
+	 */
+	static uint32 flashTime(uint16 pages);
+
+private:
+
+	/** @brief Follow the records, they may span writes.
+	 *  @param data const uint8*, Data.
+	 *  @param len size_t, Length of the data.
+	 *  @return Void.
+	 */
+	void scan(const uint8* data, size_t len);
+
+	/** @brief Account a complete data record header.
+	 *  @return Void.
+	 */
+	void addRecord();
+
+	/* @brief File system of the file. */
+	FS* _fileSystem = NULL;
+
+	/* @brief Temporary file, written in whole blocks. */
+	BlockWriter _file;
+
+	/* @brief Path of the temporary file. */
+	char _path[IMAGE_NAME_SIZE];
+
+	/* @brief Content hash. */
+	MD5Builder _md5;
+
+	/* @brief Finished content hash. */
+	uint8 _hash[IMAGE_HASH_SIZE];
+
+	/* @brief Written bytes. */
+	uint32 _size = 0;
+
+	/* @brief Bytes reserved in the store. */
+	uint32 _reserved = 0;
+
+	/* @brief A write was refused or short. */
+	bool _failed = false;
+
+	/* @brief Properties found so far. */
+	ImageInfo_t _info;
+
+	/* @brief Pages holding data, bit per page. */
+	uint8 _pageMap[IMAGE_PAGE_MAP_PAGES / 8];
+
+	/* @brief Last page counted above the page map. */
+	uint32 _lastPage = 0;
+
+	/* @brief Base of the extended segment or linear address records. */
+	uint32 _baseAddress = 0;
+
+	/* @brief Hex digits of the record seen, 0 outside of a record. */
+	uint8 _headerIndex = 0;
+
+	/* @brief Length field of the record. */
+	uint8 _recordLength = 0;
+
+	/* @brief Address field of the record. */
+	uint16 _recordAddress = 0;
+
+	/* @brief Type field of the record. */
+	uint8 _recordType = 0;
+
+	/* @brief First data word of the record, the base of the address records. */
+	uint16 _recordValue = 0;
+};
+
+#endif
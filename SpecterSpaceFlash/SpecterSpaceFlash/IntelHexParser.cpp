@@ -34,6 +34,23 @@ IntelHexParserClass::IntelHexParserClass()
 	_loadAddress[1] = 0x00;
 }
 
+void IntelHexParserClass::Reset()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_address = 0;
+	_length = 0;
+	_nextAddress = 0;
+	_memIdx = 0;
+	_recordType = 0;
+	_loadAddress[0] = 0x00;
+	_loadAddress[1] = 0x00;
+	_pageReady = false;
+	_firstRun = true;
+}
+
 void IntelHexParserClass::ParseLine(byte* hexline)
 {
 	DEBUGLOG("\r\n");
@@ -73,6 +90,50 @@ void IntelHexParserClass::ParseLine(byte* hexline)
 
 }
 
+bool IntelHexParserClass::IsRecordValid(byte* hexline, size_t length)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	// Start code, length, address, type and checksum at least.
+	if (length < 11 || (length % 2) == 0 || hexline[0] != ':') {
+		return false;
+	}
+
+	for (size_t x = 1; x < length; x++) {
+		if (!isxdigit(hexline[x])) {
+			return false;
+		}
+	}
+
+	int len = GetLength(hexline);
+	if (length != (size_t)(11 + len * 2)) {
+		return false;
+	}
+
+	char buff[3];
+	buff[2] = '\0';
+	byte sum = 0;
+
+	for (size_t x = 1; x < length; x = x + 2) {
+		buff[0] = hexline[x];
+		buff[1] = hexline[x + 1];
+		sum += strtol(buff, 0, 16);
+	}
+
+	if (sum != 0) {
+		return false;
+	}
+
+	// The data has to end on the page, pages are only taken when they are full.
+	if (GetRecordType(hexline) == 0 && _memIdx + len > (int)sizeof(_memoryPage)) {
+		return false;
+	}
+
+	return true;
+}
+
 bool IntelHexParserClass::IsPageReady()
 {
 	DEBUGLOG("\r\n");
@@ -82,6 +143,15 @@ bool IntelHexParserClass::IsPageReady()
 	return _pageReady;
 }
 
+bool IntelHexParserClass::IsEndOfFile()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	return _recordType == 1;
+}
+
 byte* IntelHexParserClass::GetMemoryPage()
 {
 	DEBUGLOG("\r\n");
@@ -118,7 +188,7 @@ void IntelHexParserClass::GetLoadAddress(byte* hexline)
 	_loadAddress[1] = strtol(buff, 0, 16);
 }
 
-byte* IntelHexParserClass::GetData(byte* hexline, int len)
+void IntelHexParserClass::GetData(byte* hexline, int len)
 {
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
@@ -41,10 +41,13 @@ class IntelHexParserClass
 {
 public:
 	IntelHexParserClass();
+	void Reset();
 	void ParseLine(byte* data);
+	bool IsRecordValid(byte* data, size_t length);
 	byte* GetMemoryPage();
 	byte* GetLoadAddress();
 	bool IsPageReady();
+	bool IsEndOfFile();
 
 private:
 	int _address = 0;
@@ -60,7 +63,7 @@ private:
 	int GetAddress(byte* hexline);
 	int GetLength(byte* hexline);
 	int GetRecordType(byte* hexline);
-	byte* GetData(byte* hexline, int len);
+	void GetData(byte* hexline, int len);
 	void GetLoadAddress(byte* hexline);
 	void EndOfFile();
 };
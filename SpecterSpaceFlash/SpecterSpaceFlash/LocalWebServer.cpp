@@ -35,11 +35,86 @@ LocalWebServerClass LocalWebServer(PORT_HTTP);
 
 #pragma endregion
 
+#pragma region LegacyRewrite
+
+/** @brief Constructor.
+ *  @param from const char*, Path of the command.
+ */
+LegacyRewrite::LegacyRewrite(const char* from) : AsyncWebRewrite(from, from)
+{
+}
+
+/** @brief Match the command and take the name after "&" as the file parameter.
+ *  @param request AsyncWebServerRequest*, Request object.
+ *  @return bool, True for "<from>&<name>".
+ */
+bool LegacyRewrite::match(AsyncWebServerRequest* request)
+{
+	if (!request->url().startsWith(_from + "&"))
+	{
+		return false;
+	}
+
+	// Read by the server right after the match.
+	_params = "file=" + request->url().substring(_from.length() + 1);
+
+	return true;
+}
+
+#pragma endregion
+
+#pragma region AdmissionHandler
+
+/** @brief Constructor.
+ *  @param admit ArRequestFilterFunction, Admission decision.
+ */
+AdmissionHandler::AdmissionHandler(ArRequestFilterFunction admit) : _admit(admit)
+{
+}
+
+/** @brief Take the request when it is not admitted.
+ *  @param request AsyncWebServerRequest*, Request object.
+ *  @return bool, True when the request is refused.
+ */
+bool AdmissionHandler::canHandle(AsyncWebServerRequest* request)
+{
+	return !_admit(request);
+}
+
+/** @brief Refuse the request with 503 and Retry-After.
+ *  @param request AsyncWebServerRequest*, Request object.
+ *  @return Void.
+ */
+void AdmissionHandler::handleRequest(AsyncWebServerRequest* request)
+{
+	AsyncWebServerResponse* response = request->beginResponse(503, "text/plain", "Busy");
+	response->addHeader("Retry-After", String(ADMISSION_RETRY_AFTER));
+	request->send(response);
+}
+
+#pragma endregion
+
 /** @brief Constructor.
  *  @param port, uint16 WEB server port.
  *  @return LocalWebServerClass
  */
-LocalWebServerClass::LocalWebServerClass(uint16 port) : AsyncWebServer(port) {}
+LocalWebServerClass::LocalWebServerClass(uint16 port) : AsyncWebServer(port), _events(PROGRESS_EVENTS_PATH)
+{
+	for (uint8 index = 0; index < UPLOAD_CONTEXTS; index++)
+	{
+		_uploads[index].Request = NULL;
+	}
+
+	for (uint8 index = 0; index < IMAGE_UPLOAD_CONTEXTS; index++)
+	{
+		_imageUploads[index].Request = NULL;
+	}
+
+	for (uint8 index = 0; index < ADMISSION_CLIENTS; index++)
+	{
+		_clients[index].Address = 0;
+	}
+}
 
 /** @brief Begin server.
  *  @param fs, FS file system.
@@ -53,6 +128,9 @@ void LocalWebServerClass::configure(FS* fs)
 
 	_fileSystem = fs;
 
+	// Tokens of an earlier run are not valid.
+	AuthSessions.begin();
+
 	// Configure and start Web server
 	AsyncWebServer::begin();
 
@@ -74,6 +152,11 @@ void LocalWebServerClass::configure(FS* fs)
  */
 void LocalWebServerClass::handle() {
 
+	publishProgress();
+
+	// The radio stays on the channel while data moves.
+	NetworkScan.handle(isTransferring());
+
 #ifdef ENABLE_OTA_ARDUINO
 
 	ArduinoOTA.handle();
@@ -154,6 +237,9 @@ void LocalWebServerClass::addHandlers() {
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
+	// Handlers are tried in order, a refused request goes no further.
+	addHandler(new AdmissionHandler([this](AsyncWebServerRequest *request) { return this->admit(request); }));
+
 #pragma region File editor API
 
 #ifdef ENABLE_WEB_EDITOR
@@ -190,7 +276,10 @@ void LocalWebServerClass::addHandlers() {
 	// First callback is called after the request has ended with all parsed arguments.
 	// Second callback handles file uploads at that location.
 	on("/edit", HTTP_POST,
-		[](AsyncWebServerRequest *request) { request->send(200, "text/plain", ""); },
+		[this](AsyncWebServerRequest *request) {
+		if (!this->checkAuth(request))
+			return request->requestAuthentication();
+		this->sendUploadResult(request); },
 		[this](AsyncWebServerRequest *request, String filename, size_t index, uint8 *data, size_t len, bool final) {
 		this->handleFileUpload(request, filename, index, data, len, final); });
 
@@ -198,6 +287,18 @@ void LocalWebServerClass::addHandlers() {
 
 #pragma endregion
 
+#pragma region Progress events
+
+	// Flash progress, one event is serialized and sent to all listeners.
+	// Sessions pass like on the other routes, the rest ends in the 401 of onNotFound.
+	// The filter runs for every request before the routes, only the stream is checked.
+	_events.setFilter([this](AsyncWebServerRequest *request) {
+		return (request->url() != PROGRESS_EVENTS_PATH) || this->checkAuth(request);
+	});
+	addHandler(&_events);
+
+#pragma endregion
+
 #pragma region Firmware update API
 
 #ifdef ENABLE_WEB_OTA
@@ -213,6 +314,8 @@ void LocalWebServerClass::addHandlers() {
 	on("/update", HTTP_POST, [this](AsyncWebServerRequest *request) {
 		if (!this->checkAuth(request))
 			return request->requestAuthentication();
+		if (request != this->_updateRequest)
+			return request->send(409, "text/plain", "Update in progress");
 		AsyncWebServerResponse *response = request->beginResponse(200, "text/html", (Update.hasError()) ? "FAIL" : "<META http-equiv=\"refresh\" content=\"15;URL=/update\">Update correct. Restarting...");
 		response->addHeader("Connection", "close");
 		response->addHeader("Access-Control-Allow-Origin", "*");
@@ -268,37 +371,26 @@ void LocalWebServerClass::addHandlers() {
 	// login.html
 	on("/login", HTTP_POST, [this](AsyncWebServerRequest *request) {
 		DEBUGLOG("%s\r\n", request->url().c_str());
-		if (request->args() == 2)
-		{
-			// TODO: Check Username and Password.
-			if (request->hasArg("HTTPUsername") &&
-				request->hasArg("HTTPPassword"))
-			{
-				request->redirect("/settings");
-				return;
-			}
-			else
-			{
-				if (!this->handleFileRead("/login.html", request))
-				{
-					request->send(404, "text/plain", "FileNotFound");
-					return;
-				}
-			}
-		}
-		else
+		if (request->args() == 2 &&
+			request->hasArg("HTTPUsername") &&
+			request->hasArg("HTTPPassword") &&
+			AuthSessions.checkCredentials(request->arg("HTTPUsername"), request->arg("HTTPPassword")))
 		{
-			if (!this->handleFileRead("/login.html", request))
-			{
-				request->send(404, "text/plain", "FileNotFound");
-				return;
-			}
+			// The cookie stands for the credentials from now on.
+			char TokenL[SESSION_TOKEN_LENGTH + 1];
+			AuthSessions.issue(TokenL);
+
+			AsyncWebServerResponse *response = request->beginResponse(302);
+			response->addHeader("Location", "/settings");
+			response->addHeader("Set-Cookie", AuthSessionsClass::cookie(TokenL));
+			request->send(response);
+			return;
 		}
 
+		// Bad or missing credentials get the form again, one reply per request.
 		if (!this->handleFileRead("/login.html", request))
 		{
 			request->send(404, "text/plain", "FileNotFound");
-			return;
 		}
 	});
 
@@ -373,17 +465,35 @@ void LocalWebServerClass::addHandlers() {
 	// login.html
 	on("/logout", HTTP_GET, [this](AsyncWebServerRequest *request) {
 		DEBUGLOG("%s\r\n", request->url().c_str());
-		if (this->checkAuth(request))
-		{
-			request->redirect("/login");
-			return;
-		}
+
+		AuthSessions.revoke(request);
+
+		AsyncWebServerResponse *response = request->beginResponse(302);
+		response->addHeader("Location", "/login");
+		response->addHeader("Set-Cookie", AuthSessionsClass::cookie(NULL));
+		request->send(response);
 	});
 
 #pragma endregion
 
 #pragma region API
 
+	// Token for "Authorization: Bearer" or the session cookie.
+	on("/api/v1/login", HTTP_POST, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		this->login(request);
+	});
+
+	// Revoke the token of the request.
+	on("/api/v1/logout", HTTP_POST, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		this->logout(request);
+	});
+
 	// Configuration parameters.
 	on("/api/v1/configuration", HTTP_GET, [this](AsyncWebServerRequest *request) {
 		DEBUGLOG("%s\r\n", request->url().c_str());
@@ -424,8 +534,8 @@ void LocalWebServerClass::addHandlers() {
 		this->sendNetworks(request);
 	});
 
-	// Restart the chip.
-	on("/api/v1/restart", HTTP_GET, [this](AsyncWebServerRequest *request)
+	// New WiFi scan.
+	on("/api/v1/scanNetworks/refresh", HTTP_POST, [this](AsyncWebServerRequest *request)
 	{
 		DEBUGLOG("%s\r\n", request->url().c_str());
 
@@ -435,18 +545,27 @@ void LocalWebServerClass::addHandlers() {
 			return;
 		}
 
-		ESP.restart();
+		this->refreshNetworks(request);
 	});
 
-#pragma endregion
+	// Queue flash, verify or read job.
+	on("/api/v1/jobs", HTTP_POST, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
 
-#pragma region Page not found API
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
 
-	// Called when the URL is not defined here.
-	// Use it to load content from SPIFFS.
-	onNotFound([this](AsyncWebServerRequest *request)
+		this->addJob(request);
+	});
+
+	// Stream-through flashing, the body is the Intel HEX image, "?store=name" keeps a copy.
+	on("/api/v1/flash/stream", HTTP_POST, [this](AsyncWebServerRequest *request)
 	{
-		DEBUGLOG("Not found: %s\r\n", request->url().c_str());
+		DEBUGLOG("%s\r\n", request->url().c_str());
 
 		if (!this->checkAuth(request))
 		{
@@ -454,659 +573,2726 @@ void LocalWebServerClass::addHandlers() {
 			return;
 		}
 
-		AsyncWebServerResponse *response = request->beginResponse(200);
-		response->addHeader("Connection", "close");
-		response->addHeader("Access-Control-Allow-Origin", "*");
-
-		if (!this->handleFileRead(request->url(), request))
+		this->sendStreamFlashResult(request);
+	}, NULL, [this](AsyncWebServerRequest *request, uint8 *data, size_t len, size_t index, size_t total)
+	{
+		if (index == 0 && this->checkAuth(request))
 		{
-			request->send(404, "text/plain", "FileNotFound");
+			StreamFlash.open(request, total);
 		}
 
-		delete response; // Free up memory!
+		StreamFlash.write(request, data, len, index);
 	});
 
-#pragma endregion
+	// Job state, "/api/v1/jobs/{id}" or all jobs.
+	on("/api/v1/jobs", HTTP_GET, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
 
-#pragma region Configuration files API
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
 
-#ifdef HIDE_SECRET
+		this->sendJob(request);
+	});
+
+	// Golden image of the target, POST with "file" pins it, empty unpins.
+	on("/api/v1/golden", HTTP_GET, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
 
-	on(SECRET_FILE, HTTP_GET, [this](AsyncWebServerRequest *request) {
 		if (!this->checkAuth(request))
-			return request->requestAuthentication();
-		AsyncWebServerResponse *response = request->beginResponse(403, "text/plain", "Forbidden");
-		response->addHeader("Connection", "close");
-		response->addHeader("Access-Control-Allow-Origin", "*");
-		request->send(response);
-	});
+		{
+			request->requestAuthentication();
+			return;
+		}
 
-#endif // HIDE_SECRET
+		this->handleGolden(request);
+	});
 
-#ifdef HIDE_CONFIG
+	on("/api/v1/golden", HTTP_POST, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
 
-	on(CONFIG_FILE, HTTP_GET, [this](AsyncWebServerRequest *request) {
 		if (!this->checkAuth(request))
-			return request->requestAuthentication();
-		AsyncWebServerResponse *response = request->beginResponse(403, "text/plain", "Forbidden");
-		response->addHeader("Connection", "close");
-		response->addHeader("Access-Control-Allow-Origin", "*");
-		request->send(response);
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		this->handleGolden(request);
 	});
 
-	on(USER_CONFIG_FILE, HTTP_GET, [this](AsyncWebServerRequest *request) {
+	// Manifest of the stored images.
+	on("/api/v1/images", HTTP_GET, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
 		if (!this->checkAuth(request))
-			return request->requestAuthentication();
-		AsyncWebServerResponse *response = request->beginResponse(403, "text/plain", "Forbidden");
-		response->addHeader("Connection", "close");
-		response->addHeader("Access-Control-Allow-Origin", "*");
-		request->send(response);
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		this->sendImages(request);
 	});
 
-#endif // HIDE_CONFIG
+	// Commit an upload session, "?id=&md5=". Before "/api/v1/uploads", the handlers match by prefix.
+	on("/api/v1/uploads/commit", HTTP_POST, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
 
-#pragma endregion
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
 
-}
+		this->commitUpload(request);
+	});
 
-/** @brief Check the authorization status.
- *  @param request, AsyncWebServer Request request object.
- *  @return boolean, True have to authenticate.
- */
-bool LocalWebServerClass::checkAuth(AsyncWebServerRequest *request)
-{
-	if (!DeviceConfiguration.HTTPAuthentication) {
-		return true;
-	}
-	else {
-		return request->authenticate(DeviceConfiguration.HTTPUsername.c_str(),
-			DeviceConfiguration.HTTPUsername.c_str());
-	}
-}
+	// Create an upload session, "?name=&size=&mcu=".
+	on("/api/v1/uploads", HTTP_POST, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
 
-#pragma region IO Oprations
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
 
-/** @brief Handle file list.
- *  @param request AsyncWebServerRequest, Request object.
- *  @return Void.
- */
-void LocalWebServerClass::handleFileList(AsyncWebServerRequest *request) {
-	DEBUGLOG("\r\n");
-	DEBUGLOG(__PRETTY_FUNCTION__);
-	DEBUGLOG("\r\n");
+		this->createUpload(request);
+	});
 
-	if (!request->hasArg("dir"))
+	// Chunk of an upload session, "?id=&offset=" with the chunk as an application/octet-stream body.
+	on("/api/v1/uploads", HTTP_PUT, [this](AsyncWebServerRequest *request)
 	{
-		request->send(500, "text/plain", "BAD ARGS");
-		return;
-	}
+		DEBUGLOG("%s\r\n", request->url().c_str());
 
-	String path = request->arg("dir");
-	DEBUGLOG("handleFileList: %s\r\n", path.c_str());
-	Dir dir = _fileSystem->openDir(path);
-	path = String();
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
 
-	String output = "[";
-	while (dir.next()) {
-		File entry = dir.openFile("r");
-		if (true)//entry.name()!="secret.json") // Do not show secrets
+		this->sendChunkResult(request);
+	}, NULL, [this](AsyncWebServerRequest *request, uint8 *data, size_t len, size_t index, size_t total)
+	{
+		if (index > 0 || this->checkAuth(request))
 		{
-			if (output != "[")
-				output += ',';
-			bool isDir = false;
-			output += "{\"type\":\"";
-			output += (isDir) ? "dir" : "file";
-			output += "\",\"name\":\"";
-			output += String(entry.name()).substring(1);
-			output += "\"}";
+			UploadSessions.write(request, request->arg("id").toInt(), request->arg("offset").toInt(), data, len, index, total);
 		}
-		entry.close();
-	}
+	});
 
-	output += "]";
-	DEBUGLOG("%s\r\n", output.c_str());
-	request->send(200, "text/json", output);
-}
+	// Received ranges of "?id=" or all upload sessions.
+	on("/api/v1/uploads", HTTP_GET, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
 
-/** @brief Read file.
- *  @param path String, File path.
- *  @param request AsyncWebServerRequest, Request object.
- *  @return Void.
- */
-bool LocalWebServerClass::handleFileRead(String path, AsyncWebServerRequest *request) {
-	DEBUGLOG("\r\n");
-	DEBUGLOG(__PRETTY_FUNCTION__);
-	DEBUGLOG("\r\n");
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
 
-	DEBUGLOG("handleFileRead: %s\r\n", path.c_str());
+		this->sendUploads(request);
+	});
 
-	if (path.endsWith("/"))
+	// Drop an upload session and its chunks, "?id=".
+	on("/api/v1/uploads", HTTP_DELETE, [this](AsyncWebServerRequest *request)
 	{
-		path += "index.htm";
-	}
+		DEBUGLOG("%s\r\n", request->url().c_str());
 
-	String contentType = getContentType(path, request);
-	String pathWithGz = path + ".gz";
-	if (_fileSystem->exists(pathWithGz) || _fileSystem->exists(path)) {
-		if (_fileSystem->exists(pathWithGz)) {
-			path += ".gz";
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
 		}
-		DEBUGLOG("Content type: %s\r\n", contentType.c_str());
-		AsyncWebServerResponse *response = request->beginResponse(*_fileSystem, path, contentType);
 
+		this->deleteUpload(request);
+	});
 
-		// Add header.
+	// Keep an image from eviction, "name" and "pinned" as 1 or 0.
+	on("/api/v1/images/pin", HTTP_POST, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		this->handlePin(request);
+	});
+
+	// Usage of the image store and the recent evictions.
+	on("/api/v1/storage", HTTP_GET, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		this->sendStorage(request);
+	});
+
+	// Phase timings of the recent jobs.
+	on("/api/v1/timeline", HTTP_GET, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		this->sendTimeline(request);
+	});
+
+	// Everything the dashboard polls for, in one document.
+	on("/api/v2/status", HTTP_GET, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		this->sendStatus(request);
+	});
+
+	// Restart the chip.
+	on("/api/v1/restart", HTTP_GET, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		ESP.restart();
+	});
+
+#pragma endregion
+
+#pragma region Programmer API
+
+	// The first programmer page sends "/delete&name", the name becomes "?file=".
+	addRewrite(new LegacyRewrite("/delete"));
+	addRewrite(new LegacyRewrite("/flash"));
+	addRewrite(new LegacyRewrite("/upload"));
+
+	// Stored images, "name;size;pages;flashTime;" per line.
+	on("/files", HTTP_GET, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		this->sendImageList(request);
+	});
+
+	// Remove an image, "?file=".
+	on("/delete", HTTP_GET | HTTP_DELETE, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		this->deleteImage(request);
+	});
+
+	// Queue the flashing of an image, "?file=".
+	on("/flash", HTTP_GET | HTTP_POST, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		this->flashImage(request);
+	});
+
+	// Store the raw body as an image, "?file=".
+	on("/upload", HTTP_POST | HTTP_PUT, [this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("%s\r\n", request->url().c_str());
+
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		this->sendImageUploadResult(request);
+	}, NULL, [this](AsyncWebServerRequest *request, uint8 *data, size_t len, size_t index, size_t total)
+	{
+		this->handleImageUpload(request, data, len, index, total);
+	});
+
+#pragma endregion
+
+#pragma region Page not found API
+
+	// Called when the URL is not defined here.
+	// Use it to load content from SPIFFS.
+	onNotFound([this](AsyncWebServerRequest *request)
+	{
+		DEBUGLOG("Not found: %s\r\n", request->url().c_str());
+
+		if (!this->checkAuth(request))
+		{
+			request->requestAuthentication();
+			return;
+		}
+
+		AsyncWebServerResponse *response = request->beginResponse(200);
+		response->addHeader("Connection", "close");
+		response->addHeader("Access-Control-Allow-Origin", "*");
+
+		if (!this->handleFileRead(request->url(), request))
+		{
+			request->send(404, "text/plain", "FileNotFound");
+		}
+
+		delete response; // Free up memory!
+	});
+
+#pragma endregion
+
+#pragma region Configuration files API
+
+#ifdef HIDE_SECRET
+
+	on(SECRET_FILE, HTTP_GET, [this](AsyncWebServerRequest *request) {
+		if (!this->checkAuth(request))
+			return request->requestAuthentication();
+		AsyncWebServerResponse *response = request->beginResponse(403, "text/plain", "Forbidden");
+		response->addHeader("Connection", "close");
+		response->addHeader("Access-Control-Allow-Origin", "*");
+		request->send(response);
+	});
+
+#endif // HIDE_SECRET
+
+#ifdef HIDE_CONFIG
+
+	on(CONFIG_FILE, HTTP_GET, [this](AsyncWebServerRequest *request) {
+		if (!this->checkAuth(request))
+			return request->requestAuthentication();
+		AsyncWebServerResponse *response = request->beginResponse(403, "text/plain", "Forbidden");
+		response->addHeader("Connection", "close");
+		response->addHeader("Access-Control-Allow-Origin", "*");
+		request->send(response);
+	});
+
+	on(USER_CONFIG_FILE, HTTP_GET, [this](AsyncWebServerRequest *request) {
+		if (!this->checkAuth(request))
+			return request->requestAuthentication();
+		AsyncWebServerResponse *response = request->beginResponse(403, "text/plain", "Forbidden");
+		response->addHeader("Connection", "close");
+		response->addHeader("Access-Control-Allow-Origin", "*");
+		request->send(response);
+	});
+
+#endif // HIDE_CONFIG
+
+#pragma endregion
+
+}
+
+/** @brief Check the authorization status.
+ *  @param request, AsyncWebServer Request request object.
+ *  @return boolean, True have to authenticate.
+ */
+bool LocalWebServerClass::checkAuth(AsyncWebServerRequest *request)
+{
+	if (!DeviceConfiguration.HTTPAuthentication) {
+		return true;
+	}
+
+	// One HMAC for a session, the credentials only without one.
+	if (AuthSessions.verify(request)) {
+		return true;
+	}
+
+	return request->authenticate(DeviceConfiguration.HTTPUsername.c_str(),
+		DeviceConfiguration.HTTPPassword.c_str());
+}
+
+/** @brief Admit a request by the free heap, the requests in progress and the rate of its client.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return bool, True when the request is served.
+ */
+bool LocalWebServerClass::admit(AsyncWebServerRequest *request)
+{
+	bool ReservedL = isReservedRoute(request);
+
+	// Upload and flash routes go on down to the half of the watermarks.
+	uint32 MinHeapL = ReservedL ? (ADMISSION_MIN_HEAP / 2) : ADMISSION_MIN_HEAP;
+	uint32 MinBlockL = ReservedL ? (ADMISSION_MIN_BLOCK / 2) : ADMISSION_MIN_BLOCK;
+	if (ESP.getFreeHeap() < MinHeapL || max_free_block() < MinBlockL)
+	{
+		DEBUGLOG("Shed %s, heap %u\r\n", request->url().c_str(), ESP.getFreeHeap());
+		_shedRequests++;
+		return false;
+	}
+
+	// The event stream outlives its request, it is not counted.
+	if (request->url() == PROGRESS_EVENTS_PATH)
+	{
+		return true;
+	}
+
+	uint8 LimitL = ReservedL ? ADMISSION_MAX_REQUESTS : (ADMISSION_MAX_REQUESTS - ADMISSION_RESERVED);
+	if (_activeRequests >= LimitL)
+	{
+		DEBUGLOG("Shed %s, %u requests\r\n", request->url().c_str(), _activeRequests);
+		_shedRequests++;
+		return false;
+	}
+
+	if (!takeClientToken(request->client()->getRemoteAddress()))
+	{
+		DEBUGLOG("Shed %s, rate of %s\r\n", request->url().c_str(), request->client()->remoteIP().toString().c_str());
+		_shedRequests++;
+		return false;
+	}
+
+	_activeRequests++;
+
+	// The one disconnect callback of the request, the handlers do not set their own.
+	request->onDisconnect([this, request]() { this->closeRequest(request); });
+
+	return true;
+}
+
+/** @brief Close an admitted request, the state it holds is released.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::closeRequest(AsyncWebServerRequest *request)
+{
+	if (_activeRequests > 0)
+	{
+		_activeRequests--;
+	}
+
+	// Each of them ignores a request it does not hold.
+#ifdef ENABLE_WEB_EDITOR
+	releaseUpload(request);
+#endif // ENABLE_WEB_EDITOR
+	releaseImageUpload(request);
+	abortUpdate(request);
+	StreamFlash.abort(request);
+	UploadSessions.abort(request);
+}
+
+/** @brief Take one request from the budget of a client.
+ *  @param address uint32, IPv4 address of the client.
+ *  @return bool, True when the client has requests left.
+ */
+bool LocalWebServerClass::takeClientToken(uint32 address)
+{
+	unsigned long NowL = millis();
+	AdmissionClient_t* ClientL = NULL;
+	AdmissionClient_t* OldestL = &_clients[0];
+
+	for (uint8 index = 0; index < ADMISSION_CLIENTS; index++)
+	{
+		if (_clients[index].Address == address)
+		{
+			ClientL = &_clients[index];
+			break;
+		}
+
+		// A free entry first, else the client seen least recently.
+		if (OldestL->Address != 0 &&
+			(_clients[index].Address == 0 || (NowL - _clients[index].Refill) > (NowL - OldestL->Refill)))
+		{
+			OldestL = &_clients[index];
+		}
+	}
+
+	if (ClientL == NULL)
+	{
+		ClientL = OldestL;
+		ClientL->Address = address;
+		ClientL->Tokens = ADMISSION_BURST * 1000UL;
+		ClientL->Refill = NowL;
+	}
+
+	// ADMISSION_RATE requests per second are 1000 * ADMISSION_RATE per 1000 ms.
+	unsigned long ElapsedL = NowL - ClientL->Refill;
+	if (ElapsedL >= (ADMISSION_BURST * 1000UL) / ADMISSION_RATE)
+	{
+		ClientL->Tokens = ADMISSION_BURST * 1000UL;
+	}
+	else
+	{
+		ClientL->Tokens = min((uint32)(ADMISSION_BURST * 1000UL), (uint32)(ClientL->Tokens + ElapsedL * ADMISSION_RATE));
+	}
+	ClientL->Refill = NowL;
+
+	if (ClientL->Tokens < 1000UL)
+	{
+		return false;
+	}
+
+	ClientL->Tokens -= 1000UL;
+
+	return true;
+}
+
+/** @brief Check for the upload and flash routes, they keep a reserved share of the server.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return bool, True for an upload or flash route.
+ */
+bool LocalWebServerClass::isReservedRoute(AsyncWebServerRequest *request)
+{
+	const String& UrlL = request->url();
+
+	// The first programmer page flashes with a GET.
+	if (UrlL == "/flash")
+	{
+		return true;
+	}
+
+	// The pages of the other routes are read like any page.
+	if (request->method() == HTTP_GET)
+	{
+		return false;
+	}
+
+	return UrlL == "/upload"
+		|| UrlL == "/edit"
+		|| UrlL == "/update"
+		|| UrlL == "/api/v1/jobs"
+		|| UrlL == "/api/v1/flash/stream"
+		|| UrlL == "/api/v1/uploads"
+		|| UrlL == "/api/v1/uploads/commit";
+}
+
+/** @brief Check for uploads, firmware updates and flash jobs in progress.
+ *  @return bool, True while data moves through the server or to the target.
+ */
+bool LocalWebServerClass::isTransferring()
+{
+	if (FlashJobs.isBusy() || UploadSessions.isBusy() || _updateRequest != NULL)
+	{
+		return true;
+	}
+
+	for (uint8 index = 0; index < UPLOAD_CONTEXTS; index++)
+	{
+		if (_uploads[index].Request != NULL)
+		{
+			return true;
+		}
+	}
+
+	for (uint8 index = 0; index < IMAGE_UPLOAD_CONTEXTS; index++)
+	{
+		if (_imageUploads[index].Request != NULL)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#pragma region IO Oprations
+
+/** @brief Handle file list.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::handleFileList(AsyncWebServerRequest *request) {
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (!request->hasArg("dir"))
+	{
+		request->send(500, "text/plain", "BAD ARGS");
+		return;
+	}
+
+	String path = request->arg("dir");
+	DEBUGLOG("handleFileList: %s\r\n", path.c_str());
+
+	bool first = true;
+	bool closed = false;
+
+	// Names come from the file index, no directory walk.
+	if (FileIndex.covers(path)) {
+		uint8 slot = 0;
+		request->send(ChunkedResponse.begin(request, "text/json", [path, slot, first, closed](uint16 item, char* text, size_t size) mutable -> size_t {
+			if (item == 0) {
+				return snprintf(text, size, "[");
+			}
+			while (slot < FILE_INDEX_ENTRIES) {
+				const FileIndexEntry_t* file = FileIndex.entry(slot++);
+				if (file != NULL && strncmp(file->Path, path.c_str(), path.length()) == 0) {
+					return fileListItem(text, size, file->Path + 1, &first);
+				}
+			}
+			if (closed) {
+				return CHUNK_END;
+			}
+			closed = true;
+			return snprintf(text, size, "]");
+		}));
+		return;
+	}
+
+	// One entry per item, the names are not collected first.
+	Dir dir = _fileSystem->openDir(path);
+	request->send(ChunkedResponse.begin(request, "text/json", [dir, path, first, closed](uint16 item, char* text, size_t size) mutable -> size_t {
+		if (item == 0) {
+			return snprintf(text, size, "[");
+		}
+		while (dir.next()) {
+			// SPIFFS gives full paths, LittleFS the bare names.
+			String entry = Storage.entryPath(dir, path);
+			if (entry.length() > 0) {
+				return fileListItem(text, size, entry.c_str() + 1, &first);
+			}
+		}
+		if (closed) {
+			return CHUNK_END;
+		}
+		closed = true;
+		return snprintf(text, size, "]");
+	}));
+}
+
+/** @brief Write an item of the file list.
+ *  @param text char*, Item buffer.
+ *  @param size size_t, Size of the buffer.
+ *  @param name const char*, File name without the leading slash.
+ *  @param first bool*, No item was written yet, cleared.
+ *  @return size_t, Length of the item.
+ */
+size_t LocalWebServerClass::fileListItem(char* text, size_t size, const char* name, bool* first) {
+	size_t length = snprintf(text, size, "%s{\"type\":\"file\",\"name\":", (*first) ? "" : ",");
+	*first = false;
+	length += ChunkedResponse.quote(text + length, size - length, name);
+	length += snprintf(text + length, size - length, "}");
+	return length;
+}
+
+/** @brief Read file.
+ *  @param path String, File path.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return Void.
+ */
+bool LocalWebServerClass::handleFileRead(String path, AsyncWebServerRequest *request) {
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	DEBUGLOG("handleFileRead: %s\r\n", path.c_str());
+
+	if (path.endsWith("/"))
+	{
+		path += "index.htm";
+	}
+
+#ifdef WEB_ASSETS_EMBEDDED
+
+	// No file system lookups for the UI.
+	const WebAsset_t* asset = WebAssets.find(path);
+	if (asset != NULL) {
+		sendAsset(asset, request);
+		return true;
+	}
+
+#endif // WEB_ASSETS_EMBEDDED
+
+	String contentType = getContentType(path, request);
+	bool found = false;
+	if (FileIndex.covers(path)) {
+		// The index knows the gzipped variant, no exists() calls.
+		const FileIndexEntry_t* file = FileIndex.resolve(path);
+		if (file != NULL) {
+			path = file->Path;
+			found = true;
+		}
+	}
+	else {
+		String pathWithGz = path + ".gz";
+		if (_fileSystem->exists(pathWithGz)) {
+			path = pathWithGz;
+			found = true;
+		}
+		else {
+			found = _fileSystem->exists(path);
+		}
+	}
+
+	if (found) {
+		DEBUGLOG("Content type: %s\r\n", contentType.c_str());
+
+		// The browser copy is still good, nothing to send.
+		const char* tag = assetTag(path);
+		if (sendNotModified(tag, request)) {
+			DEBUGLOG("File %s not modified\r\n", path.c_str());
+			return true;
+		}
+
+		AsyncWebServerResponse *response = request->beginResponse(*_fileSystem, path, contentType);
+
+		// Add header.
+		addCacheHeaders(response, tag, path.endsWith(".gz"), request);
+		//File file = SPIFFS.open(path, "r");
+		DEBUGLOG("File %s exist\r\n", path.c_str());
+		request->send(response);
+		DEBUGLOG("File %s Sent\r\n", path.c_str());
+
+		return true;
+	}
+	else
+	{
+		DEBUGLOG("Cannot find %s\r\n", path.c_str());
+	}
+	return false;
+}
+
+/** @brief Send a file of the embedded web UI.
+ *  @param asset const WebAsset_t*, The file.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::sendAsset(const WebAsset_t* asset, AsyncWebServerRequest *request) {
+	if (sendNotModified(asset->ETag, request)) {
+		return;
+	}
+
+	AsyncWebServerResponse *response = request->beginResponse_P(200, asset->Mime, asset->Data, asset->Length);
+	addCacheHeaders(response, asset->ETag, true, request);
+	request->send(response);
+}
+
+/** @brief Reply 304 when the browser has the file.
+ *  @param tag const char*, ETag of the file, may be NULL.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return bool, True when the reply was sent.
+ */
+bool LocalWebServerClass::sendNotModified(const char* tag, AsyncWebServerRequest *request) {
+	if (tag == NULL || !request->hasHeader("If-None-Match") || request->header("If-None-Match") != tag) {
+		return false;
+	}
+
+	AsyncWebServerResponse *response = request->beginResponse(304);
+	response->addHeader("ETag", tag);
+	request->send(response);
+
+	return true;
+}
+
+/** @brief Add the cache headers of a static file.
+ *  @param response AsyncWebServerResponse, Response object.
+ *  @param tag const char*, ETag of the file, NULL for no caching.
+ *  @param gzip bool, The content is gzipped.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::addCacheHeaders(AsyncWebServerResponse *response, const char* tag, bool gzip, AsyncWebServerRequest *request) {
+	if (tag == NULL) {
 		response->addHeader("Cache-Control", "no-cache, no-store, must-revalidate");
 		response->addHeader("Pragma", "no-cache");
 		response->addHeader("Expires", "0");
+	}
+	else {
+		response->addHeader("ETag", tag);
+		// Versioned links change with the content, the rest is checked on every load.
+		if (request->hasArg("v") && gzip) {
+			response->addHeader("Cache-Control", "public, max-age=" + String(ASSET_MAX_AGE) + ", immutable");
+		}
+		else {
+			response->addHeader("Cache-Control", "no-cache");
+		}
+	}
+
+	if (gzip) {
+		response->addHeader("Content-Encoding", "gzip");
+	}
+}
+
+/** @brief Get the ETag of a static file, hashed on the first request.
+ *  @param path String, File path.
+ *  @return const char*, Quoted ETag or NULL for files that are not cached.
+ */
+const char* LocalWebServerClass::assetTag(const String& path) {
+	// Data files like config.json change behind the web server.
+	if (path.endsWith(".json") || path.endsWith(".txt")) {
+		return NULL;
+	}
+
+	return FileIndex.tag(path);
+}
+
+/** @brief Check that a file exists, from the file index when it covers the path.
+ *  @param path String, File path.
+ *  @return bool, True when the file exists.
+ */
+bool LocalWebServerClass::fileExists(const String& path) {
+	if (FileIndex.covers(path)) {
+		return FileIndex.find(path) != NULL;
+	}
+
+	return _fileSystem->exists(path);
+}
+
+/** @brief Create file.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::handleFileCreate(AsyncWebServerRequest *request) {
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (!checkAuth(request))
+		return request->requestAuthentication();
+	if (request->args() == 0)
+		return request->send(500, "text/plain", "BAD ARGS");
+	String path = request->arg(0U);
+	DEBUGLOG("handleFileCreate: %s\r\n", path.c_str());
+	if (path == "/")
+		return request->send(500, "text/plain", "BAD PATH");
+	if (fileExists(path))
+		return request->send(500, "text/plain", "FILE EXISTS");
+	File file = _fileSystem->open(path, "w");
+	if (file) {
+		file.close();
+		FileIndex.update(path, 0);
+	}
+	else
+		return request->send(500, "text/plain", "CREATE FAILED");
+	request->send(200, "text/plain", "");
+	path = String(); // Remove? Useless statement?
+}
+
+/** @brief Delete file.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::handleFileDelete(AsyncWebServerRequest *request) {
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (!checkAuth(request))
+		return request->requestAuthentication();
+	if (request->args() == 0) return request->send(500, "text/plain", "BAD ARGS");
+	String path = request->arg(0U);
+	DEBUGLOG("handleFileDelete: %s\r\n", path.c_str());
+	if (path == "/")
+		return request->send(500, "text/plain", "BAD PATH");
+	if (!fileExists(path))
+		return request->send(404, "text/plain", "FileNotFound");
+	_fileSystem->remove(path);
+	FileIndex.remove(path);
+	request->send(200, "text/plain", "");
+	path = String(); // Remove? Useless statement?
+}
+
+/** @brief Upload file.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @param filename String, Name of the file.
+ *  @param index size_t,
+ *  @param data uint8, Content of the file.
+ *  @param len size_t, Length of the file.
+ *  @param final boolean, Flag for closing multipart file operation.
+ *  @return Void.
+ */
+void LocalWebServerClass::handleFileUpload(
+	AsyncWebServerRequest *request,
+	String filename,
+	size_t index,
+	uint8 *data,
+	size_t len,
+	bool final) {
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	// Parts of other requests go to their own contexts.
+	if (!index && !checkAuth(request)) {
+		return;
+	}
+
+	UploadContext_t* context = uploadContext(request, !index);
+	if (context == NULL) {
+		return;
+	}
+
+	if (!index) { // Start
+		DEBUGLOG("Handle file upload name: %s\r\n", filename.c_str());
+		if (!filename.startsWith("/")) filename = "/" + filename;
+		strncpy(context->Path, filename.c_str(), IMAGE_NAME_SIZE - 1);
+		context->Path[IMAGE_NAME_SIZE - 1] = '\0';
+		// The old content is gone with the first write.
+		FileIndex.remove(filename);
+		context->Size = 0;
+		context->Failed = (filename.length() >= IMAGE_NAME_SIZE);
+		// Old images give way to the editor files too.
+		if (!context->Failed && ImageStore.makeRoom(request->contentLength())) {
+			context->Upload.begin(_fileSystem->open(context->Path, "w"));
+		}
+		else {
+			DEBUGLOG("No room for the upload.\r\n");
+		}
+		context->Failed = !context->Upload;
+		DEBUGLOG("First upload part.\r\n");
+
+	}
+	// Continue
+	if (context->Upload) {
+		DEBUGLOG("Continue upload part. Size = %u\r\n", len);
+		if (context->Upload.write(data, len) != len) {
+			DEBUGLOG("Write error during upload.\r\n");
+			// A partial file is worse than none.
+			context->Upload.discard();
+			_fileSystem->remove(context->Path);
+			context->Failed = true;
+		}
+		else
+			context->Size += len;
+	}
+	if (final) { // End
+		if (context->Upload) {
+			DEBUGLOG("Chunks: %u, file writes: %u\r\n", context->Upload.chunks(), context->Upload.writes());
+			// The last block is written here.
+			if (!context->Upload.close()) {
+				_fileSystem->remove(context->Path);
+				context->Failed = true;
+			}
+			else {
+				FileIndex.update(context->Path, context->Size);
+			}
+		}
+		DEBUGLOG("Handle file upload size: %u\r\n", context->Size);
+	}
+}
+
+/** @brief Reply the result of an upload and release its context.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::sendUploadResult(AsyncWebServerRequest *request) {
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	UploadContext_t* context = uploadContext(request, false);
+	if (context == NULL) {
+		request->send(503, "text/plain", "Too many uploads");
+		return;
+	}
+
+	request->send(context->Failed ? 500 : 200, "text/plain", context->Failed ? "Upload failed" : "");
+	releaseUpload(request);
+}
+
+/** @brief Find or take the upload context of a request.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @param create bool, Take a free context when the request has none.
+ *  @return UploadContext_t*, The context or NULL.
+ */
+UploadContext_t* LocalWebServerClass::uploadContext(AsyncWebServerRequest *request, bool create) {
+	UploadContext_t* freeContext = NULL;
+
+	for (uint8 index = 0; index < UPLOAD_CONTEXTS; index++) {
+		if (_uploads[index].Request == request) {
+			return &_uploads[index];
+		}
+		if (freeContext == NULL && _uploads[index].Request == NULL) {
+			freeContext = &_uploads[index];
+		}
+	}
+
+	if (!create) {
+		return NULL;
+	}
+
+	if (freeContext == NULL) {
+		DEBUGLOG("Too many uploads.\r\n");
+		return NULL;
+	}
+
+	freeContext->Request = request;
+	freeContext->Path[0] = '\0';
+	freeContext->Size = 0;
+	freeContext->Failed = false;
+
+	return freeContext;
+}
+
+/** @brief Release the upload context of a request, a cut upload is removed.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::releaseUpload(AsyncWebServerRequest *request) {
+	UploadContext_t* context = uploadContext(request, false);
+	if (context == NULL) {
+		return;
+	}
+
+	if (context->Upload) {
+		DEBUGLOG("Upload cut: %s\r\n", context->Path);
+		context->Upload.discard();
+		_fileSystem->remove(context->Path);
+	}
+
+	context->Request = NULL;
+}
+
+#pragma endregion
+
+#ifdef ENABLE_OTA_ARDUINO
+
+/** @brief Configure OTA.
+ *  @param password String, Password for flashing.
+ *  @return Void.
+ */
+void LocalWebServerClass::configureOTA(String password) {
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	// Port defaults to 8266
+	// ArduinoOTA.setPort(8266);
+
+	// Host name defaults to esp8266-[ChipID]
+	ArduinoOTA.setHostname(DeviceConfiguration.DeviceName.c_str());
+
+	// No authentication by default
+	if (password != "") {
+		ArduinoOTA.setPassword(password.c_str());
+		DEBUGLOG("OTA password set %s\r\n", password.c_str());
+	}
+
+	ArduinoOTA.onStart([]() {
+		DEBUGLOG("StartOTA\r\n");
+	});
+	ArduinoOTA.onEnd(std::bind([](FS *fs) {
+		fs->end();
+		DEBUGLOG("End OTA\r\n");
+	}, _fileSystem));
+	ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
+		DEBUGLOG("OTA Progress: %u%%\r\n", (progress / (total / 100)));
+	});
+	ArduinoOTA.onError([](ota_error_t error) {
+		DEBUGLOG("Error[%u]: ", error);
+		if (error == OTA_AUTH_ERROR) DEBUGLOG("Authentication Failed\r\n");
+		else if (error == OTA_BEGIN_ERROR) DEBUGLOG("Begin Failed\r\n");
+		else if (error == OTA_CONNECT_ERROR) DEBUGLOG("Connect Failed\r\n");
+		else if (error == OTA_RECEIVE_ERROR) DEBUGLOG("Receive Failed\r\n");
+		else if (error == OTA_END_ERROR) DEBUGLOG("End Failed\r\n");
+	});
+	DEBUGLOG("OTA Ready\r\n");
+
+	ArduinoOTA.begin();
+}
+
+#endif // ENABLE_OTA_ARDUINO
+
+#pragma region ENABLE_WEB_OTA
+
+#ifdef ENABLE_WEB_OTA
+
+/** @brief Set MD5 sum of the new firmware. Part of the API.
+ *  @param request, AsyncWebServer Request request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::setUpdateMD5(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_browserMD5 = "";
+
+	DEBUGLOG("Arg number: %d\r\n", request->args());
+	if (request->args() > 0)  // Read hash
+	{
+		for (uint8 index = 0; index < request->args(); index++) {
+			DEBUGLOG("Arg %s: %s\r\n", request->argName(index).c_str(), request->arg(index).c_str());
+			if (request->argName(index) == "md5") {
+				_browserMD5 = urlDecode(request->arg(index));
+				Update.setMD5(_browserMD5.c_str());
+				continue;
+			}if (request->argName(index) == "size") {
+				_updateSize = request->arg(index).toInt();
+				DEBUGLOG("Update size: %l\r\n", _updateSize);
+				continue;
+			}
+		}
+		request->send(200, "text/html", "OK --> MD5: " + _browserMD5);
+	}
+}
+
+/** @brief Save authentication data.
+*  @param request, AsyncWebServerRequest request object.
+*  @param filename String Name of the file.
+*  @param index size_t Part index.
+*  @param data uint8 Data content.
+*  @param len size_t Size of the content.
+*  @param final boolean Last part to close file.
+*  @return boolean, Return true if successful.
+*/
+void LocalWebServerClass::updateFirmware(
+	AsyncWebServerRequest *request,
+	String filename,
+	size_t index,
+	uint8 *data,
+	size_t len,
+	bool final)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	// handler for the file upload, get's the sketch bytes, and writes
+	// them through the Update object
+	if (!index) { //UPLOAD_FILE_START
+		// There is one Update object, a second upload is refused.
+		if (_updateRequest != NULL || !checkAuth(request)) {
+			DEBUGLOG("Update refused.\r\n");
+			return;
+		}
+		_updateRequest = request;
+		_updateReceived = 0;
+		_fileSystem->end();
+		Update.runAsync(true);
+		DEBUGLOG("Update start: %s\r\n", filename.c_str());
+		uint32_t maxSketchSpace = ESP.getSketchSize();
+		DEBUGLOG("Max free sketch space: %u\r\n", maxSketchSpace);
+		DEBUGLOG("New sketch size: %u\r\n", _updateSize);
+		if (_browserMD5 != NULL && _browserMD5 != "") {
+			Update.setMD5(_browserMD5.c_str());
+			DEBUGLOG("Hash from client: %s\r\n", _browserMD5.c_str());
+		}
+		if (!Update.begin(_updateSize)) {//start with max available size
+			Update.printError(DEBUG_PORT);
+		}
+
+	}
+
+	if (request != _updateRequest) {
+		return;
+	}
+
+	// Get upload file, continue if not start
+	_updateReceived += len;
+	DEBUGLOG(".");
+	size_t written = Update.write(data, len);
+	if (written != len) {
+		DEBUGLOG("len = %d, written = %u, totalSize = %u\r\n", len, written, _updateReceived);
+		Update.printError(DEBUG_PORT);
+		//return;
+	}
+	if (final) {  // UPLOAD_FILE_END
+		String updateHash;
+		DEBUGLOG("Applying update...\r\n");
+		if (Update.end(true)) { //true to set the size to the current progress
+			updateHash = Update.md5String();
+			DEBUGLOG("Upload finished. Calculated MD5: %s\r\n", updateHash.c_str());
+			DEBUGLOG("Update Success: %u\nRebooting...\r\n", request->contentLength());
+		}
+		else {
+			updateHash = Update.md5String();
+			DEBUGLOG("Upload failed. Calculated MD5: %s\r\n", updateHash.c_str());
+			Update.printError(DEBUG_PORT);
+		}
+	}
+}
+
+/** @brief Drop the firmware update of a request that went away.
+*  @param request, AsyncWebServerRequest request object.
+*  @return Void.
+*/
+void LocalWebServerClass::abortUpdate(AsyncWebServerRequest *request)
+{
+	if (request != _updateRequest) {
+		return;
+	}
+
+	DEBUGLOG("Update cut after %u bytes\r\n", _updateReceived);
+
+	// An unfinished update is reset, the old firmware stays.
+	if (Update.isRunning()) {
+		Update.end(false);
+	}
+	_fileSystem->begin();
+
+	_updateRequest = NULL;
+	_updateReceived = 0;
+}
+
+/** @brief Send firmware update values. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::sendUpdateFWValues(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	String values = "";
+	uint32_t maxSketchSpace = (ESP.getSketchSize() - 0x1000) & 0xFFFFF000;
+	//bool updateOK = Update.begin(maxSketchSpace);
+	bool updateOK = maxSketchSpace < ESP.getFreeSketchSpace();
+	StreamString result;
+	Update.printError(result);
+	DEBUGLOG("--MaxSketchSpace: %d\n", maxSketchSpace);
+	DEBUGLOG("--Update error = %s\n", result.c_str());
+	values += "remupd|" + (String)((updateOK) ? "OK" : "ERROR") + "|div\n";
+
+	if (Update.hasError()) {
+		result.trim();
+		values += "remupdResult|" + result + "|div\n";
+	}
+	else {
+		values += "remupdResult||div\n";
+	}
+
+	request->send(200, "text/plain", values);
+}
+
+#endif // ENABLE_OTA_HTT
+
+#pragma endregion
+
+#pragma region API Handlers
+
+/** @brief Send list of networks. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::sendNetworks(AsyncWebServerRequest *request)
+{
+	// The kept networks are sent, a stale list asks for a scan in the background.
+	NetworkScan.request();
+
+	uint8 n = NetworkScan.count();
+	if (n == 0)
+	{
+		request->send(200, "text/json", "[]");
+		return;
+	}
+
+	// A network per item.
+	bool first = true;
+	request->send(ChunkedResponse.begin(request, "text/json", [n, first](uint16 item, char* text, size_t size) mutable -> size_t
+	{
+		if (item == 0)
+		{
+			return snprintf(text, size, "[");
+		}
+
+		int index = item - 1;
+		if (index < n)
+		{
+			// A scan may end meanwhile with fewer networks.
+			const ScanNetwork_t* network = NetworkScan.network(index);
+			if (network == NULL)
+			{
+				return 0;
+			}
+
+			size_t length = snprintf(text, size, "%s{\"rssi\":%d,\"ssid\":", (first) ? "" : ",", network->RSSI);
+			first = false;
+			length += ChunkedResponse.quote(text + length, size - length, network->SSID);
+			length += snprintf(text + length, size - length,
+				",\"bssid\":\"%02X:%02X:%02X:%02X:%02X:%02X\",\"channel\":%d,\"secure\":%d,\"hidden\":%s}",
+				network->BSSID[0], network->BSSID[1], network->BSSID[2], network->BSSID[3], network->BSSID[4], network->BSSID[5],
+				network->Channel, network->Encryption, network->Hidden ? "true" : "false");
+			return length;
+		}
+
+		if (index == n)
+		{
+			return snprintf(text, size, "]");
+		}
+
+		return CHUNK_END;
+	}));
+}
+
+/** @brief Ask for a new WiFi scan and send the scan state. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::refreshNetworks(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	NetworkScan.refresh();
+
+	// The scan starts from the main loop, the list is read later from scanNetworks.
+	char OutputL[112];
+	snprintf(OutputL, sizeof(OutputL), "{\"scanning\":%s,\"pending\":%s,\"suppressed\":%s,\"count\":%u,\"age\":%ld}",
+		NetworkScan.isScanning() ? "true" : "false",
+		NetworkScan.isPending() ? "true" : "false",
+		NetworkScan.isSuppressed() ? "true" : "false",
+		NetworkScan.count(),
+		NetworkScan.age());
+	request->send(202, "application/json", OutputL);
+}
+
+/** @brief Send connection state. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::sendConnectionState(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	const char* state = wifiStateName(WiFi.status());
+
+	// Polling the state scans once per SCAN_CACHE_TTL at most.
+	NetworkScan.request();
+
+	char values[48];
+	snprintf(values, sizeof(values), "ConnectionState|%s|div\n", state);
+	//values += "networks|Scanning networks ...|div\n";
+	request->send(200, "text/plain", values);
+}
+
+/** @brief Send device configuration. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::sendConfiguration(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	// A line per item, read from the configuration as they are sent.
+	request->send(ChunkedResponse.begin(request, "text/plain", [](uint16 item, char* text, size_t size) -> size_t
+	{
+		switch (item)
+		{
+		case 0: return snprintf(text, size, "FWVersion|%d|div\n", FW_VERSION);
+		case 1: return snprintf(text, size, "DeviceName|%s|input\n", DeviceConfiguration.DeviceName.c_str());
+		case 2: return snprintf(text, size, "STASSID|%s|input\n", DeviceConfiguration.STASSID.c_str());
+		case 3: return snprintf(text, size, "HTTPUsername|%s|input\n", DeviceConfiguration.HTTPUsername.c_str());
+		case 4: return snprintf(text, size, "HTTPAuthentication|%d|input\n", DeviceConfiguration.HTTPAuthentication);
+
+#ifdef ENABLE_CAYENNE_MODE
+
+		case 5: return snprintf(text, size, "CayenneUsername|%s|input\n", DeviceConfiguration.CayenneUsername.c_str());
+
+#endif // ENABLE_CAYENNE_MODE
+
+		default: return CHUNK_END;
+		}
+	}));
+}
+
+/** @brief Settings arguments parser. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::saveConfiguration(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (!checkAuth(request))
+		return request->requestAuthentication();
+
+	if (request->args() > 0)  // Save Settings
+	{
+		bool CredentialsChangedL = false;
+
+		for (uint8 index = 0; index < request->args(); index++)
+		{
+			DEBUGLOG("Arg %s: %s\r\n", request->argName(index).c_str(), urlDecode(request->arg(index)).c_str());
+
+#pragma region Device Name
+
+			if (request->argName(index) == "DeviceName") {
+				DeviceConfiguration.DeviceName = urlDecode(request->arg(index));
+				DEBUGLOG("STASSID: %s\r\n", DeviceConfiguration.DeviceName.c_str());
+
+				continue;
+			}
+
+#pragma endregion
+
+#pragma region STA
+
+			if (request->argName(index) == "STASSID")
+			{
+				DeviceConfiguration.STASSID = urlDecode(request->arg(index));
+				DEBUGLOG("STASSID: %s\r\n", DeviceConfiguration.STASSID.c_str());
+				continue;
+			}
+
+			if (request->argName(index) == "STAPassword")
+			{
+				String pswd = urlDecode(request->arg(index));
+				if (pswd != "")
+				{
+					DeviceConfiguration.STAPassword = pswd;
+					DEBUGLOG("STAPassword: %s\r\n", DeviceConfiguration.STAPassword.c_str());
+				}
+				continue;
+			}
+
+#pragma endregion
+
+#pragma region AP
+
+			if (request->argName(index) == "APPassword") {
+				String pswd = urlDecode(request->arg(index));
+				if (pswd != "")
+				{
+					DeviceConfiguration.APPassword = pswd;
+					DEBUGLOG("APPassword: %s\r\n", DeviceConfiguration.APPassword.c_str());
+				}
+				continue;
+			}
+
+#pragma endregion
+
+#pragma region HTTP Authentication
+
+			if (request->argName(index) == "HTTPUsername") {
+				CredentialsChangedL |= (DeviceConfiguration.HTTPUsername != urlDecode(request->arg(index)));
+				DeviceConfiguration.HTTPUsername = urlDecode(request->arg(index));
+				DEBUGLOG("HTTPUsername: %s\r\n", DeviceConfiguration.HTTPUsername.c_str());
+				continue;
+			}
+
+			if (request->argName(index) == "HTTPPassword") {
+				String pswd = urlDecode(request->arg(index));
+				if (pswd != "")
+				{
+					CredentialsChangedL |= (DeviceConfiguration.HTTPPassword != pswd);
+					DeviceConfiguration.HTTPPassword = pswd;
+					DEBUGLOG("HTTPPassword: %s\r\n", DeviceConfiguration.HTTPPassword.c_str());
+				}
+				continue;
+			}
+
+			if (request->argName(index) == "HTTPAuthentication") {
+				DeviceConfiguration.HTTPAuthentication = true;
+				DEBUGLOG("HTTPAuthentication: %d\r\n", DeviceConfiguration.HTTPAuthentication);
+				continue;
+			}
+
+#pragma endregion
+
+		}
+
+		// Save device configuration.
+		save_device_configuration(_fileSystem);
+
+		// Sessions of the old credentials end.
+		if (CredentialsChangedL)
+		{
+			AuthSessions.rotate();
+		}
+
+	}
+
+	if (!this->handleFileRead("/configuration.html", request))
+	{
+		request->send(404, "text/plain", "FileNotFound");
+		return;
+	}
+}
+
+/** @brief Queue a flash, verify or read job. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::addJob(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	String TypeL = request->arg("type");
+	String PathL = urlDecode(request->arg("file"));
+	uint32 SizeL = request->arg("size").toInt();
+	uint8 JobTypeL = 0;
+
+	if (TypeL == "flash") JobTypeL = JobTypes::JobFlash;
+	else if (TypeL == "verify") JobTypeL = JobTypes::JobVerify;
+	else if (TypeL == "read") JobTypeL = JobTypes::JobRead;
+
+	uint16 IdL = 0;
+	uint8 StateL = FlashJobs.enqueue(JobTypeL, PathL.c_str(), SizeL, &IdL);
+
+	if (StateL == StatusCodes::Busy)
+	{
+		request->send(503, "application/json", "{\"error\":\"Queue full\"}");
+		return;
+	}
+
+	if (StateL != StatusCodes::Ok)
+	{
+		// Images found unfit at the upload are refused with the reason.
+		const char* ErrorL = NULL;
+		ImageStore.precheck(PathL.c_str(), &ErrorL);
+		request->send(400, "application/json", "{\"error\":\"" + String((ErrorL != NULL) ? ErrorL : "Bad job") + "\"}");
+		return;
+	}
+
+	request->send(202, "application/json", "{\"id\":" + String(IdL) + "}");
+}
+
+/** @brief Send the state of one or all jobs. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::sendJob(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	const char* RootL = "/api/v1/jobs/";
+	uint16 IdL = 0;
+
+	if (request->url().startsWith(RootL))
+	{
+		IdL = request->url().substring(strlen(RootL)).toInt();
+		if (FlashJobs.find(IdL) == NULL)
+		{
+			request->send(404, "application/json", "{\"error\":\"Job not found\"}");
+			return;
+		}
+	}
+
+	// A job per two items, copied so a reused slot does not mix two jobs.
+	FlashJob_t JobL;
+	memset(&JobL, 0, sizeof(JobL));
+	uint8 SlotL = 0;
+	uint8 PartL = 0;
+	bool FirstL = true;
+	bool ClosedL = false;
+	request->send(ChunkedResponse.begin(request, "application/json", [IdL, JobL, SlotL, PartL, FirstL, ClosedL](uint16 item, char* text, size_t size) mutable -> size_t
+	{
+		if (item == 0 && IdL == 0)
+		{
+			return snprintf(text, size, "[");
+		}
+
+		if (PartL == 0)
+		{
+			const FlashJob_t* NextL = NULL;
+			if (IdL != 0)
+			{
+				NextL = (SlotL++ == 0) ? FlashJobs.find(IdL) : NULL;
+			}
+			else
+			{
+				while (SlotL < FLASH_JOB_SLOTS && NextL == NULL)
+				{
+					NextL = FlashJobs.slot(SlotL++);
+				}
+			}
+
+			if (NextL == NULL)
+			{
+				if (IdL != 0 || ClosedL)
+				{
+					return CHUNK_END;
+				}
+				ClosedL = true;
+				return snprintf(text, size, "]");
+			}
+
+			JobL = *NextL;
+		}
+
+		size_t LengthL = jobItem(text, size, &JobL, PartL, &FirstL);
+		PartL = (PartL + 1) % 2;
+		return LengthL;
+	}));
+}
+
+/** @brief Send the manifest of the stored images. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::sendImages(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	// An image per three items, copied so a removal in between does not mix two entries.
+	ImageEntry_t ImageL;
+	memset(&ImageL, 0, sizeof(ImageL));
+	uint8 SlotL = 0;
+	uint8 PartL = 0;
+	bool FirstL = true;
+	bool ClosedL = false;
+	request->send(ChunkedResponse.begin(request, "application/json", [ImageL, SlotL, PartL, FirstL, ClosedL](uint16 item, char* text, size_t size) mutable -> size_t
+	{
+		if (item == 0)
+		{
+			return snprintf(text, size, "[");
+		}
+
+		if (PartL == 0)
+		{
+			const ImageEntry_t* NextL = NULL;
+			while (SlotL < IMAGE_STORE_ENTRIES && NextL == NULL)
+			{
+				NextL = ImageStore.entry(SlotL++);
+			}
+
+			if (NextL == NULL)
+			{
+				if (ClosedL)
+				{
+					return CHUNK_END;
+				}
+				ClosedL = true;
+				return snprintf(text, size, "]");
+			}
+
+			ImageL = *NextL;
+		}
+
+		size_t LengthL = imageItem(text, size, &ImageL, PartL, &FirstL);
+		PartL = (PartL + 1) % 3;
+		return LengthL;
+	}));
+}
+
+/** @brief Write a part of an image of the manifest.
+ *  @param text char*, Item buffer.
+ *  @param size size_t, Size of the buffer.
+ *  @param image const ImageEntry_t*, The image.
+ *  @param part uint8, 0 for the names, 1 for the sizes and times, 2 for the properties.
+ *  @param first bool*, No image was written yet, cleared.
+ *  @return size_t, Length of the item.
+ */
+size_t LocalWebServerClass::imageItem(char* text, size_t size, const ImageEntry_t* image, uint8 part, bool* first)
+{
+	char HashL[IMAGE_HASH_SIZE * 2 + 1];
+	size_t LengthL = 0;
+
+	if (part == 0)
+	{
+		ImageStoreClass::hashToHex(image->Hash, HashL);
+
+		LengthL = snprintf(text, size, "%s{\"name\":", (*first) ? "" : ",");
+		*first = false;
+		LengthL += ChunkedResponse.quote(text + LengthL, size - LengthL, image->Name);
+		LengthL += snprintf(text + LengthL, size - LengthL, ",\"hash\":\"%s\",\"mcu\":", HashL);
+		LengthL += ChunkedResponse.quote(text + LengthL, size - LengthL, image->Mcu);
+		return LengthL;
+	}
+
+	if (part == 1)
+	{
+		return snprintf(text, size, ",\"size\":%u,\"pages\":%u,\"uploaded\":%u,\"stored\":%u,\"flashed\":%u,\"pinned\":%s",
+			image->Size, image->Pages, image->UploadedAt, image->StoredSize, image->FlashedAt, (image->Pinned != 0) ? "true" : "false");
+	}
+
+	// Properties found at the upload, left out for images stored before.
+	if (image->Info.RecordTypes != 0)
+	{
+		LengthL = snprintf(text, size,
+			",\"crc32\":\"%08X\",\"minAddress\":%u,\"maxAddress\":%u,\"usedBytes\":%u,\"usedPages\":%u,\"recordTypes\":%u,\"flashTime\":%u",
+			image->Info.Crc32, image->Info.MinAddress, image->Info.MaxAddress, image->Info.UsedBytes,
+			image->Info.UsedPages, image->Info.RecordTypes, image->Info.FlashTime);
+	}
+
+	LengthL += snprintf(text + LengthL, size - LengthL, "}");
+	return LengthL;
+}
+
+/** @brief Create a resumable upload session. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::createUpload(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (!request->hasArg("name") || !request->hasArg("size"))
+	{
+		request->send(400, "application/json", "{\"error\":\"Bad arguments\"}");
+		return;
+	}
+
+	// Stored under the same name as by the other upload paths, a long name is refused by create().
+	String NameL = String(STREAM_FLASH_STORE_DIR) + "/" + request->arg("name");
+
+	uint16 IdL = 0;
+	uint8 StateL = UploadSessions.create(NameL.c_str(), request->arg("mcu").c_str(),
+		request->arg("size").toInt(), &IdL);
+
+	if (StateL == StatusCodes::Busy)
+	{
+		request->send(503, "application/json", "{\"error\":\"No room\"}");
+		return;
+	}
+
+	if (StateL != StatusCodes::Ok)
+	{
+		request->send(400, "application/json", "{\"error\":\"Bad arguments\"}");
+		return;
+	}
+
+	String OutputL;
+	DynamicJsonBuffer jsonBuffer(256);
+	JsonObject& json = jsonBuffer.createObject();
+	uploadToJson(UploadSessions.find(IdL), json);
+	json.printTo(OutputL);
+
+	request->send(200, "application/json", OutputL);
+}
+
+/** @brief Send the received ranges of one or all upload sessions. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::sendUploads(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	uint16 IdL = 0;
+
+	if (request->hasArg("id"))
+	{
+		IdL = request->arg("id").toInt();
+		if (UploadSessions.find(IdL) == NULL)
+		{
+			request->send(404, "application/json", "{\"error\":\"Upload not found\"}");
+			return;
+		}
+	}
+
+	// The state of a session in one item, then a received range per item.
+	UploadSession_t SessionL;
+	memset(&SessionL, 0, sizeof(SessionL));
+	uint8 SlotL = 0;
+	uint16 ChunkL = 0;
+	bool InSessionL = false;
+	bool FirstL = true;
+	bool FirstRangeL = true;
+	bool ClosedL = false;
+	request->send(ChunkedResponse.begin(request, "application/json",
+		[IdL, SessionL, SlotL, ChunkL, InSessionL, FirstL, FirstRangeL, ClosedL](uint16 item, char* text, size_t size) mutable -> size_t
+	{
+		if (item == 0 && IdL == 0)
+		{
+			return snprintf(text, size, "[");
+		}
+
+		if (InSessionL)
+		{
+			// Received byte ranges as [start, end), the client sends the gaps.
+			uint16 ChunksL = UploadSessionsClass::chunks(&SessionL);
+			while (ChunkL < ChunksL && !UploadSessionsClass::hasChunk(&SessionL, ChunkL))
+			{
+				ChunkL++;
+			}
+
+			if (ChunkL >= ChunksL)
+			{
+				InSessionL = false;
+				return snprintf(text, size, "]}");
+			}
+
+			uint16 LastL = ChunkL;
+			while (LastL + 1 < ChunksL && UploadSessionsClass::hasChunk(&SessionL, LastL + 1))
+			{
+				LastL++;
+			}
+
+			uint32 EndL = (uint32)(LastL + 1) * UPLOAD_CHUNK_SIZE;
+			size_t LengthL = snprintf(text, size, "%s[%u,%u]", FirstRangeL ? "" : ",",
+				(uint32)ChunkL * UPLOAD_CHUNK_SIZE, (EndL < SessionL.Size) ? EndL : SessionL.Size);
+			FirstRangeL = false;
+			ChunkL = LastL + 1;
+			return LengthL;
+		}
+
+		const UploadSession_t* NextL = NULL;
+		if (IdL != 0)
+		{
+			NextL = (SlotL++ == 0) ? UploadSessions.find(IdL) : NULL;
+		}
+		else
+		{
+			while (SlotL < UPLOAD_SESSIONS && NextL == NULL)
+			{
+				NextL = UploadSessions.slot(SlotL++);
+			}
+		}
+
+		if (NextL == NULL)
+		{
+			if (IdL != 0 || ClosedL)
+			{
+				return CHUNK_END;
+			}
+			ClosedL = true;
+			return snprintf(text, size, "]");
+		}
+
+		// Copied so the ranges match the state sent with them.
+		SessionL = *NextL;
+		ChunkL = 0;
+		InSessionL = true;
+		FirstRangeL = true;
+		return uploadItem(text, size, &SessionL, &FirstL);
+	}));
+}
+
+/** @brief Reply the result of a chunk of an upload session. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::sendChunkResult(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	uint8 StateL = UploadSessions.result(request);
+
+	if (StateL == StatusCodes::Busy)
+	{
+		request->send(503, "application/json", "{\"error\":\"Another chunk in progress\"}");
+		return;
+	}
+
+	const UploadSession_t* SessionL = UploadSessions.find(request->arg("id").toInt());
+	if (SessionL == NULL)
+	{
+		request->send(404, "application/json", "{\"error\":\"Upload not found\"}");
+		return;
+	}
+
+	if (StateL != StatusCodes::Ok)
+	{
+		request->send(400, "application/json", "{\"error\":\"Chunk refused\"}");
+		return;
+	}
+
+	request->send(200, "application/json", "{\"missing\":" + String(UploadSessionsClass::missing(SessionL)) + "}");
+}
+
+/** @brief Commit an upload session with its hash. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::commitUpload(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	uint16 IdL = request->arg("id").toInt();
+	if (UploadSessions.find(IdL) == NULL)
+	{
+		request->send(404, "application/json", "{\"error\":\"Upload not found\"}");
+		return;
+	}
+
+	uint8 StateL = UploadSessions.commit(IdL, request->arg("md5").c_str());
+	if (StateL == StatusCodes::Busy)
+	{
+		request->send(409, "application/json", "{\"error\":\"Chunks missing\"}");
+		return;
+	}
+
+	if (StateL != StatusCodes::Ok)
+	{
+		request->send(400, "application/json", "{\"error\":\"Bad arguments\"}");
+		return;
+	}
+
+	// The hash check runs from the main loop, the state tells the end.
+	request->send(202, "application/json", "{\"id\":" + String(IdL) + ",\"state\":\"committing\"}");
+}
+
+/** @brief Drop an upload session. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::deleteUpload(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	uint8 StateL = UploadSessions.remove(request->arg("id").toInt());
+	if (StateL == StatusCodes::Busy)
+	{
+		request->send(409, "application/json", "{\"error\":\"Upload is committing\"}");
+		return;
+	}
+
+	if (StateL != StatusCodes::Ok)
+	{
+		request->send(404, "application/json", "{\"error\":\"Upload not found\"}");
+		return;
+	}
+
+	request->send(200, "application/json", "{}");
+}
+
+/** @brief Fill JSON object with the state of an upload session.
+ *  @param session const UploadSession_t*, The session.
+ *  @param json JsonObject, Destination object.
+ *  @return Void.
+ */
+void LocalWebServerClass::uploadToJson(const UploadSession_t* session, JsonObject& json)
+{
+	json["id"] = session->Id;
+	json["name"] = session->Name;
+	json["mcu"] = session->Mcu;
+	json["size"] = session->Size;
+	json["state"] = UploadSessionsClass::stateName(session->State);
+	json["chunkSize"] = UPLOAD_CHUNK_SIZE;
+	json["missing"] = UploadSessionsClass::missing(session);
+	json["error"] = (session->Error != NULL) ? session->Error : "";
+
+	// Received byte ranges as [start, end), the client sends the gaps.
+	JsonArray& received = json.createNestedArray("received");
+	uint16 ChunksL = UploadSessionsClass::chunks(session);
+	for (uint16 chunk = 0; chunk < ChunksL; chunk++)
+	{
+		if (!UploadSessionsClass::hasChunk(session, chunk))
+		{
+			continue;
+		}
 
-		if (path.endsWith(".gz"))
+		uint16 LastL = chunk;
+		while (LastL + 1 < ChunksL && UploadSessionsClass::hasChunk(session, LastL + 1))
 		{
-			response->addHeader("Content-Encoding", "gzip");
+			LastL++;
 		}
-		//File file = SPIFFS.open(path, "r");
-		DEBUGLOG("File %s exist\r\n", path.c_str());
-		request->send(response);
-		DEBUGLOG("File %s Sent\r\n", path.c_str());
 
-		return true;
-	}
-	else
-	{
-		DEBUGLOG("Cannot find %s\r\n", path.c_str());
+		uint32 EndL = (uint32)(LastL + 1) * UPLOAD_CHUNK_SIZE;
+		JsonArray& range = received.createNestedArray();
+		range.add((uint32)chunk * UPLOAD_CHUNK_SIZE);
+		range.add((EndL < session->Size) ? EndL : session->Size);
+
+		chunk = LastL;
 	}
-	return false;
 }
 
-/** @brief Create file.
- *  @param request AsyncWebServerRequest, Request object.
- *  @return Void.
+/** @brief Write the state of an upload session up to its received ranges.
+ *  @param text char*, Item buffer.
+ *  @param size size_t, Size of the buffer.
+ *  @param session const UploadSession_t*, The session.
+ *  @param first bool*, No session was written yet, cleared.
+ *  @return size_t, Length of the item.
  */
-void LocalWebServerClass::handleFileCreate(AsyncWebServerRequest *request) {
-	DEBUGLOG("\r\n");
-	DEBUGLOG(__PRETTY_FUNCTION__);
-	DEBUGLOG("\r\n");
-
-	if (!checkAuth(request))
-		return request->requestAuthentication();
-	if (request->args() == 0)
-		return request->send(500, "text/plain", "BAD ARGS");
-	String path = request->arg(0U);
-	DEBUGLOG("handleFileCreate: %s\r\n", path.c_str());
-	if (path == "/")
-		return request->send(500, "text/plain", "BAD PATH");
-	if (_fileSystem->exists(path))
-		return request->send(500, "text/plain", "FILE EXISTS");
-	File file = _fileSystem->open(path, "w");
-	if (file)
-		file.close();
-	else
-		return request->send(500, "text/plain", "CREATE FAILED");
-	request->send(200, "text/plain", "");
-	path = String(); // Remove? Useless statement?
+size_t LocalWebServerClass::uploadItem(char* text, size_t size, const UploadSession_t* session, bool* first)
+{
+	size_t LengthL = snprintf(text, size, "%s{\"id\":%u,\"name\":", (*first) ? "" : ",", session->Id);
+	*first = false;
+	LengthL += ChunkedResponse.quote(text + LengthL, size - LengthL, session->Name);
+	LengthL += snprintf(text + LengthL, size - LengthL, ",\"mcu\":");
+	LengthL += ChunkedResponse.quote(text + LengthL, size - LengthL, session->Mcu);
+	LengthL += snprintf(text + LengthL, size - LengthL, ",\"size\":%u,\"state\":\"%s\",\"chunkSize\":%u,\"missing\":%u,\"error\":",
+		session->Size, UploadSessionsClass::stateName(session->State), UPLOAD_CHUNK_SIZE, UploadSessionsClass::missing(session));
+	LengthL += ChunkedResponse.quote(text + LengthL, size - LengthL, (session->Error != NULL) ? session->Error : "");
+	LengthL += snprintf(text + LengthL, size - LengthL, ",\"received\":[");
+	return LengthL;
 }
 
-/** @brief Delete file.
- *  @param request AsyncWebServerRequest, Request object.
+/** @brief Pin or unpin a stored image. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
  *  @return Void.
  */
-void LocalWebServerClass::handleFileDelete(AsyncWebServerRequest *request) {
+void LocalWebServerClass::handlePin(AsyncWebServerRequest *request)
+{
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	if (!checkAuth(request))
-		return request->requestAuthentication();
-	if (request->args() == 0) return request->send(500, "text/plain", "BAD ARGS");
-	String path = request->arg(0U);
-	DEBUGLOG("handleFileDelete: %s\r\n", path.c_str());
-	if (path == "/")
-		return request->send(500, "text/plain", "BAD PATH");
-	if (!_fileSystem->exists(path))
-		return request->send(404, "text/plain", "FileNotFound");
-	_fileSystem->remove(path);
-	request->send(200, "text/plain", "");
-	path = String(); // Remove? Useless statement?
+	if (!request->hasArg("name"))
+	{
+		request->send(400, "application/json", "{\"error\":\"Bad arguments\"}");
+		return;
+	}
+
+	bool PinnedL = !request->hasArg("pinned") || request->arg("pinned") != "0";
+	if (ImageStore.pin(request->arg("name").c_str(), PinnedL) != StatusCodes::Ok)
+	{
+		request->send(404, "application/json", "{\"error\":\"Image not found\"}");
+		return;
+	}
+
+	request->send(200, "application/json", String("{\"pinned\":") + (PinnedL ? "true" : "false") + "}");
 }
 
-/** @brief Upload file.
- *  @param request AsyncWebServerRequest, Request object.
- *  @param filename String, Name of the file.
- *  @param index size_t,
- *  @param data uint8, Content of the file.
- *  @param len size_t, Length of the file.
- *  @param final boolean, Flag for closing multipart file operation.
+/** @brief Send the usage of the image store and the recent evictions. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
  *  @return Void.
  */
-void LocalWebServerClass::handleFileUpload(
-	AsyncWebServerRequest *request,
-	String filename,
-	size_t index,
-	uint8 *data,
-	size_t len,
-	bool final) {
+void LocalWebServerClass::sendStorage(AsyncWebServerRequest *request)
+{
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	static File fsUploadFile;
-	static size_t fileSize = 0;
+	FSInfo InfoL;
+	bool InfoValidL = _fileSystem->info(InfoL);
+	uint32 TotalL = InfoValidL ? InfoL.totalBytes : 0;
+	uint32 UsedL = InfoValidL ? InfoL.usedBytes : 0;
 
-	if (!index) { // Start
-		DEBUGLOG("Handle file upload name: %s\r\n", filename.c_str());
-		if (!filename.startsWith("/")) filename = "/" + filename;
-		fsUploadFile = _fileSystem->open(filename, "w");
-		DEBUGLOG("First upload part.\r\n");
+	// The totals in the first item, an eviction per item.
+	uint8 IndexL = 0;
+	bool ClosedL = false;
+	request->send(ChunkedResponse.begin(request, "application/json",
+		[InfoValidL, TotalL, UsedL, IndexL, ClosedL](uint16 item, char* text, size_t size) mutable -> size_t
+	{
+		if (item == 0)
+		{
+			size_t LengthL = snprintf(text, size, "{");
+			if (InfoValidL)
+			{
+				LengthL += snprintf(text + LengthL, size - LengthL, "\"total\":%u,\"used\":%u,", TotalL, UsedL);
+			}
+			LengthL += snprintf(text + LengthL, size - LengthL, "\"images\":%u,\"count\":%u,\"quota\":%u,\"reserved\":%u,\"evictions\":[",
+				ImageStore.usage(), ImageStore.count(), (uint32)IMAGE_STORE_QUOTA, ImageStore.reserved());
+			return LengthL;
+		}
 
-	}
-	// Continue
-	if (fsUploadFile) {
-		DEBUGLOG("Continue upload part. Size = %u\r\n", len);
-		if (fsUploadFile.write(data, len) != len) {
-			DEBUGLOG("Write error during upload.\r\n");
+		const ImageEviction_t* EvictionL = ImageStore.eviction(IndexL);
+		if (EvictionL != NULL)
+		{
+			size_t LengthL = snprintf(text, size, "%s{\"name\":", (IndexL > 0) ? "," : "");
+			LengthL += ChunkedResponse.quote(text + LengthL, size - LengthL, EvictionL->Name);
+			LengthL += snprintf(text + LengthL, size - LengthL, ",\"stored\":%u,\"evicted\":%u}", EvictionL->StoredSize, EvictionL->EvictedAt);
+			IndexL++;
+			return LengthL;
 		}
-		else
-			fileSize += len;
-	}
-	/*for (size_t index = 0; index < len; index++) {
-	if (fsUploadFile)
-	fsUploadFile.write(data[index]);
-	}*/
-	if (final) { // End
-		if (fsUploadFile) {
-			fsUploadFile.close();
+
+		if (ClosedL)
+		{
+			return CHUNK_END;
 		}
-		DEBUGLOG("Handle file upload size: %u\r\n", fileSize);
-		fileSize = 0;
-	}
+		ClosedL = true;
+		return snprintf(text, size, "]}");
+	}));
 }
 
-#pragma endregion
-
-#ifdef ENABLE_OTA_ARDUINO
-
-/** @brief Configure OTA.
- *  @param password String, Password for flashing.
+/** @brief Check the credentials and issue a session token. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
  *  @return Void.
  */
-void LocalWebServerClass::configureOTA(String password) {
+void LocalWebServerClass::login(AsyncWebServerRequest *request)
+{
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	// Port defaults to 8266
-	// ArduinoOTA.setPort(8266);
-
-	// Host name defaults to esp8266-[ChipID]
-	ArduinoOTA.setHostname(DeviceConfiguration.DeviceName.c_str());
-
-	// No authentication by default
-	if (password != "") {
-		ArduinoOTA.setPassword(password.c_str());
-		DEBUGLOG("OTA password set %s\r\n", password.c_str());
+	if (!AuthSessions.checkCredentials(request->arg("HTTPUsername"), request->arg("HTTPPassword")))
+	{
+		request->send(401, "application/json", "{\"error\":\"Bad credentials\"}");
+		return;
 	}
 
-	ArduinoOTA.onStart([]() {
-		DEBUGLOG("StartOTA\r\n");
-	});
-	ArduinoOTA.onEnd(std::bind([](FS *fs) {
-		fs->end();
-		DEBUGLOG("End OTA\r\n");
-	}, _fileSystem));
-	ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
-		DEBUGLOG("OTA Progress: %u%%\r\n", (progress / (total / 100)));
-	});
-	ArduinoOTA.onError([](ota_error_t error) {
-		DEBUGLOG("Error[%u]: ", error);
-		if (error == OTA_AUTH_ERROR) DEBUGLOG("Authentication Failed\r\n");
-		else if (error == OTA_BEGIN_ERROR) DEBUGLOG("Begin Failed\r\n");
-		else if (error == OTA_CONNECT_ERROR) DEBUGLOG("Connect Failed\r\n");
-		else if (error == OTA_RECEIVE_ERROR) DEBUGLOG("Receive Failed\r\n");
-		else if (error == OTA_END_ERROR) DEBUGLOG("End Failed\r\n");
-	});
-	DEBUGLOG("OTA Ready\r\n");
+	char TokenL[SESSION_TOKEN_LENGTH + 1];
+	AuthSessions.issue(TokenL);
 
-	ArduinoOTA.begin();
+	AsyncWebServerResponse *response = request->beginResponse(200, "application/json",
+		String("{\"token\":\"") + TokenL + "\",\"expires\":" + String(SESSION_LIFETIME) + "}");
+	response->addHeader("Set-Cookie", AuthSessionsClass::cookie(TokenL));
+	request->send(response);
 }
 
-#endif // ENABLE_OTA_ARDUINO
+/** @brief Revoke the session token of the request. Part of the API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::logout(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
 
-#pragma region ENABLE_WEB_OTA
+	AuthSessions.revoke(request);
 
-#ifdef ENABLE_WEB_OTA
+	AsyncWebServerResponse *response = request->beginResponse(200, "application/json", "{}");
+	response->addHeader("Set-Cookie", AuthSessionsClass::cookie(NULL));
+	request->send(response);
+}
 
-/** @brief Set MD5 sum of the new firmware. Part of the API.
- *  @param request, AsyncWebServer Request request object.
+/** @brief Send the stored images as "name;size;pages;flashTime;" lines. Part of the programmer API.
+ *  @param request, AsyncWebServerRequest request object.
  *  @return Void.
  */
-void LocalWebServerClass::setUpdateMD5(AsyncWebServerRequest *request)
+void LocalWebServerClass::sendImageList(AsyncWebServerRequest *request)
 {
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	_browserMD5 = "";
-
-	DEBUGLOG("Arg number: %d\r\n", request->args());
-	if (request->args() > 0)  // Read hash
+	// Pages and the expected flash time come from the upload, 0 for older images.
+	uint8 SlotL = 0;
+	request->send(ChunkedResponse.begin(request, "text/plain", [SlotL](uint16 item, char* text, size_t size) mutable -> size_t
 	{
-		for (uint8 index = 0; index < request->args(); index++) {
-			DEBUGLOG("Arg %s: %s\r\n", request->argName(index).c_str(), request->arg(index).c_str());
-			if (request->argName(index) == "md5") {
-				_browserMD5 = urlDecode(request->arg(index));
-				Update.setMD5(_browserMD5.c_str());
-				continue;
-			}if (request->argName(index) == "size") {
-				_updateSize = request->arg(index).toInt();
-				DEBUGLOG("Update size: %l\r\n", _updateSize);
-				continue;
+		while (SlotL < IMAGE_STORE_ENTRIES)
+		{
+			const ImageEntry_t* ImageL = ImageStore.entry(SlotL++);
+			if (ImageL != NULL)
+			{
+				return snprintf(text, size, "%s;%u;%u;%u;\n", ImageL->Name, ImageL->Size, ImageL->Info.UsedPages, ImageL->Info.FlashTime);
 			}
 		}
-		request->send(200, "text/html", "OK --> MD5: " + _browserMD5);
+
+		return CHUNK_END;
+	}));
+}
+
+/** @brief Remove the image "?file=" and send the list. Part of the programmer API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::deleteImage(AsyncWebServerRequest *request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (!request->hasArg("file"))
+	{
+		request->send(400, "text/plain", "BAD ARGS");
+		return;
+	}
+
+	if (ImageStore.remove(request->arg("file").c_str()) != StatusCodes::Ok)
+	{
+		request->send(404, "text/plain", "FileNotFound");
+		return;
 	}
+
+	sendImageList(request);
 }
 
-/** @brief Save authentication data.
-*  @param request, AsyncWebServerRequest request object.
-*  @param filename String Name of the file.
-*  @param index size_t Part index.
-*  @param data uint8 Data content.
-*  @param len size_t Size of the content.
-*  @param final boolean Last part to close file.
-*  @return boolean, Return true if successful.
-*/
-void LocalWebServerClass::updateFirmware(
-	AsyncWebServerRequest *request,
-	String filename,
-	size_t index,
-	uint8 *data,
-	size_t len,
-	bool final)
+/** @brief Queue a flash job of the image "?file=". Part of the programmer API.
+ *  @param request, AsyncWebServerRequest request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::flashImage(AsyncWebServerRequest *request)
 {
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	// handler for the file upload, get's the sketch bytes, and writes
-	// them through the Update object
-	static long totalSize = 0;
-	if (!index) { //UPLOAD_FILE_START
-		SPIFFS.end();
-		Update.runAsync(true);
-		DEBUGLOG("Update start: %s\r\n", filename.c_str());
-		uint32_t maxSketchSpace = ESP.getSketchSize();
-		DEBUGLOG("Max free sketch space: %u\r\n", maxSketchSpace);
-		DEBUGLOG("New sketch size: %u\r\n", _updateSize);
-		if (_browserMD5 != NULL && _browserMD5 != "") {
-			Update.setMD5(_browserMD5.c_str());
-			DEBUGLOG("Hash from client: %s\r\n", _browserMD5.c_str());
+	// The job queue owns the target, flashing runs from the main loop.
+	uint16 IdL = 0;
+	uint8 StateL = FlashJobs.enqueue(JobTypes::JobFlash, request->arg("file").c_str(), 0, &IdL);
+
+	if (StateL == StatusCodes::Busy)
+	{
+		request->send(503, "text/plain", "error;queue;\n");
+		return;
+	}
+
+	if (StateL != StatusCodes::Ok)
+	{
+		const char* ErrorL = NULL;
+		ImageStore.precheck(request->arg("file").c_str(), &ErrorL);
+		request->send(400, "text/plain", "error;" + String((ErrorL != NULL) ? ErrorL : "image") + ";\n");
+		return;
+	}
+
+	request->send(200, "text/plain", "job;" + String(IdL) + ";\n");
+}
+
+/** @brief Write a part of a raw image body to the image store.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @param data uint8, Part of the body.
+ *  @param len size_t, Length of the part.
+ *  @param index size_t, Offset of the part.
+ *  @param total size_t, Length of the body.
+ *  @return Void.
+ */
+void LocalWebServerClass::handleImageUpload(AsyncWebServerRequest *request, uint8 *data, size_t len, size_t index, size_t total)
+{
+	// Parts of other requests go to their own contexts.
+	if (!index && !checkAuth(request))
+	{
+		return;
+	}
+
+	ImageUploadContext_t* ContextL = imageUpload(request, !index);
+	if (ContextL == NULL || ContextL->Failed)
+	{
+		return;
+	}
+
+	if (!index)
+	{
+		// Named like the images of the first programmer, which kept them in the stream flash folder.
+		String NameL = String(STREAM_FLASH_STORE_DIR) + "/" + request->arg("file");
+		ContextL->Failed = (!request->hasArg("file") || NameL.length() >= IMAGE_NAME_SIZE);
+		if (!ContextL->Failed)
+		{
+			strncpy(ContextL->Name, NameL.c_str(), IMAGE_NAME_SIZE - 1);
+			ContextL->Name[IMAGE_NAME_SIZE - 1] = '\0';
+			ContextL->Failed = !ImageStore.open(&ContextL->Image, total);
 		}
-		if (!Update.begin(_updateSize)) {//start with max available size
-			Update.printError(DEBUG_PORT);
+		if (ContextL->Failed)
+		{
+			DEBUGLOG("Image upload refused.\r\n");
+			return;
 		}
+	}
+
+	if (ContextL->Image.write(data, len) != len)
+	{
+		ImageStore.cancel(&ContextL->Image);
+		ContextL->Failed = true;
+		return;
+	}
+	ContextL->Received += len;
 
+	if (ContextL->Received < total)
+	{
+		return;
 	}
 
-	// Get upload file, continue if not start
-	totalSize += len;
-	DEBUGLOG(".");
-	size_t written = Update.write(data, len);
-	if (written != len) {
-		DEBUGLOG("len = %d, written = %l, totalSize = %l\r\n", len, written, totalSize);
-		Update.printError(DEBUG_PORT);
-		//return;
+	// Same content under another name costs no flash.
+	if (ContextL->Image.hasFailed())
+	{
+		ImageStore.cancel(&ContextL->Image);
+		ContextL->Failed = true;
 	}
-	if (final) {  // UPLOAD_FILE_END
-		String updateHash;
-		DEBUGLOG("Applying update...\r\n");
-		if (Update.end(true)) { //true to set the size to the current progress
-			updateHash = Update.md5String();
-			DEBUGLOG("Upload finished. Calculated MD5: %s\r\n", updateHash.c_str());
-			DEBUGLOG("Update Success: %u\nRebooting...\r\n", request->contentLength());
-		}
-		else {
-			updateHash = Update.md5String();
-			DEBUGLOG("Upload failed. Calculated MD5: %s\r\n", updateHash.c_str());
-			Update.printError(DEBUG_PORT);
-		}
+	else if (ImageStore.commit(&ContextL->Image, ContextL->Name, NULL) != StatusCodes::Ok)
+	{
+		ContextL->Failed = true;
 	}
+
+	DEBUGLOG("Image upload %s: %u bytes\r\n", ContextL->Name, ContextL->Received);
 }
 
-/** @brief Send firmware update values. Part of the API.
- *  @param request, AsyncWebServerRequest request object.
+/** @brief Reply the result of an image upload and release its context.
+ *  @param request AsyncWebServerRequest, Request object.
  *  @return Void.
  */
-void LocalWebServerClass::sendUpdateFWValues(AsyncWebServerRequest *request)
+void LocalWebServerClass::sendImageUploadResult(AsyncWebServerRequest *request)
 {
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	String values = "";
-	uint32_t maxSketchSpace = (ESP.getSketchSize() - 0x1000) & 0xFFFFF000;
-	//bool updateOK = Update.begin(maxSketchSpace);
-	bool updateOK = maxSketchSpace < ESP.getFreeSketchSpace();
-	StreamString result;
-	Update.printError(result);
-	DEBUGLOG("--MaxSketchSpace: %d\n", maxSketchSpace);
-	DEBUGLOG("--Update error = %s\n", result.c_str());
-	values += "remupd|" + (String)((updateOK) ? "OK" : "ERROR") + "|div\n";
+	ImageUploadContext_t* ContextL = imageUpload(request, false);
+	if (ContextL == NULL)
+	{
+		// No body at all, or no free context for it.
+		request->send(request->contentLength() ? 503 : 400, "text/plain", "FAILED");
+		return;
+	}
 
-	if (Update.hasError()) {
-		result.trim();
-		values += "remupdResult|" + result + "|div\n";
+	bool DoneL = !ContextL->Failed && ContextL->Received == request->contentLength();
+	request->send(DoneL ? 200 : 500, "text/plain", DoneL ? "DONE" : "FAILED");
+	releaseImageUpload(request);
+}
+
+/** @brief Find or take the image upload context of a request.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @param create bool, Take a free context when the request has none.
+ *  @return ImageUploadContext_t*, The context or NULL.
+ */
+ImageUploadContext_t* LocalWebServerClass::imageUpload(AsyncWebServerRequest *request, bool create)
+{
+	ImageUploadContext_t* FreeL = NULL;
+
+	for (uint8 index = 0; index < IMAGE_UPLOAD_CONTEXTS; index++)
+	{
+		if (_imageUploads[index].Request == request)
+		{
+			return &_imageUploads[index];
+		}
+		if (FreeL == NULL && _imageUploads[index].Request == NULL)
+		{
+			FreeL = &_imageUploads[index];
+		}
 	}
-	else {
-		values += "remupdResult||div\n";
+
+	if (!create || FreeL == NULL)
+	{
+		return NULL;
 	}
 
-	request->send(200, "text/plain", values);
+	FreeL->Request = request;
+	FreeL->Name[0] = '\0';
+	FreeL->Received = 0;
+	FreeL->Failed = false;
+
+	return FreeL;
 }
 
-#endif // ENABLE_OTA_HTT
+/** @brief Release the image upload context of a request, a cut upload is dropped.
+ *  @param request AsyncWebServerRequest, Request object.
+ *  @return Void.
+ */
+void LocalWebServerClass::releaseImageUpload(AsyncWebServerRequest *request)
+{
+	ImageUploadContext_t* ContextL = imageUpload(request, false);
+	if (ContextL == NULL)
+	{
+		return;
+	}
 
-#pragma endregion
+	if (ContextL->Image.isOpen())
+	{
+		DEBUGLOG("Image upload cut: %s\r\n", ContextL->Name);
+		ImageStore.cancel(&ContextL->Image);
+	}
 
-#pragma region API Handlers
+	ContextL->Request = NULL;
+}
 
-/** @brief Send list of networks. Part of the API.
+/** @brief Send the device, WiFi, storage, target, job, heap and request state in one document. Part of the API v2.
  *  @param request, AsyncWebServerRequest request object.
  *  @return Void.
  */
-void LocalWebServerClass::sendNetworks(AsyncWebServerRequest *request)
+void LocalWebServerClass::sendStatus(AsyncWebServerRequest *request)
 {
-	String json = "[";
-	int n = WiFi.scanComplete();
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
 
-	if (n == WIFI_SCAN_FAILED)
+	// Fixed size, no allocation while the document is built.
+	_statusBuffer.clear();
+	JsonObject& json = _statusBuffer.createObject();
+
+	JsonObject& device = json.createNestedObject("device");
+	device["name"] = DeviceConfiguration.DeviceName;
+	device["firmware"] = FW_VERSION;
+	device["chipId"] = ESP.getChipId();
+	device["uptime"] = millis() / 1000;
+	device["authentication"] = DeviceConfiguration.HTTPAuthentication;
+
+	WiFiMode_t ModeL = WiFi.getMode();
+	JsonObject& wifi = json.createNestedObject("wifi");
+	wifi["mode"] = (ModeL == WIFI_AP) ? "ap" : (ModeL == WIFI_STA) ? "sta" : (ModeL == WIFI_AP_STA) ? "ap_sta" : "off";
+	wifi["state"] = wifiStateName(WiFi.status());
+	if (WiFi.status() == WL_CONNECTED)
 	{
-		WiFi.scanNetworks(true);
+		wifi["ssid"] = WiFi.SSID();
+		wifi["ip"] = WiFi.localIP().toString();
+		wifi["rssi"] = WiFi.RSSI();
+		wifi["channel"] = WiFi.channel();
 	}
-	else if (n)
+	if (ModeL == WIFI_AP || ModeL == WIFI_AP_STA)
 	{
-		for (int index = 0; index < n; ++index)
-		{
-			if (index) json += ",";
-			json += "{";
-			json += "\"rssi\":" + String(WiFi.RSSI(index));
-			json += ",\"ssid\":\"" + WiFi.SSID(index) + "\"";
-			json += ",\"bssid\":\"" + WiFi.BSSIDstr(index) + "\"";
-			json += ",\"channel\":" + String(WiFi.channel(index));
-			json += ",\"secure\":" + String(WiFi.encryptionType(index));
-			json += ",\"hidden\":" + String(WiFi.isHidden(index) ? "true" : "false");
-			json += "}";
-		}
-		WiFi.scanDelete();
-		if (WiFi.scanComplete() == WIFI_SCAN_FAILED)
-		{
-			WiFi.scanNetworks(true);
-		}
+		wifi["apIp"] = WiFi.softAPIP().toString();
+		wifi["apStations"] = WiFi.softAPgetStationNum();
+	}
+
+	JsonObject& storage = json.createNestedObject("storage");
+	storage["backend"] = Storage.backendName();
+	FSInfo InfoL;
+	if (_fileSystem->info(InfoL))
+	{
+		storage["total"] = InfoL.totalBytes;
+		storage["used"] = InfoL.usedBytes;
+	}
+	storage["images"] = ImageStore.usage();
+	storage["count"] = ImageStore.count();
+	storage["quota"] = IMAGE_STORE_QUOTA;
+	storage["reserved"] = ImageStore.reserved();
+
+	JsonObject& target = json.createNestedObject("target");
+	target["mcu"] = IMAGE_DEFAULT_MCU;
+	target["flashSize"] = STK500_FLASH_SIZE;
+	target["baudrate"] = STK500_PORT_BAUDRATE;
+	target["busy"] = FlashJobs.isBusy();
+	target["golden"] = FlashJobs.golden();
+
+	const FlashJob_t* JobL = FlashJobs.current();
+	if (JobL != NULL)
+	{
+		jobToJson(JobL, json.createNestedObject("job"));
+	}
+	else
+	{
+		json["job"] = RawJson("null");
 	}
-	json += "]";
-	request->send(200, "text/json", json);
+
+	JsonObject& heap = json.createNestedObject("heap");
+	heap["free"] = ESP.getFreeHeap();
+	heap["maxBlock"] = max_free_block();
+	heap["responsePeak"] = ChunkedResponse.peak();
+
+	JsonObject& requests = json.createNestedObject("requests");
+	requests["active"] = _activeRequests;
+	requests["max"] = ADMISSION_MAX_REQUESTS;
+	requests["shed"] = _shedRequests;
+
+	// The text format of the firmware page, as fields.
+	uint32_t MaxSketchSpaceL = (ESP.getSketchSize() - 0x1000) & 0xFFFFF000;
+	JsonObject& update = json.createNestedObject("update");
+	update["possible"] = MaxSketchSpaceL < ESP.getFreeSketchSpace();
+	update["running"] = (_updateRequest != NULL);
+	update["error"] = Update.getError();
+
+	DEBUGLOG("Status document: %u of %u bytes\r\n", _statusBuffer.size(), STATUS_JSON_SIZE);
+
+	AsyncResponseStream *response = request->beginResponseStream("application/json");
+	json.printTo(*response);
+	request->send(response);
 }
 
-/** @brief Send connection state. Part of the API.
+/** @brief Name of a WiFi station state.
+ *  @param status uint8, State from WiFi.status().
+ *  @return const char*, Name.
+ */
+const char* LocalWebServerClass::wifiStateName(uint8 status)
+{
+	switch (status)
+	{
+	case WL_IDLE_STATUS: return "Idle";
+	case WL_NO_SSID_AVAIL: return "NO SSID AVAILBLE";
+	case WL_SCAN_COMPLETED: return "SCAN COMPLETED";
+	case WL_CONNECTED: return "CONNECTED";
+	case WL_CONNECT_FAILED: return "CONNECT FAILED";
+	case WL_CONNECTION_LOST: return "CONNECTION LOST";
+	case WL_DISCONNECTED: return "DISCONNECTED";
+	default: return "N/A";
+	}
+}
+
+/** @brief Show or pin the golden image of the target. Part of the API.
  *  @param request, AsyncWebServerRequest request object.
  *  @return Void.
  */
-void LocalWebServerClass::sendConnectionState(AsyncWebServerRequest *request)
+void LocalWebServerClass::handleGolden(AsyncWebServerRequest *request)
 {
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	String state = "N/A";
-	String Networks = "";
-	if (WiFi.status() == 0) state = "Idle";
-	else if (WiFi.status() == 1) state = "NO SSID AVAILBLE";
-	else if (WiFi.status() == 2) state = "SCAN COMPLETED";
-	else if (WiFi.status() == 3) state = "CONNECTED";
-	else if (WiFi.status() == 4) state = "CONNECT FAILED";
-	else if (WiFi.status() == 5) state = "CONNECTION LOST";
-	else if (WiFi.status() == 6) state = "DISCONNECTED";
+	if (request->method() == HTTP_POST)
+	{
+		if (!request->hasArg("file"))
+		{
+			request->send(400, "application/json", "{\"error\":\"Bad arguments\"}");
+			return;
+		}
 
-	WiFi.scanNetworks(true);
+		if (FlashJobs.pinGolden(request->arg("file").c_str()) != StatusCodes::Ok)
+		{
+			request->send(404, "application/json", "{\"error\":\"Image not found\"}");
+			return;
+		}
+	}
 
-	String values = "";
-	values += "ConnectionState|" + state + "|div\n";
-	//values += "networks|Scanning networks ...|div\n";
-	request->send(200, "text/plain", values);
-	state = "";
-	values = "";
-	Networks = "";
+	request->send(200, "application/json", "{\"file\":\"" + String(FlashJobs.golden()) + "\"}");
 }
 
-/** @brief Send device configuration. Part of the API.
+/** @brief Send the phase timings of the recent jobs. Part of the API.
  *  @param request, AsyncWebServerRequest request object.
  *  @return Void.
  */
-void LocalWebServerClass::sendConfiguration(AsyncWebServerRequest *request)
+void LocalWebServerClass::sendTimeline(AsyncWebServerRequest *request)
 {
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	String values = "";
-	values += "FWVersion|" + String(FW_VERSION) + "|div\n";
-	values += "DeviceName|" + (String)DeviceConfiguration.DeviceName + "|input\n";
-	values += "STASSID|" + (String)DeviceConfiguration.STASSID + "|input\n";
-	values += "HTTPUsername|" + (String)DeviceConfiguration.HTTPUsername + "|input\n";
-	values += "HTTPAuthentication|" + (String)DeviceConfiguration.HTTPAuthentication + "|input\n";
+	// A job head per item, then its phases one by one, the summary is merged a phase at a time.
+	uint8 IndexL = 0;
+	uint8 PhaseL = PhaseCount;
+	uint16 JobIdL = 0;
+	bool SummaryL = false;
+	bool ClosedL = false;
+	request->send(ChunkedResponse.begin(request, "application/json", [IndexL, PhaseL, JobIdL, SummaryL, ClosedL](uint16 item, char* text, size_t size) mutable -> size_t
+	{
+		if (item == 0)
+		{
+			return snprintf(text, size, "{\"jobs\":[");
+		}
 
-#ifdef ENABLE_CAYENNE_MODE
+		PhaseStats_t StatsL;
+		memset(&StatsL, 0, sizeof(StatsL));
 
-	values += "CayenneUsername|" + (String)DeviceConfiguration.CayenneUsername + "|input\n";
+		if (!SummaryL && PhaseL < PhaseCount)
+		{
+			// Found by ID, a job that ended meanwhile may have moved in the ring.
+			for (uint8 index = 0; index < FlashTimeline.count(); index++)
+			{
+				const JobTimeline_t* TimelineL = FlashTimeline.get(index);
+				if (TimelineL->JobId == JobIdL)
+				{
+					StatsL = TimelineL->Phases[PhaseL];
+					break;
+				}
+			}
 
-#endif // ENABLE_CAYENNE_MODE
+			size_t LengthL = phaseItem(text, size, PhaseL, &StatsL);
+			if (++PhaseL == PhaseCount)
+			{
+				LengthL += snprintf(text + LengthL, size - LengthL, "}}");
+			}
+			return LengthL;
+		}
 
-	request->send(200, "text/plain", values);
+		if (!SummaryL && IndexL < FlashTimeline.count())
+		{
+			const JobTimeline_t* TimelineL = FlashTimeline.get(IndexL);
+			JobIdL = TimelineL->JobId;
+			PhaseL = 0;
+
+			return snprintf(text, size,
+				"%s{\"id\":%u,\"type\":\"%s\",\"result\":\"%s\",\"duration\":%u,\"retries\":%u,\"decodeBytesPerSecond\":%u,\"phases\":{",
+				(IndexL++ > 0) ? "," : "", TimelineL->JobId, FlashJobQueueClass::typeName(TimelineL->Type),
+				(TimelineL->Result == StatusCodes::Busy) ? "running" : (TimelineL->Result == StatusCodes::Ok) ? "ok" : "failed",
+				TimelineL->Duration, TimelineL->Retries, FlashTimelineClass::decodeBytesPerSecond(TimelineL));
+		}
+
+		if (!SummaryL)
+		{
+			SummaryL = true;
+			PhaseL = 0;
+
+			// Decoding keeps up when it is well above the line rate.
+			return snprintf(text, size, "],\"uartBytesPerSecond\":%u,\"summary\":{", (uint32)(STK500_PORT_BAUDRATE / 10));
+		}
+
+		if (PhaseL < PhaseCount)
+		{
+			// Over all kept jobs.
+			StatsL.Min = UINT32_MAX;
+			for (uint8 index = 0; index < FlashTimeline.count(); index++)
+			{
+				FlashTimelineClass::merge(&StatsL, &FlashTimeline.get(index)->Phases[PhaseL]);
+			}
+
+			return phaseItem(text, size, PhaseL++, &StatsL);
+		}
+
+		if (ClosedL)
+		{
+			return CHUNK_END;
+		}
+		ClosedL = true;
+		return snprintf(text, size, "}}");
+	}));
 }
 
-/** @brief Settings arguments parser. Part of the API.
+/** @brief Write the statistics of a phase.
+ *  @param text char*, Item buffer.
+ *  @param size size_t, Size of the buffer.
+ *  @param phase uint8, Timed phase, the first one has no comma.
+ *  @param stats const PhaseStats_t*, Phase statistics.
+ *  @return size_t, Length of the item.
+ */
+size_t LocalWebServerClass::phaseItem(char* text, size_t size, uint8 phase, const PhaseStats_t* stats)
+{
+	return snprintf(text, size, "%s\"%s\":{\"count\":%u,\"min\":%u,\"avg\":%u,\"p95\":%u,\"max\":%u}",
+		(phase > 0) ? "," : "", FlashTimelineClass::phaseName(phase), stats->Count,
+		(stats->Count > 0) ? stats->Min : 0, (stats->Count > 0) ? (uint32)(stats->Sum / stats->Count) : 0,
+		FlashTimelineClass::percentile(stats, 95), stats->Max);
+}
+
+/** @brief Reply the result of a stream-through flash once its job is over. Part of the API.
  *  @param request, AsyncWebServerRequest request object.
  *  @return Void.
  */
-void LocalWebServerClass::saveConfiguration(AsyncWebServerRequest *request)
+void LocalWebServerClass::sendStreamFlashResult(AsyncWebServerRequest *request)
 {
 	DEBUGLOG("\r\n");
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	if (!checkAuth(request))
-		return request->requestAuthentication();
-
-	if (request->args() > 0)  // Save Settings
+	if (!StreamFlash.owns(request))
 	{
-		for (uint8 index = 0; index < request->args(); index++)
-		{
-			DEBUGLOG("Arg %s: %s\r\n", request->argName(index).c_str(), urlDecode(request->arg(index)).c_str());
-
-#pragma region Device Name
+		request->send(503, "application/json", "{\"error\":\"Programmer busy\"}");
+		return;
+	}
 
-			if (request->argName(index) == "DeviceName") {
-				DeviceConfiguration.DeviceName = urlDecode(request->arg(index));
-				DEBUGLOG("STASSID: %s\r\n", DeviceConfiguration.DeviceName.c_str());
+	uint16 IdL = StreamFlash.jobId();
+	StreamFlash.close(request);
 
-				continue;
-			}
+	// The image is committed by close(), a failed commit clears the path.
+	String StoredL = StreamFlash.storePath();
 
-#pragma endregion
+	// Headers go out now, the body waits for the end of the job.
+	AsyncWebServerResponse *response = request->beginChunkedResponse("application/json",
+		[IdL, StoredL](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+	{
+		if (index > 0)
+		{
+			return 0;
+		}
 
-#pragma region STA
+		const FlashJob_t* JobL = FlashJobs.find(IdL);
+		if (JobL != NULL && (JobL->State == JobStates::JobQueued || JobL->State == JobStates::JobRunning))
+		{
+			return RESPONSE_TRY_AGAIN;
+		}
 
-			if (request->argName(index) == "STASSID")
-			{
-				DeviceConfiguration.STASSID = urlDecode(request->arg(index));
-				DEBUGLOG("STASSID: %s\r\n", DeviceConfiguration.STASSID.c_str());
-				continue;
-			}
+		int LengthL = snprintf((char*)buffer, maxLen,
+			"{\"id\":%u,\"state\":\"%s\",\"pagesDone\":%u,\"bytesPerSecond\":%u,\"error\":\"%s\",\"stored\":\"%s\",\"rollbackJob\":%u}",
+			IdL, (JobL != NULL) ? FlashJobQueueClass::stateName(JobL->State) : "unknown",
+			(JobL != NULL) ? JobL->PagesDone : 0, (JobL != NULL) ? FlashJobQueueClass::bytesPerSecond(JobL) : 0,
+			(JobL != NULL) ? JobL->Error : "", StoredL.c_str(), (JobL != NULL) ? JobL->RollbackId : 0);
 
-			if (request->argName(index) == "STAPassword")
-			{
-				String pswd = urlDecode(request->arg(index));
-				if (pswd != "")
-				{
-					DeviceConfiguration.STAPassword = pswd;
-					DEBUGLOG("STAPassword: %s\r\n", DeviceConfiguration.STAPassword.c_str());
-				}
-				continue;
-			}
+		return (LengthL < (int)maxLen) ? LengthL : maxLen - 1;
+	});
 
-#pragma endregion
+	response->addHeader("Cache-Control", "no-cache");
+	request->send(response);
+}
 
-#pragma region AP
+/** @brief Fill JSON object with the state of a job.
+ *  @param job const FlashJob_t*, The job.
+ *  @param json JsonObject, Destination object.
+ *  @return Void.
+ */
+void LocalWebServerClass::jobToJson(const FlashJob_t* job, JsonObject& json)
+{
+	json["id"] = job->Id;
+	json["type"] = FlashJobQueueClass::typeName(job->Type);
+	json["state"] = FlashJobQueueClass::stateName(job->State);
+	json["file"] = job->Path;
+	json["pagesDone"] = job->PagesDone;
+	json["pagesTotal"] = FlashJobQueueClass::pagesTotal(job);
+	json["bytesPerSecond"] = FlashJobQueueClass::bytesPerSecond(job);
+	json["error"] = job->Error;
+	json["rollbackJob"] = job->RollbackId;
+	json["rollbackOf"] = job->RollbackOf;
+}
 
-			if (request->argName(index) == "APPassword") {
-				String pswd = urlDecode(request->arg(index));
-				if (pswd != "")
-				{
-					DeviceConfiguration.APPassword = pswd;
-					DEBUGLOG("APPassword: %s\r\n", DeviceConfiguration.APPassword.c_str());
-				}
-				continue;
-			}
+/** @brief Write a part of the state of a job.
+ *  @param text char*, Item buffer.
+ *  @param size size_t, Size of the buffer.
+ *  @param job const FlashJob_t*, The job.
+ *  @param part uint8, 0 for the names, 1 for the progress.
+ *  @param first bool*, No job was written yet, cleared.
+ *  @return size_t, Length of the item.
+ */
+size_t LocalWebServerClass::jobItem(char* text, size_t size, const FlashJob_t* job, uint8 part, bool* first)
+{
+	size_t LengthL = 0;
 
-#pragma endregion
+	if (part == 0)
+	{
+		LengthL = snprintf(text, size, "%s{\"id\":%u,\"type\":\"%s\",\"state\":\"%s\",\"file\":", (*first) ? "" : ",",
+			job->Id, FlashJobQueueClass::typeName(job->Type), FlashJobQueueClass::stateName(job->State));
+		*first = false;
+		LengthL += ChunkedResponse.quote(text + LengthL, size - LengthL, job->Path);
+		return LengthL;
+	}
 
-#pragma region HTTP Authentication
+	LengthL = snprintf(text, size, ",\"pagesDone\":%u,\"pagesTotal\":%u,\"bytesPerSecond\":%u,\"error\":",
+		job->PagesDone, FlashJobQueueClass::pagesTotal(job), FlashJobQueueClass::bytesPerSecond(job));
+	LengthL += ChunkedResponse.quote(text + LengthL, size - LengthL, (job->Error != NULL) ? job->Error : "");
+	LengthL += snprintf(text + LengthL, size - LengthL, ",\"rollbackJob\":%u,\"rollbackOf\":%u}", job->RollbackId, job->RollbackOf);
+	return LengthL;
+}
 
-			if (request->argName(index) == "HTTPUsername") {
-				DeviceConfiguration.HTTPUsername = urlDecode(request->arg(index));
-				DEBUGLOG("HTTPUsername: %s\r\n", DeviceConfiguration.HTTPUsername.c_str());
-				continue;
-			}
+/** @brief Push the progress of the running job to the event listeners.
+ *  @return Void.
+ */
+void LocalWebServerClass::publishProgress()
+{
+	const FlashJob_t* JobL = FlashJobs.current();
 
-			if (request->argName(index) == "HTTPPassword") {
-				String pswd = urlDecode(request->arg(index));
-				if (pswd != "")
-				{
-					DeviceConfiguration.HTTPPassword = pswd;
-					DEBUGLOG("HTTPPassword: %s\r\n", DeviceConfiguration.HTTPPassword.c_str());
-				}
-				continue;
-			}
+	// Keep following a finished job to report its final state.
+	if (JobL == NULL && _progressJobId != 0)
+	{
+		JobL = FlashJobs.find(_progressJobId);
+	}
 
-			if (request->argName(index) == "HTTPAuthentication") {
-				DeviceConfiguration.HTTPAuthentication = true;
-				DEBUGLOG("HTTPAuthentication: %d\r\n", DeviceConfiguration.HTTPAuthentication);
-				continue;
-			}
+	if (JobL == NULL)
+	{
+		_progressJobId = 0;
+		return;
+	}
 
-#pragma endregion
+	unsigned long NowL = millis();
+	bool PhaseChangedL = (JobL->Id != _progressJobId || JobL->State != _progressState);
 
-		}
+	if (!PhaseChangedL && (JobL->State != JobStates::JobRunning || (NowL - _progressTime) < PROGRESS_EVENT_INTERVAL))
+	{
+		return;
+	}
 
-		// Save device configuration.
-		save_device_configuration(_fileSystem);
+	uint32 InstantL = 0;
+	if (JobL->Id == _progressJobId && NowL > _progressTime && JobL->PagesDone >= _progressPages)
+	{
+		InstantL = (uint32)((uint64_t)(JobL->PagesDone - _progressPages) * STK500_PAGE_SIZE * 1000UL / (NowL - _progressTime));
+	}
 
+	uint32 AverageL = FlashJobQueueClass::bytesPerSecond(JobL);
+	uint32 TotalL = FlashJobQueueClass::pagesTotal(JobL);
+	uint32 EtaL = 0;
+	if (AverageL > 0 && TotalL > JobL->PagesDone)
+	{
+		EtaL = (TotalL - JobL->PagesDone) * STK500_PAGE_SIZE / AverageL;
 	}
 
-	if (!this->handleFileRead("/configuration.html", request))
+	_progressJobId = (JobL->State == JobStates::JobRunning) ? JobL->Id : 0;
+	_progressState = JobL->State;
+	_progressPages = JobL->PagesDone;
+	_progressTime = NowL;
+
+	if (_events.count() == 0)
 	{
-		request->send(404, "text/plain", "FileNotFound");
 		return;
 	}
+
+	char EventL[192];
+	snprintf(EventL, sizeof(EventL),
+		"{\"id\":%u,\"type\":\"%s\",\"phase\":\"%s\",\"pagesDone\":%u,\"pagesTotal\":%u,\"bps\":%u,\"avgBps\":%u,\"eta\":%u,\"error\":\"%s\"}",
+		JobL->Id, FlashJobQueueClass::typeName(JobL->Type), FlashJobQueueClass::stateName(JobL->State),
+		JobL->PagesDone, TotalL, InstantL, AverageL, EtaL, JobL->Error);
+
+	_events.send(EventL, "progress", NowL);
 }
 
 #pragma endregion
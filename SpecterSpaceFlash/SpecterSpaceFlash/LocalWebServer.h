@@ -58,8 +58,109 @@ SOFTWARE.
 
 #include "GeneralHelper.h"
 
+#include "FlashJobs.h"
+
+#include "StreamFlash.h"
+
+#include "UploadSessions.h"
+
+#include "WebAssets.h"
+
+#include "FileIndex.h"
+
+#include "ChunkedResponse.h"
+
+#include "AuthSessions.h"
+
+#include "NetworkScan.h"
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief State of an editor upload, bound to its request.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	AsyncWebServerRequest* Request; ///< Owner of the context, NULL for a free context.
+	BlockWriter Upload; ///< File being written in whole blocks.
+	char Path[IMAGE_NAME_SIZE]; ///< Path of the file, removed when the upload is cut.
+	size_t Size; ///< Bytes written.
+	bool Failed; ///< The upload could not be stored.
+} UploadContext_t;
+
+/** @brief State of an image upload of the programmer page, bound to its request.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	AsyncWebServerRequest* Request; ///< Owner, NULL for a free context.
+	ImageWriter Image; ///< Destination in the image store.
+	char Name[IMAGE_NAME_SIZE]; ///< Image name to commit as.
+	uint32 Received; ///< Bytes written.
+	bool Failed; ///< The upload could not be stored.
+} ImageUploadContext_t;
+
+/** @brief Request budget of one client.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint32 Address; ///< IPv4 address of the client, 0 for a free entry.
+	uint32 Tokens; ///< Requests left, in 1/1000 of a request.
+	unsigned long Refill; ///< Time of the last refill in ms.
+} AdmissionClient_t;
+
 #pragma endregion
 
+/** @brief Rewrite of the "/command&name" URLs of the first programmer page to "/command?file=name".
+ */
+class LegacyRewrite : public AsyncWebRewrite
+{
+public:
+
+	/** @brief Constructor.
+	 *  @param from const char*, Path of the command.
+	 */
+	LegacyRewrite(const char* from);
+
+	/** @brief Match the command and take the name after "&" as the file parameter.
+	 *  @param request AsyncWebServerRequest*, Request object.
+	 *  @return bool, True for "<from>&<name>".
+	 */
+	bool match(AsyncWebServerRequest* request) override;
+};
+
+/** @brief First handler of the server, takes the requests that are not admitted and refuses them with 503.
+ */
+class AdmissionHandler : public AsyncWebHandler
+{
+protected:
+
+	/* @brief Admission decision, true lets the request through. */
+	ArRequestFilterFunction _admit;
+
+public:
+
+	/** @brief Constructor.
+	 *  @param admit ArRequestFilterFunction, Admission decision.
+	 */
+	AdmissionHandler(ArRequestFilterFunction admit);
+
+	/** @brief Take the request when it is not admitted.
+	 *  @param request AsyncWebServerRequest*, Request object.
+	 *  @return bool, True when the request is refused.
+	 */
+	bool canHandle(AsyncWebServerRequest* request) override;
+
+	/** @brief Refuse the request with 503 and Retry-After.
+	 *  @param request AsyncWebServerRequest*, Request object.
+	 *  @return Void.
+	 */
+	void handleRequest(AsyncWebServerRequest* request) override;
+};
+
 class LocalWebServerClass : public AsyncWebServer
 {
 protected:
@@ -75,6 +176,45 @@ protected:
 	/* @brief Size of the firmware. */
 	uint32_t _updateSize = 0;
 
+	/* @brief Request carrying the firmware, one at a time. */
+	AsyncWebServerRequest* _updateRequest = NULL;
+
+	/* @brief Firmware bytes received. */
+	uint32_t _updateReceived = 0;
+
+	/* @brief Editor uploads, _tempObject of the request is freed without destructors. */
+	UploadContext_t _uploads[UPLOAD_CONTEXTS];
+
+	/* @brief Image uploads of the programmer page. */
+	ImageUploadContext_t _imageUploads[IMAGE_UPLOAD_CONTEXTS];
+
+	/* @brief Flash progress event channel. */
+	AsyncEventSource _events;
+
+	/* @brief Job of the last progress event. */
+	uint16 _progressJobId = 0;
+
+	/* @brief Job state of the last progress event. */
+	uint8 _progressState = 0;
+
+	/* @brief Pages done at the last progress event. */
+	uint32 _progressPages = 0;
+
+	/* @brief Time of the last progress event. */
+	unsigned long _progressTime = 0;
+
+	/* @brief Document of the status API, reused by every request. */
+	StaticJsonBuffer<STATUS_JSON_SIZE> _statusBuffer;
+
+	/* @brief Admitted requests not closed yet. */
+	uint8 _activeRequests = 0;
+
+	/* @brief Requests refused by the admission. */
+	uint32 _shedRequests = 0;
+
+	/* @brief Request budgets of the recent clients. */
+	AdmissionClient_t _clients[ADMISSION_CLIENTS];
+
 #pragma endregion
 
 #pragma region Methods
@@ -94,6 +234,50 @@ protected:
 	 */
 	bool handleFileRead(String path, AsyncWebServerRequest *request);
 
+	/** @brief Send a file of the embedded web UI.
+	 *  @param asset const WebAsset_t*, The file.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @return Void.
+	 */
+	void sendAsset(const WebAsset_t* asset, AsyncWebServerRequest *request);
+
+	/** @brief Reply 304 when the browser has the file.
+	 *  @param tag const char*, ETag of the file, may be NULL.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @return bool, True when the reply was sent.
+	 */
+	bool sendNotModified(const char* tag, AsyncWebServerRequest *request);
+
+	/** @brief Add the cache headers of a static file.
+	 *  @param response AsyncWebServerResponse, Response object.
+	 *  @param tag const char*, ETag of the file, NULL for no caching.
+	 *  @param gzip bool, The content is gzipped.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @return Void.
+	 */
+	void addCacheHeaders(AsyncWebServerResponse *response, const char* tag, bool gzip, AsyncWebServerRequest *request);
+
+	/** @brief Get the ETag of a static file, hashed on the first request.
+	 *  @param path String, File path.
+	 *  @return const char*, Quoted ETag or NULL for files that are not cached.
+	 */
+	const char* assetTag(const String& path);
+
+	/** @brief Write an item of the file list.
+	 *  @param text char*, Item buffer.
+	 *  @param size size_t, Size of the buffer.
+	 *  @param name const char*, File name without the leading slash.
+	 *  @param first bool*, No item was written yet, cleared.
+	 *  @return size_t, Length of the item.
+	 */
+	static size_t fileListItem(char* text, size_t size, const char* name, bool* first);
+
+	/** @brief Check that a file exists, from the file index when it covers the path.
+	 *  @param path String, File path.
+	 *  @return bool, True when the file exists.
+	 */
+	bool fileExists(const String& path);
+
 	/** @brief Create file.
 	 *  @param request AsyncWebServerRequest, Request object.
 	 *  @return Void.
@@ -117,6 +301,25 @@ protected:
 	 */
 	void handleFileUpload(AsyncWebServerRequest *request, String filename, size_t index, uint8 *data, size_t len, bool final);
 
+	/** @brief Reply the result of an upload and release its context.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @return Void.
+	 */
+	void sendUploadResult(AsyncWebServerRequest *request);
+
+	/** @brief Find or take the upload context of a request.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @param create bool, Take a free context when the request has none.
+	 *  @return UploadContext_t*, The context or NULL.
+	 */
+	UploadContext_t* uploadContext(AsyncWebServerRequest *request, bool create);
+
+	/** @brief Release the upload context of a request, a cut upload is removed.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @return Void.
+	 */
+	void releaseUpload(AsyncWebServerRequest *request);
+
 #endif // ENABLE_WEB_EDITOR
 
 #ifdef ENABLE_WEB_OTA
@@ -138,6 +341,12 @@ protected:
 	*/
 	void updateFirmware(AsyncWebServerRequest *request, String filename, size_t index, uint8 *data, size_t len, bool final);
 
+	/** @brief Drop the firmware update of a request that went away.
+	*  @param request, AsyncWebServerRequest request object.
+	*  @return Void.
+	*/
+	void abortUpdate(AsyncWebServerRequest *request);
+
 	/** @brief Send firmware update values. Part of the API.
 	*  @param request, AsyncWebServerRequest request object.
 	*  @return Void.
@@ -182,6 +391,218 @@ protected:
 	 */
 	void sendNetworks(AsyncWebServerRequest *request);
 
+	/** @brief Ask for a new WiFi scan and send the scan state. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void refreshNetworks(AsyncWebServerRequest *request);
+
+	/** @brief Queue a flash, verify or read job. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void addJob(AsyncWebServerRequest *request);
+
+	/** @brief Send the state of one or all jobs. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void sendJob(AsyncWebServerRequest *request);
+
+	/** @brief Send the manifest of the stored images. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void sendImages(AsyncWebServerRequest *request);
+
+	/** @brief Write a part of an image of the manifest.
+	 *  @param text char*, Item buffer.
+	 *  @param size size_t, Size of the buffer.
+	 *  @param image const ImageEntry_t*, The image.
+	 *  @param part uint8, 0 for the names, 1 for the sizes and times, 2 for the properties.
+	 *  @param first bool*, No image was written yet, cleared.
+	 *  @return size_t, Length of the item.
+	 */
+	static size_t imageItem(char* text, size_t size, const ImageEntry_t* image, uint8 part, bool* first);
+
+	/** @brief Pin or unpin a stored image. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void handlePin(AsyncWebServerRequest *request);
+
+	/** @brief Send the usage of the image store and the recent evictions. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void sendStorage(AsyncWebServerRequest *request);
+
+	/** @brief Check the credentials and issue a session token. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void login(AsyncWebServerRequest *request);
+
+	/** @brief Revoke the session token of the request. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void logout(AsyncWebServerRequest *request);
+
+	/** @brief Send the stored images as "name;size;pages;flashTime;" lines. Part of the programmer API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void sendImageList(AsyncWebServerRequest *request);
+
+	/** @brief Remove the image "?file=" and send the list. Part of the programmer API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void deleteImage(AsyncWebServerRequest *request);
+
+	/** @brief Queue a flash job of the image "?file=". Part of the programmer API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void flashImage(AsyncWebServerRequest *request);
+
+	/** @brief Write a part of a raw image body to the image store.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @param data uint8, Part of the body.
+	 *  @param len size_t, Length of the part.
+	 *  @param index size_t, Offset of the part.
+	 *  @param total size_t, Length of the body.
+	 *  @return Void.
+	 */
+	void handleImageUpload(AsyncWebServerRequest *request, uint8 *data, size_t len, size_t index, size_t total);
+
+	/** @brief Reply the result of an image upload and release its context.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @return Void.
+	 */
+	void sendImageUploadResult(AsyncWebServerRequest *request);
+
+	/** @brief Find or take the image upload context of a request.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @param create bool, Take a free context when the request has none.
+	 *  @return ImageUploadContext_t*, The context or NULL.
+	 */
+	ImageUploadContext_t* imageUpload(AsyncWebServerRequest *request, bool create);
+
+	/** @brief Release the image upload context of a request, a cut upload is dropped.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @return Void.
+	 */
+	void releaseImageUpload(AsyncWebServerRequest *request);
+
+	/** @brief Send the device, WiFi, storage, target, job, heap and request state in one document. Part of the API v2.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void sendStatus(AsyncWebServerRequest *request);
+
+	/** @brief Name of a WiFi station state.
+	 *  @param status uint8, State from WiFi.status().
+	 *  @return const char*, Name.
+	 */
+	static const char* wifiStateName(uint8 status);
+
+	/** @brief Create a resumable upload session. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void createUpload(AsyncWebServerRequest *request);
+
+	/** @brief Send the received ranges of one or all upload sessions. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void sendUploads(AsyncWebServerRequest *request);
+
+	/** @brief Reply the result of a chunk of an upload session. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void sendChunkResult(AsyncWebServerRequest *request);
+
+	/** @brief Commit an upload session with its hash. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void commitUpload(AsyncWebServerRequest *request);
+
+	/** @brief Drop an upload session. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void deleteUpload(AsyncWebServerRequest *request);
+
+	/** @brief Fill JSON object with the state of an upload session.
+	 *  @param session const UploadSession_t*, The session.
+	 *  @param json JsonObject, Destination object.
+	 *  @return Void.
+	 */
+	static void uploadToJson(const UploadSession_t* session, JsonObject& json);
+
+	/** @brief Write the state of an upload session up to its received ranges.
+	 *  @param text char*, Item buffer.
+	 *  @param size size_t, Size of the buffer.
+	 *  @param session const UploadSession_t*, The session.
+	 *  @param first bool*, No session was written yet, cleared.
+	 *  @return size_t, Length of the item.
+	 */
+	static size_t uploadItem(char* text, size_t size, const UploadSession_t* session, bool* first);
+
+	/** @brief Show or pin the golden image of the target. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void handleGolden(AsyncWebServerRequest *request);
+
+	/** @brief Send the phase timings of the recent jobs. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void sendTimeline(AsyncWebServerRequest *request);
+
+	/** @brief Write the statistics of a phase.
+	 *  @param text char*, Item buffer.
+	 *  @param size size_t, Size of the buffer.
+	 *  @param phase uint8, Timed phase, the first one has no comma.
+	 *  @param stats const PhaseStats_t*, Phase statistics.
+	 *  @return size_t, Length of the item.
+	 */
+	static size_t phaseItem(char* text, size_t size, uint8 phase, const PhaseStats_t* stats);
+
+	/** @brief Reply the result of a stream-through flash once its job is over. Part of the API.
+	 *  @param request, AsyncWebServerRequest request object.
+	 *  @return Void.
+	 */
+	void sendStreamFlashResult(AsyncWebServerRequest *request);
+
+	/** @brief Fill JSON object with the state of a job.
+	 *  @param job const FlashJob_t*, The job.
+	 *  @param json JsonObject, Destination object.
+	 *  @return Void.
+	 */
+	static void jobToJson(const FlashJob_t* job, JsonObject& json);
+
+	/** @brief Write a part of the state of a job.
+	 *  @param text char*, Item buffer.
+	 *  @param size size_t, Size of the buffer.
+	 *  @param job const FlashJob_t*, The job.
+	 *  @param part uint8, 0 for the names, 1 for the progress.
+	 *  @param first bool*, No job was written yet, cleared.
+	 *  @return size_t, Length of the item.
+	 */
+	static size_t jobItem(char* text, size_t size, const FlashJob_t* job, uint8 part, bool* first);
+
+	/** @brief Push the progress of the running job to the event listeners.
+	 *  @return Void.
+	 */
+	void publishProgress();
+
 #pragma endregion
 
 
@@ -191,6 +612,35 @@ protected:
 	 */
 	bool checkAuth(AsyncWebServerRequest *request);
 
+	/** @brief Admit a request by the free heap, the requests in progress and the rate of its client.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @return bool, True when the request is served.
+	 */
+	bool admit(AsyncWebServerRequest *request);
+
+	/** @brief Close an admitted request, the state it holds is released.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @return Void.
+	 */
+	void closeRequest(AsyncWebServerRequest *request);
+
+	/** @brief Take one request from the budget of a client.
+	 *  @param address uint32, IPv4 address of the client.
+	 *  @return bool, True when the client has requests left.
+	 */
+	bool takeClientToken(uint32 address);
+
+	/** @brief Check for the upload and flash routes, they keep a reserved share of the server.
+	 *  @param request AsyncWebServerRequest, Request object.
+	 *  @return bool, True for an upload or flash route.
+	 */
+	static bool isReservedRoute(AsyncWebServerRequest *request);
+
+	/** @brief Check for uploads, firmware updates and flash jobs in progress.
+	 *  @return bool, True while data moves through the server or to the target.
+	 */
+	bool isTransferring();
+
 	/** @brief Add handlers to roots.
 	 *  @return Void.
 	 */
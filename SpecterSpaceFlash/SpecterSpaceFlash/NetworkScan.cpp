@@ -0,0 +1,209 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "NetworkScan.h"
+
+#pragma region NetworkScanClass
+
+/** @brief Ask for a scan when the kept networks are older than SCAN_CACHE_TTL.
+ *  @return Void.
+ */
+void NetworkScanClass::request()
+{
+	if (!_valid || (millis() - _scannedAt) >= SCAN_CACHE_TTL)
+	{
+		_pending = true;
+	}
+}
+
+/** @brief Ask for a scan whatever the age of the kept networks, at most one per SCAN_MIN_INTERVAL.
+ *  @return Void.
+ */
+void NetworkScanClass::refresh()
+{
+	if (!_valid || (millis() - _scannedAt) >= SCAN_MIN_INTERVAL)
+	{
+		_pending = true;
+	}
+}
+
+/** @brief Start the scan asked for and collect its result, called from the main loop.
+ *  @param suppressed bool, An upload or a flash job is running, no scan is started.
+ *  @return Void.
+ */
+void NetworkScanClass::handle(bool suppressed)
+{
+	unsigned long NowL = millis();
+
+	// Chunked uploads leave gaps between the requests, the quiet time covers them.
+	if (suppressed)
+	{
+		_suppressedAt = NowL;
+	}
+	_suppressed = suppressed || (_suppressedAt != 0 && (NowL - _suppressedAt) < SCAN_QUIET_TIME);
+
+	if (_scanning)
+	{
+		int FoundL = WiFi.scanComplete();
+		if (FoundL == WIFI_SCAN_RUNNING)
+		{
+			return;
+		}
+
+		_scanning = false;
+
+		// A failed scan keeps the last networks.
+		if (FoundL >= 0)
+		{
+			store(FoundL);
+		}
+		WiFi.scanDelete();
+
+		DEBUGLOG("Scan done: %d\r\n", FoundL);
+		return;
+	}
+
+	if (!_pending || _suppressed)
+	{
+		return;
+	}
+
+	_pending = false;
+	_scanning = (WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING);
+
+	DEBUGLOG("Scan started: %d\r\n", _scanning);
+}
+
+/** @brief Check for a scan in progress.
+ *  @return bool, True while the radio scans.
+ */
+bool NetworkScanClass::isScanning()
+{
+	return _scanning;
+}
+
+/** @brief Check for a scan asked for and not started yet.
+ *  @return bool, True when a scan waits.
+ */
+bool NetworkScanClass::isPending()
+{
+	return _pending;
+}
+
+/** @brief Check for scans held back by a transfer.
+ *  @return bool, True while uploads or flashing hold the scans.
+ */
+bool NetworkScanClass::isSuppressed()
+{
+	return _suppressed;
+}
+
+/** @brief Get the count of the kept networks.
+ *  @return uint8, Count.
+ */
+uint8 NetworkScanClass::count()
+{
+	return _count;
+}
+
+/** @brief Get a kept network.
+ *  @param index uint8, Index of the network.
+ *  @return const ScanNetwork_t*, The network or NULL.
+ */
+const ScanNetwork_t* NetworkScanClass::network(uint8 index)
+{
+	if (index >= _count)
+	{
+		return NULL;
+	}
+
+	return &_networks[index];
+}
+
+/** @brief Get the age of the kept networks.
+ *  @return long, Age in ms, -1 before the first scan.
+ */
+long NetworkScanClass::age()
+{
+	if (!_valid)
+	{
+		return -1;
+	}
+
+	return millis() - _scannedAt;
+}
+
+/** @brief Keep the strongest networks of a finished scan.
+ *  @param found int, Networks found by the scan.
+ *  @return Void.
+ */
+void NetworkScanClass::store(int found)
+{
+	_count = 0;
+
+	for (int index = 0; index < found; index++)
+	{
+		int8 RSSIL = WiFi.RSSI(index);
+		uint8 SlotL = _count;
+
+		// When full the weakest kept network gives its place.
+		if (_count == SCAN_NETWORKS)
+		{
+			SlotL = 0;
+			for (uint8 kept = 1; kept < _count; kept++)
+			{
+				if (_networks[kept].RSSI < _networks[SlotL].RSSI)
+				{
+					SlotL = kept;
+				}
+			}
+
+			if (_networks[SlotL].RSSI >= RSSIL)
+			{
+				continue;
+			}
+		}
+		else
+		{
+			_count++;
+		}
+
+		ScanNetwork_t* NetworkL = &_networks[SlotL];
+		strlcpy(NetworkL->SSID, WiFi.SSID(index).c_str(), sizeof(NetworkL->SSID));
+		memcpy(NetworkL->BSSID, WiFi.BSSID(index), sizeof(NetworkL->BSSID));
+		NetworkL->RSSI = RSSIL;
+		NetworkL->Channel = WiFi.channel(index);
+		NetworkL->Encryption = WiFi.encryptionType(index);
+		NetworkL->Hidden = WiFi.isHidden(index);
+	}
+
+	_valid = true;
+	_scannedAt = millis();
+}
+
+#pragma endregion
+
+/* @brief Singelton WiFi scan instance. */
+NetworkScanClass NetworkScan;
@@ -0,0 +1,158 @@
+// NetworkScan.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _NETWORKSCAN_h
+#define _NETWORKSCAN_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <ESP8266WiFi.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Network found by a scan.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	char SSID[33]; ///< Name of the network.
+	uint8 BSSID[6]; ///< MAC address of the access point.
+	int8 RSSI; ///< Signal strength in dBm.
+	uint8 Channel; ///< WiFi channel.
+	uint8 Encryption; ///< Encryption type of the SDK.
+	bool Hidden; ///< The network does not broadcast its name.
+} ScanNetwork_t;
+
+#pragma endregion
+
+/** @brief One scheduler of the WiFi scans with the last result kept.
+ *
+ *  The API reads the kept networks and only asks for a scan when they
+ *  are older than SCAN_CACHE_TTL. The scan itself starts from the main
+ *  loop and waits while an upload or a flash job runs, a scan takes
+ *  the radio off the channel for seconds.
+ */
+class NetworkScanClass
+{
+public:
+
+	/** @brief Ask for a scan when the kept networks are older than SCAN_CACHE_TTL.
+	 *  @return Void.
+	 */
+	void request();
+
+	/** @brief Ask for a scan whatever the age of the kept networks, at most one per SCAN_MIN_INTERVAL.
+	 *  @return Void.
+	 */
+	void refresh();
+
+	/** @brief Start the scan asked for and collect its result, called from the main loop.
+	 *  @param suppressed bool, An upload or a flash job is running, no scan is started.
+	 *  @return Void.
+	 */
+	void handle(bool suppressed);
+
+	/** @brief Check for a scan in progress.
+	 *  @return bool, True while the radio scans.
+	 */
+	bool isScanning();
+
+	/** @brief Check for a scan asked for and not started yet.
+	 *  @return bool, True when a scan waits.
+	 */
+	bool isPending();
+
+	/** @brief Check for scans held back by a transfer.
+	 *  @return bool, True while uploads or flashing hold the scans.
+	 */
+	bool isSuppressed();
+
+	/** @brief Get the count of the kept networks.
+	 *  @return uint8, Count.
+	 */
+	uint8 count();
+
+	/** @brief Get a kept network.
+	 *  @param index uint8, Index of the network.
+	 *  @return const ScanNetwork_t*, The network or NULL.
+	 */
+	const ScanNetwork_t* network(uint8 index);
+
+	/** @brief Get the age of the kept networks.
+	 *  @return long, Age in ms, -1 before the first scan.
+	 */
+	long age();
+
+private:
+
+	/** @brief Keep the strongest networks of a finished scan.
+	 *  @param found int, Networks found by the scan.
+	 *  @return Void.
+	 */
+	void store(int found);
+
+	/* @brief Kept networks. */
+	ScanNetwork_t _networks[SCAN_NETWORKS];
+
+	/* @brief Count of the kept networks. */
+	uint8 _count = 0;
+
+	/* @brief A scan has finished once. */
+	bool _valid = false;
+
+	/* @brief Time of the last finished scan. */
+	unsigned long _scannedAt = 0;
+
+	/* @brief A scan is asked for. */
+	bool _pending = false;
+
+	/* @brief A scan is running. */
+	bool _scanning = false;
+
+	/* @brief Scans are held back. */
+	bool _suppressed = false;
+
+	/* @brief Last time the scans were held back. */
+	unsigned long _suppressedAt = 0;
+};
+
+/* @brief Singelton WiFi scan instance. */
+extern NetworkScanClass NetworkScan;
+
+#endif
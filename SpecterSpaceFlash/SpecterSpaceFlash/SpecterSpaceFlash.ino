@@ -32,6 +32,12 @@ SOFTWARE.
 #include "DebugPort.h"
 #include "ApplicationConfiguration.h"
 #include "LocalWebServer.h"
+#include "FlashJobs.h"
+#include "StreamFlash.h"
+#include "Storage.h"
+#include "ImageStore.h"
+#include "UploadSessions.h"
+#include "FileIndex.h"
 
 #include "STK500.h"
 #include "IntelHexParser.h"
@@ -176,11 +182,58 @@ void setup()
 
 	// Start the file system.
 	configure_file_system();
+
+	// Sizes and names of the served files, kept in RAM.
+	FileIndex.begin(Storage.fs());
+
+	// Load the device configuration, defaults on the first boot.
+	if (!load_device_configuration(Storage.fs()))
+	{
+		set_default_device_configuration(Storage.fs());
+	}
+
+	// Load the image manifest, older images are taken over.
+	ImageStore.begin(Storage.fs());
+
+	// Jobs read the images from the file system.
+	FlashJobs.begin(Storage.fs());
+
+	// Stream-through flashing may keep a copy of the image.
+	StreamFlash.begin(Storage.fs());
+
+	// Resume the uploads cut by a reset.
+	UploadSessions.begin(Storage.fs());
+
+	// Join the configured network, the access point is the way back in.
+	if (DeviceConfiguration.STASSID != "")
+	{
+		configure_to_sta();
+	}
+	if (WiFi.status() != WL_CONNECTED)
+	{
+		configure_to_ap();
+	}
+
+	// Programmer page, editor and API, all clients are served at once.
+	LocalWebServer.configure(Storage.fs());
 }
 
 void loop()
 {
+	// Run a slice of the current flash job.
+	FlashJobs.handle();
+
+	// Release the TCP window of the stream-through flashing.
+	StreamFlash.handle();
 
+	// Move a committed upload to the image store.
+	UploadSessions.handle();
+
+	// Pack a stored image a few lines at a time.
+	ImageStore.handle();
+
+	// Publish the job progress.
+	LocalWebServer.handle();
 }
 
 
@@ -217,7 +270,7 @@ void configure_file_system()
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	if (!SPIFFS.begin())
+	if (!Storage.begin())
 	{
 		DEBUGLOG("Can not load file system.\r\n");
 		for (;;) {}
@@ -226,7 +279,7 @@ void configure_file_system()
 #ifdef EANBLE_DEBUG_OUT
 
 	// List files
-	Dir dir = SPIFFS.openDir("/");
+	Dir dir = Storage.fs()->openDir("/");
 	while (dir.next()) {
 		String fileName = dir.fileName();
 		size_t fileSize = dir.fileSize();
@@ -235,6 +288,13 @@ void configure_file_system()
 	DEBUGLOG("\r\n");
 
 #endif // EANBLE_DEBUG_OUT
+
+#ifdef STORAGE_BENCHMARK
+
+	Storage.benchmark();
+	Storage.benchmarkWrites();
+
+#endif // STORAGE_BENCHMARK
 }
 
 #pragma region AP mode
@@ -53,11 +53,28 @@ void STK500Class::prepareTarget()
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
+	unsigned long MarkL = micros();
 	resetTarget();
+	MarkL = timePhase(PhaseReset, MarkL);
 	getSync();
+	MarkL = timePhase(PhaseSync, MarkL);
 	setProgParams();
 	setExtProgParams();
+	MarkL = timePhase(PhaseParams, MarkL);
 	enterProgMode();
+	timePhase(PhaseEnter, MarkL);
+}
+
+/** @brief Record the time since the mark in the flash timeline.
+ *  @param phase uint8, Timed phase.
+ *  @param mark unsigned long, micros() at the start of the phase.
+ *  @return unsigned long, micros() at the end of the phase.
+ */
+unsigned long STK500Class::timePhase(uint8 phase, unsigned long mark)
+{
+	unsigned long NowL = micros();
+	FlashTimeline.record(phase, NowL - mark);
+	return NowL;
 }
 
 /** @brief Flash page on specified address.
@@ -71,26 +88,197 @@ uint8 STK500Class::flashPage(uint8* address, uint8* data)
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	uint8 HeaderL[4] = { 0x64, 0x00, 0x80, 0x46 };
-	loadAddress(address[1], address[0]);
+	uint8 StateL = beginPage(address, data);
 
-	STK500_PORT.write(HeaderL, sizeof(HeaderL));
-	
-	for (int i = 0; i < 128; i++) 
+	while (StateL == StatusCodes::Busy)
 	{
-		STK500_PORT.write(data[i]);
+		StateL = pollPage();
 
 #if defined(ARDUINO_ARCH_ESP8266)
 		ESP.wdtFeed();
 #endif
 	}
-	STK500_PORT.write(0x20);
 
-	waitForSerialData(2, 1000);
+	return StateL;
+}
+
+/** @brief Start asynchronous flashing of a page.
+ *  The buffers must stay valid until pollPage() stops returning Busy.
+ *  @param uint8* address, Address of the page.
+ *  @param uint8* data, Data for the page.
+ *  @return uint8, Busy when the transfer has started.
+ *  @see StatusCodes.h
+ */
+uint8 STK500Class::beginPage(uint8* address, uint8* data)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	return startPage(address, data, false);
+}
+
+/** @brief Start asynchronous reading of a page.
+ *  The buffer must stay valid until pollPage() stops returning Busy.
+ *  @param uint8* address, Address of the page.
+ *  @param uint8* data, Buffer for the page.
+ *  @return uint8, Busy when the transfer has started.
+ *  @see StatusCodes.h
+ */
+uint8 STK500Class::beginReadPage(uint8* address, uint8* data)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	return startPage(address, data, true);
+}
+
+/** @brief Send the load address of an asynchronous page transfer.
+ *  @param uint8* address, Address of the page.
+ *  @param uint8* data, Page buffer.
+ *  @param bool read, Read the page instead of writing it.
+ *  @return uint8, Busy when the transfer has started.
+ *  @see StatusCodes.h
+ */
+uint8 STK500Class::startPage(uint8* address, uint8* data, bool read)
+{
+	if (_pageState != PageStates::PageIdle)
+	{
+		return StatusCodes::Error;
+	}
+
+	// Drop stale bytes so the replies line up with this page.
+	while (STK500_PORT.available())
+	{
+		STK500_PORT.read();
+	}
+
+	uint8 LoadL[4] = { CMD_LOAD_ADDRESS, address[1], address[0], CRC_EOP };
+	STK500_PORT.write(LoadL, sizeof(LoadL));
+
+	_pageData = data;
+	_pageIndex = 0;
+	_pageRead = read;
+	_pageTimestamp = millis();
+	_pageMark = micros();
+	_pageState = PageStates::PageLoadAddress;
+
+	return StatusCodes::Busy;
+}
+
+/** @brief Advance the asynchronous page transfer without blocking.
+ *  @return uint8, Busy while in progress, else the result of the page.
+ *  @see StatusCodes.h
+ */
+uint8 STK500Class::pollPage()
+{
+	// Called in a tight loop, so no function trace here.
+	uint8 StateL = StatusCodes::Busy;
+
+	switch (_pageState)
+	{
+	case PageStates::PageLoadAddress:
+		if (STK500_PORT.available() >= 2)
+		{
+			if (readReply() != StatusCodes::Ok)
+			{
+				StateL = StatusCodes::Error;
+				break;
+			}
+
+			if (_pageRead)
+			{
+				uint8 ReadL[5] = { CMD_READ_PAGE, 0x00, STK500_PAGE_SIZE, 0x46, CRC_EOP };
+				STK500_PORT.write(ReadL, sizeof(ReadL));
+				_pageTimestamp = millis();
+				_pageMark = timePhase(PhasePageTx, _pageMark);
+				_pageState = PageStates::PageReceive;
+				break;
+			}
+
+			uint8 HeaderL[4] = { CMD_PROG_PAGE, 0x00, STK500_PAGE_SIZE, 0x46 };
+			STK500_PORT.write(HeaderL, sizeof(HeaderL));
+			_pageTimestamp = millis();
+			_pageState = PageStates::PageTransmit;
+		}
+		break;
+
+	case PageStates::PageTransmit:
+	{
+		// Only fill what the TX FIFO can take, the caller uses the rest of the time.
+		int FreeL = STK500_PORT.availableForWrite();
+		int LeftL = STK500_PAGE_SIZE - _pageIndex;
+		int CountL = (FreeL < LeftL) ? FreeL : LeftL;
+
+		if (CountL > 0)
+		{
+			STK500_PORT.write(_pageData + _pageIndex, CountL);
+			_pageIndex += CountL;
+			_pageTimestamp = millis();
+		}
+
+		if (_pageIndex >= STK500_PAGE_SIZE && FreeL > CountL)
+		{
+			STK500_PORT.write(CRC_EOP);
+			_pageTimestamp = millis();
+			_pageMark = timePhase(PhasePageTx, _pageMark);
+			_pageState = PageStates::PageCommit;
+		}
+	}
+	break;
+
+	case PageStates::PageCommit:
+		if (STK500_PORT.available() >= 2)
+		{
+			StateL = readReply();
+		}
+		break;
+
+	case PageStates::PageReceive:
+		if (STK500_PORT.available() >= STK500_PAGE_SIZE + 2)
+		{
+			uint8 sync = STK500_PORT.read();
+			STK500_PORT.readBytes(_pageData, STK500_PAGE_SIZE);
+			uint8 ok = STK500_PORT.read();
+
+			StateL = (sync == RESPONSE_SYNC && ok == RESPONSE_OK) ? StatusCodes::Ok : StatusCodes::Error;
+		}
+		break;
+
+	default:
+		return StatusCodes::Error;
+	}
+
+	if (StateL == StatusCodes::Busy && (millis() - _pageTimestamp) > STK500_REPLY_TIMEOUT)
+	{
+		StateL = StatusCodes::TimeOut;
+	}
+
+	if (StateL != StatusCodes::Busy)
+	{
+		if (_pageState == PageStates::PageCommit || _pageState == PageStates::PageReceive)
+		{
+			timePhase(PhasePageWait, _pageMark);
+		}
+
+		_pageState = PageStates::PageIdle;
+		_pageData = NULL;
+	}
+
+	return StateL;
+}
+
+/** @brief Read the two byte reply of the bootloader.
+ *  @return uint8, State of the communication.
+ *  @see StatusCodes.h
+ */
+uint8 STK500Class::readReply()
+{
 	uint8 sync = STK500_PORT.read();
 	uint8 ok = STK500_PORT.read();
 
-	if (sync == RESPONSE_SYNC && RESPONSE_OK == 0x10)
+	if (sync == RESPONSE_SYNC && ok == RESPONSE_OK)
 	{
 		return StatusCodes::Ok;
 	}
@@ -153,7 +341,11 @@ uint8 STK500Class::exitProgMode()
 	DEBUGLOG(__PRETTY_FUNCTION__);
 	DEBUGLOG("\r\n");
 
-	return execCmd(CMD_EXIT_PROG_MODE);
+	unsigned long MarkL = micros();
+	uint8 StateL = execCmd(CMD_EXIT_PROG_MODE);
+	timePhase(PhaseExit, MarkL);
+
+	return StateL;
 }
 
 /** @brief Set external programming parametters.
@@ -39,15 +39,33 @@ SOFTWARE.
 
 #include "StatusCodes.h"
 
+#include "FlashTimeline.h"
+
 #define CMD_SYNC 0x30
 #define CMD_ENTER_PROG_MODE 0x50
 #define CMD_EXIT_PROG_MODE 0x51
 #define CMD_EXT_PROG_PARAMS 0x45
 #define CMD_PROG_PARAMS 0x42
 #define CMD_LOAD_ADDRESS 0x55
+#define CMD_PROG_PAGE 0x64
+#define CMD_READ_PAGE 0x74
+#define CRC_EOP 0x20
 #define RESPONSE_OK 0x10
 #define RESPONSE_SYNC 0x14
 
+/** @brief Time to wait for a reply from the bootloader in ms. */
+#define STK500_REPLY_TIMEOUT 1000
+
+/** @brief States of the asynchronous page transfer. */
+enum PageStates : uint8
+{
+	PageIdle = 0U, ///< No page in flight.
+	PageLoadAddress, ///< Waiting for the load address reply.
+	PageTransmit, ///< Feeding the page data to the UART.
+	PageCommit, ///< Waiting for the bootloader to write the page.
+	PageReceive, ///< Waiting for the page data from the bootloader.
+};
+
 class STK500Class
 {
 public:
@@ -70,6 +88,30 @@ public:
 	 */
 	uint8 flashPage(uint8* loadAddress, uint8* data);
 
+	/** @brief Start asynchronous flashing of a page.
+	 *  The buffers must stay valid until pollPage() stops returning Busy.
+	 *  @param uint8* address, Address of the page.
+	 *  @param uint8* data, Data for the page.
+	 *  @return uint8, Busy when the transfer has started.
+	 *  @see StatusCodes.h
+	 */
+	uint8 beginPage(uint8* address, uint8* data);
+
+	/** @brief Advance the asynchronous page transfer without blocking.
+	 *  @return uint8, Busy while in progress, else the result of the page.
+	 *  @see StatusCodes.h
+	 */
+	uint8 pollPage();
+
+	/** @brief Start asynchronous reading of a page.
+	 *  The buffer must stay valid until pollPage() stops returning Busy.
+	 *  @param uint8* address, Address of the page.
+	 *  @param uint8* data, Buffer for the page.
+	 *  @return uint8, Busy when the transfer has started.
+	 *  @see StatusCodes.h
+	 */
+	uint8 beginReadPage(uint8* address, uint8* data);
+
 	/** @brief Reset the target.
 	 *  @return Void.
 	 */
@@ -109,8 +151,29 @@ private:
 	uint8 sendBytes(uint8* bytes, int count);
 	uint8 waitForSerialData(int dataCount, int timeout);
 	int getFlashPageCount(uint8 flashData[][131]);
+	uint8 readReply();
+	uint8 startPage(uint8* address, uint8* data, bool read);
+	unsigned long timePhase(uint8 phase, unsigned long mark);
 
 	int _targetResetPin;
+
+	/* @brief State of the asynchronous page transfer. */
+	uint8 _pageState = PageStates::PageIdle;
+
+	/* @brief Data of the page in flight. */
+	uint8* _pageData = NULL;
+
+	/* @brief Bytes of the page already sent. */
+	int _pageIndex = 0;
+
+	/* @brief The page in flight is read from the target. */
+	bool _pageRead = false;
+
+	/* @brief Time of the last page transfer step. */
+	unsigned long _pageTimestamp = 0;
+
+	/* @brief micros() at the start of the current page phase. */
+	unsigned long _pageMark = 0;
 };
 
 /* @brief Singelton STK500 instance. */
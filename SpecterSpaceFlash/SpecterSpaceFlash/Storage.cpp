@@ -0,0 +1,371 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "Storage.h"
+
+#include "ImageStore.h"
+
+/** @brief Mount the backend, move the SPIFFS content on the first LittleFS boot.
+ *  @return bool, Successful mounting.
+ */
+bool StorageClass::begin()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+#if defined(STORAGE_LITTLEFS)
+
+	// Formatting on a failed mount would wipe the SPIFFS content before the move.
+	LittleFSConfig ConfigL;
+	ConfigL.setAutoFormat(false);
+	LittleFS.setConfig(ConfigL);
+
+	if (!LittleFS.begin() && !migrate())
+	{
+		return false;
+	}
+
+	_fileSystem = &LittleFS;
+
+#else
+
+	_fileSystem = &SPIFFS;
+
+#endif // STORAGE_LITTLEFS
+
+	DEBUGLOG("File system: %s\r\n", backendName());
+
+	return _fileSystem->begin();
+}
+
+/** @brief Unmount the backend.
+ *  @return Void.
+ */
+void StorageClass::end()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (_fileSystem != NULL)
+	{
+		_fileSystem->end();
+	}
+}
+
+/** @brief Get the mounted file system.
+ *  @return FS*, File system of the device.
+ */
+FS* StorageClass::fs()
+{
+	return _fileSystem;
+}
+
+/** @brief Name of the backend.
+ *  @return const char*, "SPIFFS" or "LittleFS".
+ */
+const char* StorageClass::backendName()
+{
+#if defined(STORAGE_LITTLEFS)
+	return "LittleFS";
+#else
+	return "SPIFFS";
+#endif // STORAGE_LITTLEFS
+}
+
+/** @brief Name of a listed entry relative to its directory.
+ *  SPIFFS lists full paths of a flat name space, LittleFS bare names.
+ *  @param dir Dir, Directory being listed.
+ *  @param directory String, Path the directory was opened with.
+ *  @return String, Bare name, empty for an entry outside the directory.
+ */
+String StorageClass::entryName(Dir& dir, const String& directory)
+{
+	String NameL = dir.fileName();
+	if (!NameL.startsWith("/"))
+	{
+		return NameL;
+	}
+
+	// A SPIFFS prefix also matches "/dirname", the slash is part of it.
+	String PrefixL = directory.endsWith("/") ? directory : directory + "/";
+	if (!NameL.startsWith(PrefixL))
+	{
+		return String();
+	}
+
+	return NameL.substring(PrefixL.length());
+}
+
+/** @brief Full path of a listed entry.
+ *  @param dir Dir, Directory being listed.
+ *  @param directory String, Path the directory was opened with.
+ *  @return String, Path with a leading "/", empty for an entry outside the directory.
+ */
+String StorageClass::entryPath(Dir& dir, const String& directory)
+{
+	String NameL = entryName(dir, directory);
+	if (NameL.length() == 0)
+	{
+		return NameL;
+	}
+
+	return (directory.endsWith("/") ? directory : directory + "/") + NameL;
+}
+
+#if defined(STORAGE_LITTLEFS)
+
+/** @brief Format LittleFS over SPIFFS keeping config.json.
+ *  @return bool, Successful move.
+ */
+bool StorageClass::migrate()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	String ConfigurationL = "";
+	String LostL = "";
+
+	// Both share the partition, only what fits in RAM survives the format.
+	SPIFFSConfig SpiffsConfigL;
+	SpiffsConfigL.setAutoFormat(false);
+	SPIFFS.setConfig(SpiffsConfigL);
+
+	if (SPIFFS.begin())
+	{
+		File FileL = SPIFFS.open(CONFIG_FILE, "r");
+		if (FileL)
+		{
+			ConfigurationL = FileL.readString();
+			FileL.close();
+		}
+
+		Dir DirL = SPIFFS.openDir(STREAM_FLASH_STORE_DIR);
+		while (DirL.next())
+		{
+			LostL += DirL.fileName() + "\n";
+		}
+
+		FileL = SPIFFS.open(IMAGE_STORE_INDEX, "r");
+		if (FileL)
+		{
+			ImageIndexHeader_t HeaderL;
+			ImageEntry_t EntryL;
+
+			if (FileL.read((uint8*)&HeaderL, sizeof(HeaderL)) == sizeof(HeaderL) &&
+				HeaderL.Magic == IMAGE_INDEX_MAGIC && HeaderL.RecordSize == sizeof(ImageEntry_t))
+			{
+				while (FileL.read((uint8*)&EntryL, sizeof(EntryL)) == sizeof(EntryL))
+				{
+					EntryL.Name[IMAGE_NAME_SIZE - 1] = '\0';
+					LostL += String(EntryL.Name) + "\n";
+				}
+			}
+
+			FileL.close();
+		}
+
+		SPIFFS.end();
+	}
+
+	DEBUGLOG("Formatting LittleFS\r\n");
+	if (!LittleFS.format() || !LittleFS.begin())
+	{
+		DEBUGLOG("Can not format LittleFS.\r\n");
+		return false;
+	}
+
+	if (ConfigurationL.length() > 0)
+	{
+		File FileL = LittleFS.open(CONFIG_FILE, "w");
+		if (FileL)
+		{
+			FileL.print(ConfigurationL);
+			FileL.close();
+		}
+	}
+
+	if (LostL.length() > 0)
+	{
+		File FileL = LittleFS.open(STORAGE_LOST_FILE, "w");
+		if (FileL)
+		{
+			FileL.print(LostL);
+			FileL.close();
+		}
+
+		DEBUGLOG("Images to upload again:\r\n%s", LostL.c_str());
+	}
+
+	LittleFS.end();
+
+	return true;
+}
+
+#endif // STORAGE_LITTLEFS
+
+#ifdef STORAGE_BENCHMARK
+
+/** @brief Time open, list and read with 50, 200 and 500 images, results go to the debug port.
+ *  @return Void.
+ */
+void StorageClass::benchmark()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	const uint16 CountsL[] = { 50, 200, 500 };
+	const uint8 SamplesL = 10;
+	uint8 BufferL[128];
+	uint16 CreatedL = 0;
+	char PathL[32];
+
+	memset(BufferL, ':', sizeof(BufferL));
+
+	for (uint8 step = 0; step < sizeof(CountsL) / sizeof(CountsL[0]); step++)
+	{
+		// Top the image count up to the step.
+		for (; CreatedL < CountsL[step]; CreatedL++)
+		{
+			snprintf(PathL, sizeof(PathL), "/bench/%u.hex", CreatedL);
+			File FileL = _fileSystem->open(PathL, "w");
+			if (!FileL)
+			{
+				DEBUGLOG("Benchmark stopped, file system full at %u images.\r\n", CreatedL);
+				break;
+			}
+
+			for (uint16 size = 0; size < STORAGE_BENCHMARK_FILE_SIZE; size += sizeof(BufferL))
+			{
+				FileL.write(BufferL, sizeof(BufferL));
+			}
+			FileL.close();
+
+#if defined(ARDUINO_ARCH_ESP8266)
+			ESP.wdtFeed();
+#endif
+		}
+
+		if (CreatedL < CountsL[step])
+		{
+			break;
+		}
+
+		unsigned long OpenL = 0;
+		unsigned long ReadL = 0;
+		unsigned long MarkL = 0;
+
+		for (uint8 sample = 0; sample < SamplesL; sample++)
+		{
+			snprintf(PathL, sizeof(PathL), "/bench/%u.hex", (uint16)((CreatedL - 1) * sample / (SamplesL - 1)));
+
+			MarkL = micros();
+			File FileL = _fileSystem->open(PathL, "r");
+			OpenL += micros() - MarkL;
+
+			MarkL = micros();
+			while (FileL.read(BufferL, sizeof(BufferL)) > 0) {}
+			ReadL += micros() - MarkL;
+			FileL.close();
+		}
+
+		uint16 ListedL = 0;
+		MarkL = micros();
+		Dir DirL = _fileSystem->openDir("/bench");
+		while (DirL.next())
+		{
+			DirL.fileSize();
+			ListedL++;
+		}
+		unsigned long ListL = micros() - MarkL;
+
+		DEBUGLOG("%s %u images: open %lu us, read %lu us, list %lu us (%u entries)\r\n",
+			backendName(), CreatedL, OpenL / SamplesL, ReadL / SamplesL, ListL, ListedL);
+	}
+
+	for (uint16 index = 0; index < CreatedL; index++)
+	{
+		snprintf(PathL, sizeof(PathL), "/bench/%u.hex", index);
+		_fileSystem->remove(PathL);
+
+#if defined(ARDUINO_ARCH_ESP8266)
+		ESP.wdtFeed();
+#endif
+	}
+}
+
+/** @brief Time an upload written chunk by chunk and through BlockWriter, results go to the debug port.
+ *  @return Void.
+ */
+void StorageClass::benchmarkWrites()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	// A full TCP segment, as AsyncWebServer hands them to the upload handlers.
+	const size_t ChunkL = 1460;
+	const uint32 TotalL = 64UL * 1024UL;
+	uint8 BufferL[ChunkL];
+
+	memset(BufferL, ':', sizeof(BufferL));
+
+	for (uint8 coalesced = 0; coalesced < 2; coalesced++)
+	{
+		BlockWriter WriterL;
+		if (!WriterL.begin(_fileSystem->open("/bench.hex", "w"), coalesced ? STORAGE_WRITE_BLOCK : 0))
+		{
+			DEBUGLOG("Benchmark stopped, can not create the file.\r\n");
+			return;
+		}
+
+		unsigned long MarkL = millis();
+		for (uint32 written = 0; written < TotalL; written += ChunkL)
+		{
+			WriterL.write(BufferL, (TotalL - written < ChunkL) ? TotalL - written : ChunkL);
+
+#if defined(ARDUINO_ARCH_ESP8266)
+			ESP.wdtFeed();
+#endif
+		}
+		WriterL.close();
+		unsigned long ElapsedL = millis() - MarkL;
+
+		// SPIFFS and LittleFS do not expose erase counts, the file writes stand in for them.
+		DEBUGLOG("%s %s: %u bytes in %lu ms, %lu KB/s, %u chunks, %u file writes\r\n",
+			backendName(), coalesced ? "coalesced" : "direct", TotalL, ElapsedL,
+			(ElapsedL > 0) ? TotalL / ElapsedL : 0UL, WriterL.chunks(), WriterL.writes());
+
+		_fileSystem->remove("/bench.hex");
+	}
+}
+
+#endif // STORAGE_BENCHMARK
+
+/* @brief Singelton storage instance. */
+StorageClass Storage;
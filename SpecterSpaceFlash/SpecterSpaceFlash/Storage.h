@@ -0,0 +1,129 @@
+// Storage.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _STORAGE_h
+#define _STORAGE_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <FS.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "BlockWriter.h"
+
+#if defined(STORAGE_LITTLEFS)
+#include <LittleFS.h>
+#endif // STORAGE_LITTLEFS
+
+#include "DebugPort.h"
+
+#pragma endregion
+
+/** @brief File system backend of the device.
+ *
+ *  SPIFFS or LittleFS is selected at compile time with STORAGE_LITTLEFS,
+ *  the rest of the firmware only sees the FS interface.
+ */
+class StorageClass
+{
+public:
+
+	/** @brief Mount the backend, move the SPIFFS content on the first LittleFS boot.
+	 *  @return bool, Successful mounting.
+	 */
+	bool begin();
+
+	/** @brief Unmount the backend.
+	 *  @return Void.
+	 */
+	void end();
+
+	/** @brief Get the mounted file system.
+	 *  @return FS*, File system of the device.
+	 */
+	FS* fs();
+
+	/** @brief Name of the backend.
+	 *  @return const char*, "SPIFFS" or "LittleFS".
+	 */
+	const char* backendName();
+
+	/** @brief Name of a listed entry relative to its directory.
+	 *  SPIFFS lists full paths of a flat name space, LittleFS bare names.
+	 *  @param dir Dir, Directory being listed.
+	 *  @param directory String, Path the directory was opened with.
+	 *  @return String, Bare name, empty for an entry outside the directory.
+	 */
+	static String entryName(Dir& dir, const String& directory);
+
+	/** @brief Full path of a listed entry.
+	 *  @param dir Dir, Directory being listed.
+	 *  @param directory String, Path the directory was opened with.
+	 *  @return String, Path with a leading "/", empty for an entry outside the directory.
+	 */
+	static String entryPath(Dir& dir, const String& directory);
+
+#ifdef STORAGE_BENCHMARK
+
+	/** @brief Time open, list and read with 50, 200 and 500 images, results go to the debug port.
+	 *  @return Void.
+	 */
+	void benchmark();
+
+	/** @brief Time an upload written chunk by chunk and through BlockWriter, results go to the debug port.
+	 *  @return Void.
+	 */
+	void benchmarkWrites();
+
+#endif // STORAGE_BENCHMARK
+
+private:
+
+#if defined(STORAGE_LITTLEFS)
+
+	/** @brief Format LittleFS over SPIFFS keeping config.json.
+	 *  @return bool, Successful move.
+	 */
+	bool migrate();
+
+#endif // STORAGE_LITTLEFS
+
+	/* @brief Mounted file system. */
+	FS* _fileSystem = NULL;
+};
+
+/* @brief Singelton storage instance. */
+extern StorageClass Storage;
+
+#endif
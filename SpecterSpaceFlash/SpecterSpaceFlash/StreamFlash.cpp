@@ -0,0 +1,290 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "StreamFlash.h"
+
+/** @brief Attach the file system for the optional image copy.
+ *  @param fs FS*, File system.
+ *  @return Void.
+ */
+void StreamFlashClass::begin(FS* fs)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_fileSystem = fs;
+	_storePath[0] = '\0';
+}
+
+/** @brief Start a session for the request and queue its flash job.
+ *  @param request AsyncWebServerRequest*, Request carrying the image.
+ *  @param total size_t, Declared size of the body.
+ *  @return uint8, Ok, Busy when a session or the queue is busy, Error otherwise.
+ *  @see StatusCodes.h
+ */
+uint8 StreamFlashClass::open(AsyncWebServerRequest* request, size_t total)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (_ring != NULL)
+	{
+		return StatusCodes::Busy;
+	}
+
+	_storePath[0] = '\0';
+	String NameL = request->arg("store");
+
+	if (NameL.length() > 0)
+	{
+		String PathL = String(STREAM_FLASH_STORE_DIR) + "/" + NameL;
+		if (PathL.length() >= FLASH_JOB_PATH_SIZE)
+		{
+			return StatusCodes::Error;
+		}
+
+		if (!ImageStore.open(&_store, total))
+		{
+			return StatusCodes::Error;
+		}
+
+		strncpy(_storePath, PathL.c_str(), FLASH_JOB_PATH_SIZE - 1);
+		_storePath[FLASH_JOB_PATH_SIZE - 1] = '\0';
+	}
+
+	_ring = new RingStream(STREAM_FLASH_BUFFER_SIZE);
+
+	uint8 StateL = FlashJobs.enqueueStream(_ring, (_storePath[0] != '\0') ? _storePath : "stream", total, &_jobId);
+	if (StateL != StatusCodes::Ok)
+	{
+		if (_store.isOpen())
+		{
+			ImageStore.cancel(&_store);
+		}
+		release();
+		return StateL;
+	}
+
+	_request = request;
+	_client = request->client();
+	_pendingAck = 0;
+	_received = 0;
+	_consumed = 0;
+	_closed = false;
+
+	DEBUGLOG("Stream flash job %u, size %u\r\n", _jobId, total);
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Feed a body chunk.
+ *  @param request AsyncWebServerRequest*, Request carrying the image.
+ *  @param data uint8*, Chunk data.
+ *  @param len size_t, Chunk length.
+ *  @param index size_t, Offset of the chunk in the body.
+ *  @return Void.
+ */
+void StreamFlashClass::write(AsyncWebServerRequest* request, uint8* data, size_t len, size_t index)
+{
+	if (!owns(request) || _closed)
+	{
+		return;
+	}
+
+	if (_store.isOpen())
+	{
+		_store.write(data, len);
+	}
+
+	const FlashJob_t* JobL = FlashJobs.find(_jobId);
+	if (JobL == NULL || (JobL->State != JobStates::JobQueued && JobL->State != JobStates::JobRunning))
+	{
+		// Job is over, let the rest of the body through so the client gets the result.
+		return;
+	}
+
+	if (_ring->room() < len)
+	{
+		DEBUGLOG("Stream flash overflow.\r\n");
+		FlashJobs.cancel(_jobId, "Receive buffer overflow");
+		return;
+	}
+
+	_ring->write(data, len);
+	_received += len;
+
+	// The first chunk shares its segment with the headers, TCP already acknowledged it.
+	if (index > 0 && _client != NULL)
+	{
+		_client->ackLater();
+		_pendingAck += len;
+	}
+}
+
+/** @brief The body is complete.
+ *  @param request AsyncWebServerRequest*, Request carrying the image.
+ *  @return Void.
+ */
+void StreamFlashClass::close(AsyncWebServerRequest* request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (!owns(request))
+	{
+		return;
+	}
+
+	_closed = true;
+	FlashJobs.closeSource(_jobId);
+
+	if (_store.isOpen() && ImageStore.commit(&_store, _storePath, request->arg("mcu").c_str()) != StatusCodes::Ok)
+	{
+		_storePath[0] = '\0';
+	}
+}
+
+/** @brief The client went away, the server calls it for every request it closes.
+ *  @param request AsyncWebServerRequest*, Request carrying the image.
+ *  @return Void.
+ */
+void StreamFlashClass::abort(AsyncWebServerRequest* request)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (!owns(request))
+	{
+		return;
+	}
+
+	_request = NULL;
+	_client = NULL;
+	_pendingAck = 0;
+
+	if (_closed)
+	{
+		return;
+	}
+
+	_closed = true;
+	FlashJobs.cancel(_jobId, "Upload aborted");
+
+	if (_store.isOpen())
+	{
+		ImageStore.cancel(&_store);
+		_storePath[0] = '\0';
+	}
+}
+
+/** @brief Acknowledge consumed data and release finished sessions. Call it from the main loop.
+ *  @return Void.
+ */
+void StreamFlashClass::handle()
+{
+	if (_ring == NULL)
+	{
+		return;
+	}
+
+	const FlashJob_t* JobL = FlashJobs.find(_jobId);
+	bool FinishedL = (JobL == NULL || (JobL->State != JobStates::JobQueued && JobL->State != JobStates::JobRunning));
+
+	if (FinishedL)
+	{
+		// Nobody reads the ring any more, drop what is left.
+		while (_ring->available())
+		{
+			_ring->read();
+		}
+	}
+
+	uint32 ConsumedL = _received - _ring->available();
+	uint32 AckL = ConsumedL - _consumed;
+	_consumed = ConsumedL;
+
+	if (FinishedL || AckL > _pendingAck)
+	{
+		AckL = _pendingAck;
+	}
+
+	if (AckL > 0 && _client != NULL)
+	{
+		_client->ack(AckL);
+	}
+	_pendingAck -= AckL;
+
+	if (FinishedL && _closed)
+	{
+		release();
+	}
+}
+
+/** @brief Check if the session belongs to the request.
+ *  @param request AsyncWebServerRequest*, The request.
+ *  @return bool, True for the request of the running session.
+ */
+bool StreamFlashClass::owns(AsyncWebServerRequest* request)
+{
+	return _ring != NULL && request != NULL && _request == request;
+}
+
+/** @brief Job of the session.
+ *  @return uint16, Job ID.
+ */
+uint16 StreamFlashClass::jobId()
+{
+	return _jobId;
+}
+
+/** @brief Image name of the stored copy.
+ *  @return const char*, Path or empty string.
+ */
+const char* StreamFlashClass::storePath()
+{
+	return _storePath;
+}
+
+/** @brief Free the buffer and forget the session.
+ *  @return Void.
+ */
+void StreamFlashClass::release()
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	delete _ring;
+	_ring = NULL;
+	_jobId = 0;
+	_closed = false;
+}
+
+/* @brief Singelton stream flash instance. */
+StreamFlashClass StreamFlash;
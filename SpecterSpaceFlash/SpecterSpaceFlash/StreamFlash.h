@@ -0,0 +1,194 @@
+// StreamFlash.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _STREAMFLASH_h
+#define _STREAMFLASH_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <FS.h>
+#include <cbuf.h>
+#include <ESPAsyncTCP.h>
+#include <ESPAsyncWebServer.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#include "StatusCodes.h"
+
+#include "FlashJobs.h"
+
+#pragma endregion
+
+/** @brief Stream over a fixed ring buffer. */
+class RingStream : public Stream
+{
+public:
+
+	/** @brief Constructor.
+	 *  @param size size_t, Capacity in bytes.
+	 *  @return RingStream
+	 */
+	RingStream(size_t size) : _buffer(size) {}
+
+	int available() override { return _buffer.available(); }
+	int read() override { return _buffer.read(); }
+	int peek() override { return _buffer.peek(); }
+	void flush() override {}
+	size_t readBytes(char* buffer, size_t length) override { return _buffer.read(buffer, length); }
+	size_t write(uint8 data) override { return _buffer.write((char)data); }
+	size_t write(const uint8* data, size_t length) override { return _buffer.write((const char*)data, length); }
+
+	/** @brief Free space.
+	 *  @return size_t, Bytes that can be written.
+	 */
+	size_t room() { return _buffer.room(); }
+
+private:
+
+	/* @brief Ring buffer. */
+	cbuf _buffer;
+};
+
+/** @brief Stream-through flashing session.
+ *
+ *  Request body chunks go into a ring buffer read by a flash job.
+ *  TCP acknowledges are held back until the job consumed the data,
+ *  so the sender slows down to the speed of the UART.
+ */
+class StreamFlashClass
+{
+public:
+
+	/** @brief Attach the file system for the optional image copy.
+	 *  @param fs FS*, File system.
+	 *  @return Void.
+	 */
+	void begin(FS* fs);
+
+	/** @brief Start a session for the request and queue its flash job.
+	 *  @param request AsyncWebServerRequest*, Request carrying the image.
+	 *  @param total size_t, Declared size of the body.
+	 *  @return uint8, Ok, Busy when a session or the queue is busy, Error otherwise.
+	 *  @see StatusCodes.h
+	 */
+	uint8 open(AsyncWebServerRequest* request, size_t total);
+
+	/** @brief Feed a body chunk.
+	 *  @param request AsyncWebServerRequest*, Request carrying the image.
+	 *  @param data uint8*, Chunk data.
+	 *  @param len size_t, Chunk length.
+	 *  @param index size_t, Offset of the chunk in the body.
+	 *  @return Void.
+	 */
+	void write(AsyncWebServerRequest* request, uint8* data, size_t len, size_t index);
+
+	/** @brief The body is complete.
+	 *  @param request AsyncWebServerRequest*, Request carrying the image.
+	 *  @return Void.
+	 */
+	void close(AsyncWebServerRequest* request);
+
+	/** @brief The client went away, the server calls it for every request it closes.
+	 *  @param request AsyncWebServerRequest*, Request carrying the image.
+	 *  @return Void.
+	 */
+	void abort(AsyncWebServerRequest* request);
+
+	/** @brief Acknowledge consumed data and release finished sessions. Call it from the main loop.
+	 *  @return Void.
+	 */
+	void handle();
+
+	/** @brief Check if the session belongs to the request.
+	 *  @param request AsyncWebServerRequest*, The request.
+	 *  @return bool, True for the request of the running session.
+	 */
+	bool owns(AsyncWebServerRequest* request);
+
+	/** @brief Job of the session.
+	 *  @return uint16, Job ID.
+	 */
+	uint16 jobId();
+
+	/** @brief Image name of the stored copy.
+	 *  @return const char*, Path or empty string.
+	 */
+	const char* storePath();
+
+private:
+
+	/** @brief Free the buffer and forget the session.
+	 *  @return Void.
+	 */
+	void release();
+
+	/* @brief File system for the stored copy. */
+	FS* _fileSystem = NULL;
+
+	/* @brief Received data waiting for the job. */
+	RingStream* _ring = NULL;
+
+	/* @brief Request of the session. */
+	AsyncWebServerRequest* _request = NULL;
+
+	/* @brief Connection of the session. */
+	AsyncClient* _client = NULL;
+
+	/* @brief Stored copy of the image. */
+	ImageWriter _store;
+
+	/* @brief Image name of the stored copy. */
+	char _storePath[FLASH_JOB_PATH_SIZE];
+
+	/* @brief Job reading the ring. */
+	uint16 _jobId = 0;
+
+	/* @brief Bytes received but not acknowledged to TCP. */
+	uint32 _pendingAck = 0;
+
+	/* @brief Bytes written to the ring. */
+	uint32 _received = 0;
+
+	/* @brief Bytes consumed by the job. */
+	uint32 _consumed = 0;
+
+	/* @brief The body is complete. */
+	bool _closed = false;
+};
+
+/* @brief Singelton stream flash instance. */
+extern StreamFlashClass StreamFlash;
+
+#endif
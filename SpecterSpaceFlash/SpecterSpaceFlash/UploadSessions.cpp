@@ -0,0 +1,763 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "UploadSessions.h"
+
+#pragma region UploadSessionsClass
+
+/** @brief Load the sessions left in the file system.
+ *  @param fs FS*, File system.
+ *  @return Void.
+ */
+void UploadSessionsClass::begin(FS* fs)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	_fileSystem = fs;
+	memset(_sessions, 0, sizeof(_sessions));
+
+	String SessionsL = "";
+	String ChunksL = "";
+
+	// Names relative to the folder, SPIFFS lists full paths and LittleFS bare names.
+	Dir DirL = _fileSystem->openDir(UPLOAD_SESSION_DIR);
+	while (DirL.next())
+	{
+		String NameL = Storage.entryName(DirL, UPLOAD_SESSION_DIR);
+		if (NameL.length() == 0)
+		{
+			continue;
+		}
+
+		String PathL = String(UPLOAD_SESSION_DIR) + "/" + NameL;
+		if (NameL.indexOf('.') < 0)
+		{
+			SessionsL += PathL + "\n";
+		}
+		else
+		{
+			ChunksL += PathL + "\n";
+		}
+	}
+
+	int StartL = 0;
+	int EndL;
+	while ((EndL = SessionsL.indexOf('\n', StartL)) >= 0)
+	{
+		load(SessionsL.substring(StartL, EndL));
+		StartL = EndL + 1;
+	}
+
+	// Chunks without a session are left from a cut clean up.
+	StartL = 0;
+	while ((EndL = ChunksL.indexOf('\n', StartL)) >= 0)
+	{
+		String PathL = ChunksL.substring(StartL, EndL);
+		uint16 IdL = (uint16)PathL.substring(strlen(UPLOAD_SESSION_DIR) + 1).toInt();
+		if (lookup(IdL) == NULL)
+		{
+			_fileSystem->remove(PathL);
+		}
+		StartL = EndL + 1;
+	}
+}
+
+/** @brief Create a session, the least recently used one is dropped when all slots are taken.
+ *  @param name const char*, Image name to commit as.
+ *  @param mcu const char*, Target MCU, NULL for the default.
+ *  @param size uint32, Size of the image.
+ *  @param id uint16*, Session ID.
+ *  @return uint8, Ok, Busy when there is no room, Error for bad arguments.
+ *  @see StatusCodes.h
+ */
+uint8 UploadSessionsClass::create(const char* name, const char* mcu, uint32 size, uint16* id)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	if (mcu == NULL || mcu[0] == '\0')
+	{
+		mcu = IMAGE_DEFAULT_MCU;
+	}
+
+	if (name == NULL || name[0] == '\0' || strlen(name) >= IMAGE_NAME_SIZE ||
+		strlen(mcu) >= IMAGE_MCU_SIZE || size == 0 || size > UPLOAD_SESSION_MAX_SIZE)
+	{
+		return StatusCodes::Error;
+	}
+
+	UploadSession_t* SessionL = NULL;
+	UploadSession_t* OldestL = NULL;
+	for (uint8 index = 0; index < UPLOAD_SESSIONS && SessionL == NULL; index++)
+	{
+		UploadSession_t* SlotL = &_sessions[index];
+
+		if (SlotL->State != UploadStates::UploadOpen && SlotL->State != UploadStates::UploadCommitting)
+		{
+			SessionL = SlotL;
+		}
+		else if (SlotL->State == UploadStates::UploadOpen && SlotL->Id != _chunkSession &&
+			(OldestL == NULL || SlotL->UpdatedAt < OldestL->UpdatedAt))
+		{
+			OldestL = SlotL;
+		}
+	}
+
+	// An abandoned session gives way to the new one.
+	if (SessionL == NULL && OldestL != NULL)
+	{
+		DEBUGLOG("Drop upload session %u\r\n", OldestL->Id);
+		clean(OldestL);
+		SessionL = OldestL;
+	}
+
+	if (SessionL == NULL || !ImageStore.makeRoom(size))
+	{
+		return StatusCodes::Busy;
+	}
+
+	memset(SessionL, 0, sizeof(UploadSession_t));
+	SessionL->Id = _nextId++;
+	if (_nextId == 0)
+	{
+		_nextId = 1;
+	}
+	strncpy(SessionL->Name, name, IMAGE_NAME_SIZE - 1);
+	strncpy(SessionL->Mcu, mcu, IMAGE_MCU_SIZE - 1);
+	SessionL->Size = size;
+	SessionL->UpdatedAt = millis();
+
+	UploadSessionHeader_t HeaderL;
+	memset(&HeaderL, 0, sizeof(HeaderL));
+	HeaderL.Magic = UPLOAD_SESSION_MAGIC;
+	HeaderL.Id = SessionL->Id;
+	HeaderL.ChunkSize = UPLOAD_CHUNK_SIZE;
+	HeaderL.Size = size;
+	memcpy(HeaderL.Name, SessionL->Name, IMAGE_NAME_SIZE);
+	memcpy(HeaderL.Mcu, SessionL->Mcu, IMAGE_MCU_SIZE);
+
+	char PathL[IMAGE_NAME_SIZE];
+	sessionPath(SessionL->Id, PathL);
+
+	File FileL = _fileSystem->open(PathL, "w");
+	size_t WrittenL = FileL ? FileL.write((const uint8*)&HeaderL, sizeof(HeaderL)) : 0;
+	if (FileL)
+	{
+		FileL.close();
+	}
+
+	if (WrittenL != sizeof(HeaderL))
+	{
+		_fileSystem->remove(PathL);
+		memset(SessionL, 0, sizeof(UploadSession_t));
+		return StatusCodes::Error;
+	}
+
+	SessionL->State = UploadStates::UploadOpen;
+	*id = SessionL->Id;
+
+	DEBUGLOG("Upload session %u, %s, %u bytes\r\n", SessionL->Id, SessionL->Name, size);
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Feed a part of a chunk from a request body.
+ *  @param request AsyncWebServerRequest*, Request carrying the chunk.
+ *  @param id uint16, Session ID.
+ *  @param offset uint32, Offset of the chunk in the image.
+ *  @param data uint8*, Body data.
+ *  @param len size_t, Length of the data.
+ *  @param index size_t, Offset of the data in the body.
+ *  @param total size_t, Length of the body.
+ *  @return Void.
+ */
+void UploadSessionsClass::write(AsyncWebServerRequest* request, uint16 id, uint32 offset, uint8* data, size_t len, size_t index, size_t total)
+{
+	if (index == 0)
+	{
+		// One chunk at a time, the others are refused with Busy.
+		if (_chunkRequest != NULL && _chunkRequest != request)
+		{
+			return;
+		}
+
+		_chunkRequest = request;
+		_chunkState = StatusCodes::Error;
+
+		UploadSession_t* SessionL = lookup(id);
+		if (SessionL == NULL || SessionL->State != UploadStates::UploadOpen ||
+			(offset % UPLOAD_CHUNK_SIZE) != 0 || offset >= SessionL->Size)
+		{
+			return;
+		}
+
+		uint16 ChunkL = offset / UPLOAD_CHUNK_SIZE;
+		if (total != chunkLength(SessionL, ChunkL))
+		{
+			return;
+		}
+
+		// A chunk sent again replaces the old one.
+		SessionL->Received[ChunkL / 8] &= ~(1 << (ChunkL % 8));
+
+		char PathL[IMAGE_NAME_SIZE];
+		chunkPath(id, ChunkL, PathL);
+		if (!_chunkFile.begin(_fileSystem->open(PathL, "w")))
+		{
+			return;
+		}
+
+		_chunkSession = id;
+		_chunkIndex = ChunkL;
+		_chunkState = StatusCodes::Busy;
+	}
+
+	if (request != _chunkRequest || !_chunkFile)
+	{
+		return;
+	}
+
+	if (_chunkFile.write(data, len) != len)
+	{
+		DEBUGLOG("Write error in chunk %u\r\n", _chunkIndex);
+		_chunkFile.discard();
+		_chunkState = StatusCodes::Error;
+		return;
+	}
+
+	if (index + len < total)
+	{
+		return;
+	}
+
+	UploadSession_t* SessionL = lookup(_chunkSession);
+	if (!_chunkFile.close() || SessionL == NULL)
+	{
+		_chunkState = StatusCodes::Error;
+		return;
+	}
+
+	SessionL->Received[_chunkIndex / 8] |= (1 << (_chunkIndex % 8));
+	SessionL->UpdatedAt = millis();
+	_chunkState = StatusCodes::Ok;
+}
+
+/** @brief The client went away, the chunk in flight is dropped. The server calls it for every request it closes.
+ *  @param request AsyncWebServerRequest*, Request carrying the chunk.
+ *  @return Void.
+ */
+void UploadSessionsClass::abort(AsyncWebServerRequest* request)
+{
+	if (request != _chunkRequest)
+	{
+		return;
+	}
+
+	// The short file is not counted as received.
+	if (_chunkFile)
+	{
+		DEBUGLOG("Chunk %u of session %u cut\r\n", _chunkIndex, _chunkSession);
+		_chunkFile.discard();
+	}
+
+	_chunkRequest = NULL;
+	_chunkSession = 0;
+}
+
+/** @brief Result of the chunk carried by the request, forgets the request.
+ *  @param request AsyncWebServerRequest*, Request carrying the chunk.
+ *  @return uint8, Ok when the chunk is stored, Busy while another chunk is written, Error otherwise.
+ *  @see StatusCodes.h
+ */
+uint8 UploadSessionsClass::result(AsyncWebServerRequest* request)
+{
+	if (_chunkRequest == NULL)
+	{
+		return StatusCodes::Error;
+	}
+
+	if (request != _chunkRequest)
+	{
+		return StatusCodes::Busy;
+	}
+
+	uint8 StateL = _chunkState;
+	abort(request);
+
+	return (StateL == StatusCodes::Ok) ? StatusCodes::Ok : StatusCodes::Error;
+}
+
+/** @brief Check the hash and move the image to the store, runs from handle().
+ *  @param id uint16, Session ID.
+ *  @param md5 const char*, Expected MD5 of the image in hex.
+ *  @return uint8, Ok when started, Busy while chunks are missing, Error for a bad session or hash.
+ *  @see StatusCodes.h
+ */
+uint8 UploadSessionsClass::commit(uint16 id, const char* md5)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	UploadSession_t* SessionL = lookup(id);
+	if (SessionL == NULL || SessionL->State != UploadStates::UploadOpen ||
+		md5 == NULL || strlen(md5) != IMAGE_HASH_SIZE * 2)
+	{
+		return StatusCodes::Error;
+	}
+
+	if (missing(SessionL) > 0)
+	{
+		return StatusCodes::Busy;
+	}
+
+	strncpy(SessionL->Md5, md5, sizeof(SessionL->Md5) - 1);
+	SessionL->Error = NULL;
+	SessionL->State = UploadStates::UploadCommitting;
+	SessionL->UpdatedAt = millis();
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Drop a session and its chunks.
+ *  @param id uint16, Session ID.
+ *  @return uint8, Ok, Busy while committing, Error for an unknown session.
+ *  @see StatusCodes.h
+ */
+uint8 UploadSessionsClass::remove(uint16 id)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	UploadSession_t* SessionL = lookup(id);
+	if (SessionL == NULL)
+	{
+		return StatusCodes::Error;
+	}
+
+	if (SessionL->State == UploadStates::UploadCommitting)
+	{
+		return StatusCodes::Busy;
+	}
+
+	// The request in flight gets an error.
+	if (_chunkSession == id && _chunkFile)
+	{
+		_chunkFile.discard();
+		_chunkState = StatusCodes::Error;
+	}
+
+	clean(SessionL);
+	memset(SessionL, 0, sizeof(UploadSession_t));
+
+	return StatusCodes::Ok;
+}
+
+/** @brief Check for a chunk being written or a commit in progress.
+ *  @return bool, True while the sessions move data.
+ */
+bool UploadSessionsClass::isBusy()
+{
+	return (_chunkRequest != NULL) || (_committing != NULL);
+}
+
+/** @brief Run a step of the commit. Call it from the main loop.
+ *  @return Void.
+ */
+void UploadSessionsClass::handle()
+{
+	if (_committing == NULL)
+	{
+		for (uint8 index = 0; index < UPLOAD_SESSIONS && _committing == NULL; index++)
+		{
+			if (_sessions[index].State == UploadStates::UploadCommitting)
+			{
+				_committing = &_sessions[index];
+			}
+		}
+
+		if (_committing == NULL)
+		{
+			return;
+		}
+
+		_commitChunk = 0;
+		_verified = false;
+		_md5.begin();
+	}
+
+	uint16 ChunksL = chunks(_committing);
+
+	// One chunk per call, the loop stays responsive.
+	if (_commitChunk < ChunksL)
+	{
+		char PathL[IMAGE_NAME_SIZE];
+		chunkPath(_committing->Id, _commitChunk, PathL);
+
+		File FileL = _fileSystem->open(PathL, "r");
+		if (!FileL)
+		{
+			finishCommit(UploadStates::UploadFailed, "Chunk lost");
+			return;
+		}
+
+		uint8 BufferL[UPLOAD_COMMIT_BUFFER_SIZE];
+		bool FailedL = false;
+		int CountL;
+		while (!FailedL && (CountL = FileL.read(BufferL, sizeof(BufferL))) > 0)
+		{
+			if (!_verified)
+			{
+				_md5.add(BufferL, CountL);
+			}
+			else
+			{
+				FailedL = (_writer.write(BufferL, CountL) != (size_t)CountL);
+			}
+		}
+		FileL.close();
+
+		if (FailedL)
+		{
+			ImageStore.cancel(&_writer);
+			finishCommit(UploadStates::UploadFailed, "Write error");
+			return;
+		}
+
+		// Copied chunks go at once, so the image needs its size only once.
+		if (_verified)
+		{
+			_fileSystem->remove(PathL);
+		}
+
+		_commitChunk++;
+		return;
+	}
+
+	if (!_verified)
+	{
+		_md5.calculate();
+
+		// A mismatch keeps the chunks, the client may send them again.
+		if (!_md5.toString().equalsIgnoreCase(_committing->Md5))
+		{
+			DEBUGLOG("Upload session %u hash mismatch\r\n", _committing->Id);
+			_committing->State = UploadStates::UploadOpen;
+			_committing->Error = "Hash mismatch";
+			_committing = NULL;
+			return;
+		}
+
+		if (!ImageStore.open(&_writer, 0))
+		{
+			_committing->State = UploadStates::UploadOpen;
+			_committing->Error = "No room";
+			_committing = NULL;
+			return;
+		}
+
+		_verified = true;
+		_commitChunk = 0;
+		return;
+	}
+
+	uint8 StateL = ImageStore.commit(&_writer, _committing->Name, _committing->Mcu);
+	if (StateL != StatusCodes::Ok)
+	{
+		finishCommit(UploadStates::UploadFailed, "Store failed");
+		return;
+	}
+
+	finishCommit(UploadStates::UploadDone, NULL);
+}
+
+/** @brief Find a session.
+ *  @param id uint16, Session ID.
+ *  @return const UploadSession_t*, The session or NULL.
+ */
+const UploadSession_t* UploadSessionsClass::find(uint16 id)
+{
+	return lookup(id);
+}
+
+/** @brief Get a session slot.
+ *  @param index uint8, Slot index below UPLOAD_SESSIONS.
+ *  @return const UploadSession_t*, The session or NULL for a free slot.
+ */
+const UploadSession_t* UploadSessionsClass::slot(uint8 index)
+{
+	if (index >= UPLOAD_SESSIONS || _sessions[index].State == UploadStates::UploadFree)
+	{
+		return NULL;
+	}
+
+	return &_sessions[index];
+}
+
+/** @brief Chunks of a session.
+ *  @param session const UploadSession_t*, The session.
+ *  @return uint16, Chunk count.
+ */
+uint16 UploadSessionsClass::chunks(const UploadSession_t* session)
+{
+	return (session->Size + UPLOAD_CHUNK_SIZE - 1) / UPLOAD_CHUNK_SIZE;
+}
+
+/** @brief Check for a received chunk.
+ *  @param session const UploadSession_t*, The session.
+ *  @param chunk uint16, Chunk index.
+ *  @return bool, True when the chunk is complete.
+ */
+bool UploadSessionsClass::hasChunk(const UploadSession_t* session, uint16 chunk)
+{
+	return (session->Received[chunk / 8] & (1 << (chunk % 8))) != 0;
+}
+
+/** @brief Chunks still missing.
+ *  @param session const UploadSession_t*, The session.
+ *  @return uint16, Chunk count.
+ */
+uint16 UploadSessionsClass::missing(const UploadSession_t* session)
+{
+	uint16 MissingL = 0;
+
+	for (uint16 chunk = 0; chunk < chunks(session); chunk++)
+	{
+		if (!hasChunk(session, chunk))
+		{
+			MissingL++;
+		}
+	}
+
+	return MissingL;
+}
+
+/** @brief Name of a session state.
+ *  @param state uint8, Session state.
+ *  @return const char*, Name.
+ */
+const char* UploadSessionsClass::stateName(uint8 state)
+{
+	switch (state)
+	{
+	case UploadStates::UploadOpen: return "open";
+	case UploadStates::UploadCommitting: return "committing";
+	case UploadStates::UploadDone: return "done";
+	case UploadStates::UploadFailed: return "failed";
+	default: return "free";
+	}
+}
+
+/** @brief Find a session for changes.
+ *  @param id uint16, Session ID.
+ *  @return UploadSession_t*, The session or NULL.
+ */
+UploadSession_t* UploadSessionsClass::lookup(uint16 id)
+{
+	if (id == 0)
+	{
+		return NULL;
+	}
+
+	for (uint8 index = 0; index < UPLOAD_SESSIONS; index++)
+	{
+		if (_sessions[index].State != UploadStates::UploadFree && _sessions[index].Id == id)
+		{
+			return &_sessions[index];
+		}
+	}
+
+	return NULL;
+}
+
+/** @brief Load a session file and check its chunks.
+ *  @param path const String&, Session file.
+ *  @return Void.
+ */
+void UploadSessionsClass::load(const String& path)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	UploadSessionHeader_t HeaderL;
+	memset(&HeaderL, 0, sizeof(HeaderL));
+
+	File FileL = _fileSystem->open(path, "r");
+	if (FileL)
+	{
+		FileL.read((uint8*)&HeaderL, sizeof(HeaderL));
+		FileL.close();
+	}
+
+	UploadSession_t* SessionL = NULL;
+	for (uint8 index = 0; index < UPLOAD_SESSIONS && SessionL == NULL; index++)
+	{
+		if (_sessions[index].State == UploadStates::UploadFree)
+		{
+			SessionL = &_sessions[index];
+		}
+	}
+
+	// Chunks of another size can not be resumed, the orphans go in begin().
+	if (HeaderL.Magic != UPLOAD_SESSION_MAGIC || HeaderL.ChunkSize != UPLOAD_CHUNK_SIZE ||
+		HeaderL.Id == 0 || HeaderL.Size == 0 || HeaderL.Size > UPLOAD_SESSION_MAX_SIZE ||
+		lookup(HeaderL.Id) != NULL || SessionL == NULL)
+	{
+		DEBUGLOG("Drop upload session %s\r\n", path.c_str());
+		_fileSystem->remove(path);
+		return;
+	}
+
+	memset(SessionL, 0, sizeof(UploadSession_t));
+	SessionL->Id = HeaderL.Id;
+	memcpy(SessionL->Name, HeaderL.Name, IMAGE_NAME_SIZE - 1);
+	memcpy(SessionL->Mcu, HeaderL.Mcu, IMAGE_MCU_SIZE - 1);
+	SessionL->Size = HeaderL.Size;
+	SessionL->State = UploadStates::UploadOpen;
+
+	// A chunk cut by the reset is shorter than it should be.
+	char PathL[IMAGE_NAME_SIZE];
+	for (uint16 chunk = 0; chunk < chunks(SessionL); chunk++)
+	{
+		chunkPath(SessionL->Id, chunk, PathL);
+
+		File ChunkL = _fileSystem->open(PathL, "r");
+		if (!ChunkL)
+		{
+			continue;
+		}
+
+		if (ChunkL.size() == chunkLength(SessionL, chunk))
+		{
+			SessionL->Received[chunk / 8] |= (1 << (chunk % 8));
+		}
+		ChunkL.close();
+	}
+
+	if (SessionL->Id >= _nextId)
+	{
+		_nextId = SessionL->Id + 1;
+		if (_nextId == 0)
+		{
+			_nextId = 1;
+		}
+	}
+
+	DEBUGLOG("Upload session %u, %s, %u chunks missing\r\n", SessionL->Id, SessionL->Name, missing(SessionL));
+}
+
+/** @brief Remove the files of a session.
+ *  @param session UploadSession_t*, The session.
+ *  @return Void.
+ */
+void UploadSessionsClass::clean(UploadSession_t* session)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	char PathL[IMAGE_NAME_SIZE];
+
+	for (uint16 chunk = 0; chunk < chunks(session); chunk++)
+	{
+		chunkPath(session->Id, chunk, PathL);
+		if (_fileSystem->exists(PathL))
+		{
+			_fileSystem->remove(PathL);
+		}
+	}
+
+	sessionPath(session->Id, PathL);
+	_fileSystem->remove(PathL);
+}
+
+/** @brief Finish the running commit.
+ *  @param state uint8, Final state.
+ *  @param error const char*, Reason of a failure or NULL.
+ *  @return Void.
+ */
+void UploadSessionsClass::finishCommit(uint8 state, const char* error)
+{
+	DEBUGLOG("\r\n");
+	DEBUGLOG(__PRETTY_FUNCTION__);
+	DEBUGLOG("\r\n");
+
+	DEBUGLOG("Upload session %u %s\r\n", _committing->Id, stateName(state));
+
+	_committing->State = state;
+	_committing->Error = error;
+	_committing->UpdatedAt = millis();
+	clean(_committing);
+
+	_committing = NULL;
+}
+
+/** @brief Expected length of a chunk.
+ *  @param session const UploadSession_t*, The session.
+ *  @param chunk uint16, Chunk index.
+ *  @return uint32, Bytes, the last chunk may be short.
+ */
+uint32 UploadSessionsClass::chunkLength(const UploadSession_t* session, uint16 chunk)
+{
+	uint32 OffsetL = (uint32)chunk * UPLOAD_CHUNK_SIZE;
+	if (OffsetL >= session->Size)
+	{
+		return 0;
+	}
+
+	uint32 LeftL = session->Size - OffsetL;
+	return (LeftL < UPLOAD_CHUNK_SIZE) ? LeftL : UPLOAD_CHUNK_SIZE;
+}
+
+/** @brief Path of the session file.
+ *  @param id uint16, Session ID.
+ *  @param path char*, Buffer of IMAGE_NAME_SIZE characters.
+ *  @return Void.
+ */
+void UploadSessionsClass::sessionPath(uint16 id, char* path)
+{
+	snprintf(path, IMAGE_NAME_SIZE, "%s/%u", UPLOAD_SESSION_DIR, id);
+}
+
+/** @brief Path of a chunk file.
+ *  @param id uint16, Session ID.
+ *  @param chunk uint16, Chunk index.
+ *  @param path char*, Buffer of IMAGE_NAME_SIZE characters.
+ *  @return Void.
+ */
+void UploadSessionsClass::chunkPath(uint16 id, uint16 chunk, char* path)
+{
+	snprintf(path, IMAGE_NAME_SIZE, "%s/%u.%u", UPLOAD_SESSION_DIR, id, chunk);
+}
+
+#pragma endregion
+
+/* @brief Singelton upload sessions instance. */
+UploadSessionsClass UploadSessions;
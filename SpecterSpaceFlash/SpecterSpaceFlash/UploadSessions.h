@@ -0,0 +1,316 @@
+// UploadSessions.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+
+#ifndef _UPLOADSESSIONS_h
+#define _UPLOADSESSIONS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include <FS.h>
+#include <MD5Builder.h>
+#include <ESPAsyncTCP.h>
+#include <ESPAsyncWebServer.h>
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#include "StatusCodes.h"
+
+#include "ImageStore.h"
+
+#include "Storage.h"
+
+#pragma endregion
+
+#pragma region Definitions
+
+/** @brief Magic number of the session file, "SSFU". */
+#define UPLOAD_SESSION_MAGIC 0x55465353UL
+
+/** @brief Largest image of a session. */
+#define UPLOAD_SESSION_MAX_SIZE ((uint32)UPLOAD_SESSION_CHUNKS * UPLOAD_CHUNK_SIZE)
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Life cycle of an upload session. */
+enum UploadStates : uint8
+{
+	UploadFree = 0U, ///< Slot is not used.
+	UploadOpen, ///< Receiving chunks.
+	UploadCommitting, ///< Checking the hash and moving the chunks to the image store.
+	UploadDone, ///< Stored in the image store.
+	UploadFailed, ///< Could not be stored, the chunks are gone.
+};
+
+/** @brief Resumable upload session.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint16 Id; ///< Session ID, never 0.
+	uint8 State; ///< Life cycle state.
+	char Name[IMAGE_NAME_SIZE]; ///< Image name to commit as.
+	char Mcu[IMAGE_MCU_SIZE]; ///< Target MCU.
+	uint32 Size; ///< Declared size of the image.
+	uint8 Received[(UPLOAD_SESSION_CHUNKS + 7) / 8]; ///< Bit per complete chunk.
+	char Md5[IMAGE_HASH_SIZE * 2 + 1]; ///< Expected hash given at the commit.
+	unsigned long UpdatedAt; ///< millis() of the last activity, 0 after a reboot.
+	const char* Error; ///< Reason of the last failure.
+} UploadSession_t;
+
+/** @brief Header of the session file, the chunks are files beside it.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	uint32 Magic; ///< UPLOAD_SESSION_MAGIC.
+	uint16 Id; ///< Session ID.
+	uint16 ChunkSize; ///< UPLOAD_CHUNK_SIZE at the creation.
+	uint32 Size; ///< Declared size of the image.
+	char Name[IMAGE_NAME_SIZE]; ///< Image name.
+	char Mcu[IMAGE_MCU_SIZE]; ///< Target MCU.
+} UploadSessionHeader_t;
+
+#pragma endregion
+
+/** @brief Resumable chunked uploads into the image store.
+ *
+ *  Every chunk is a file of its own, a chunk counts as received
+ *  when its file has the full length. So the received ranges are
+ *  rebuilt from the file system after a reset and a broken link
+ *  only costs the chunk in flight.
+ */
+class UploadSessionsClass
+{
+public:
+
+	/** @brief Load the sessions left in the file system.
+	 *  @param fs FS*, File system.
+	 *  @return Void.
+	 */
+	void begin(FS* fs);
+
+	/** @brief Create a session, the least recently used one is dropped when all slots are taken.
+	 *  @param name const char*, Image name to commit as.
+	 *  @param mcu const char*, Target MCU, NULL for the default.
+	 *  @param size uint32, Size of the image.
+	 *  @param id uint16*, Session ID.
+	 *  @return uint8, Ok, Busy when there is no room, Error for bad arguments.
+	 *  @see StatusCodes.h
+	 */
+	uint8 create(const char* name, const char* mcu, uint32 size, uint16* id);
+
+	/** @brief Feed a part of a chunk from a request body.
+	 *  @param request AsyncWebServerRequest*, Request carrying the chunk.
+	 *  @param id uint16, Session ID.
+	 *  @param offset uint32, Offset of the chunk in the image.
+	 *  @param data uint8*, Body data.
+	 *  @param len size_t, Length of the data.
+	 *  @param index size_t, Offset of the data in the body.
+	 *  @param total size_t, Length of the body.
+	 *  @return Void.
+	 */
+	void write(AsyncWebServerRequest* request, uint16 id, uint32 offset, uint8* data, size_t len, size_t index, size_t total);
+
+	/** @brief The client went away, the chunk in flight is dropped. The server calls it for every request it closes.
+	 *  @param request AsyncWebServerRequest*, Request carrying the chunk.
+	 *  @return Void.
+	 */
+	void abort(AsyncWebServerRequest* request);
+
+	/** @brief Result of the chunk carried by the request, forgets the request.
+	 *  @param request AsyncWebServerRequest*, Request carrying the chunk.
+	 *  @return uint8, Ok when the chunk is stored, Busy while another chunk is written, Error otherwise.
+	 *  @see StatusCodes.h
+	 */
+	uint8 result(AsyncWebServerRequest* request);
+
+	/** @brief Check the hash and move the image to the store, runs from handle().
+	 *  @param id uint16, Session ID.
+	 *  @param md5 const char*, Expected MD5 of the image in hex.
+	 *  @return uint8, Ok when started, Busy while chunks are missing, Error for a bad session or hash.
+	 *  @see StatusCodes.h
+	 */
+	uint8 commit(uint16 id, const char* md5);
+
+	/** @brief Drop a session and its chunks.
+	 *  @param id uint16, Session ID.
+	 *  @return uint8, Ok, Busy while committing, Error for an unknown session.
+	 *  @see StatusCodes.h
+	 */
+	uint8 remove(uint16 id);
+
+	/** @brief Run a step of the commit. Call it from the main loop.
+	 *  @return Void.
+	 */
+	void handle();
+
+	/** @brief Check for a chunk being written or a commit in progress.
+	 *  @return bool, True while the sessions move data.
+	 */
+	bool isBusy();
+
+	/** @brief Find a session.
+	 *  @param id uint16, Session ID.
+	 *  @return const UploadSession_t*, The session or NULL.
+	 */
+	const UploadSession_t* find(uint16 id);
+
+	/** @brief Get a session slot.
+	 *  @param index uint8, Slot index below UPLOAD_SESSIONS.
+	 *  @return const UploadSession_t*, The session or NULL for a free slot.
+	 */
+	const UploadSession_t* slot(uint8 index);
+
+	/** @brief Chunks of a session.
+	 *  @param session const UploadSession_t*, The session.
+	 *  @return uint16, Chunk count.
+	 */
+	static uint16 chunks(const UploadSession_t* session);
+
+	/** @brief Check for a received chunk.
+	 *  @param session const UploadSession_t*, The session.
+	 *  @param chunk uint16, Chunk index.
+	 *  @return bool, True when the chunk is complete.
+	 */
+	static bool hasChunk(const UploadSession_t* session, uint16 chunk);
+
+	/** @brief Chunks still missing.
+	 *  @param session const UploadSession_t*, The session.
+	 *  @return uint16, Chunk count.
+	 */
+	static uint16 missing(const UploadSession_t* session);
+
+	/** @brief Name of a session state.
+	 *  @param state uint8, Session state.
+	 *  @return const char*, Name.
+	 */
+	static const char* stateName(uint8 state);
+
+private:
+
+	/** @brief Find a session for changes.
+	 *  @param id uint16, Session ID.
+	 *  @return UploadSession_t*, The session or NULL.
+	 */
+	UploadSession_t* lookup(uint16 id);
+
+	/** @brief Load a session file and check its chunks.
+	 *  @param path const String&, Session file.
+	 *  @return Void.
+	 */
+	void load(const String& path);
+
+	/** @brief Remove the files of a session.
+	 *  @param session UploadSession_t*, The session.
+	 *  @return Void.
+	 */
+	void clean(UploadSession_t* session);
+
+	/** @brief Finish the running commit.
+	 *  @param state uint8, Final state.
+	 *  @param error const char*, Reason of a failure or NULL.
+	 *  @return Void.
+	 */
+	void finishCommit(uint8 state, const char* error);
+
+	/** @brief Expected length of a chunk.
+	 *  @param session const UploadSession_t*, The session.
+	 *  @param chunk uint16, Chunk index.
+	 *  @return uint32, Bytes, the last chunk may be short.
+	 */
+	static uint32 chunkLength(const UploadSession_t* session, uint16 chunk);
+
+	/** @brief Path of the session file.
+	 *  @param id uint16, Session ID.
+	 *  @param path char*, Buffer of IMAGE_NAME_SIZE characters.
+	 *  @return Void.
+	 */
+	static void sessionPath(uint16 id, char* path);
+
+	/** @brief Path of a chunk file.
+	 *  @param id uint16, Session ID.
+	 *  @param chunk uint16, Chunk index.
+	 *  @param path char*, Buffer of IMAGE_NAME_SIZE characters.
+	 *  @return Void.
+	 */
+	static void chunkPath(uint16 id, uint16 chunk, char* path);
+
+	/* @brief File system of the sessions. */
+	FS* _fileSystem = NULL;
+
+	/* @brief Session slots. */
+	UploadSession_t _sessions[UPLOAD_SESSIONS];
+
+	/* @brief ID of the next session. */
+	uint16 _nextId = 1;
+
+	/* @brief Chunk file being written, the TCP segments go in as whole blocks. */
+	BlockWriter _chunkFile;
+
+	/* @brief Request writing the chunk file. */
+	AsyncWebServerRequest* _chunkRequest = NULL;
+
+	/* @brief Session of the chunk file. */
+	uint16 _chunkSession = 0;
+
+	/* @brief Index of the chunk file. */
+	uint16 _chunkIndex = 0;
+
+	/* @brief State of the chunk of _chunkRequest. */
+	uint8 _chunkState = StatusCodes::Error;
+
+	/* @brief Session being committed, NULL when idle. */
+	UploadSession_t* _committing = NULL;
+
+	/* @brief Next chunk of the commit, the hash pass runs before the copy pass. */
+	uint16 _commitChunk = 0;
+
+	/* @brief The hash pass is over. */
+	bool _verified = false;
+
+	/* @brief Hash of the hash pass. */
+	MD5Builder _md5;
+
+	/* @brief Destination of the copy pass. */
+	ImageWriter _writer;
+};
+
+/* @brief Singelton upload sessions instance. */
+extern UploadSessionsClass UploadSessions;
+
+#endif
@@ -0,0 +1,77 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "WebAssets.h"
+
+#include "WebAssetsData.h"
+
+#pragma region WebAssetsClass
+
+/** @brief Find an embedded file.
+ *  @param path const String&, URL path, "/" is the index.
+ *  @return const WebAsset_t*, The asset or NULL.
+ */
+const WebAsset_t* WebAssetsClass::find(const String& path)
+{
+	const char* PathL = (path == "/") ? "/index.htm" : path.c_str();
+
+	// The table is sorted by the generator.
+	int LowL = 0;
+	int HighL = WEB_ASSET_COUNT - 1;
+	while (LowL <= HighL)
+	{
+		int MiddleL = (LowL + HighL) / 2;
+		int OrderL = strcmp(PathL, WEB_ASSETS[MiddleL].Path);
+
+		if (OrderL == 0)
+		{
+			return &WEB_ASSETS[MiddleL];
+		}
+
+		if (OrderL < 0)
+		{
+			HighL = MiddleL - 1;
+		}
+		else
+		{
+			LowL = MiddleL + 1;
+		}
+	}
+
+	return NULL;
+}
+
+/** @brief Count of the embedded files.
+ *  @return uint8, Files.
+ */
+uint8 WebAssetsClass::count()
+{
+	return WEB_ASSET_COUNT;
+}
+
+#pragma endregion
+
+/* @brief Singelton web assets instance. */
+WebAssetsClass WebAssets;
@@ -0,0 +1,86 @@
+// WebAssets.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+
+#ifndef _WEBASSETS_h
+#define _WEBASSETS_h
+
+#if defined(ARDUINO) && ARDUINO >= 100
+	#include "arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#pragma region Headers
+
+#include "ApplicationConfiguration.h"
+
+#include "DebugPort.h"
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Web UI file embedded in the program flash.
+ *  @author Orlin Dimitrov <or.dimitrov@polygonteam.com>
+ *  @version 1.0
+ */
+typedef struct {
+	const char* Path; ///< URL path without the .gz ending.
+	const char* Mime; ///< Content type.
+	const char* ETag; ///< Quoted MD5 of the gzipped content.
+	const uint8* Data; ///< Gzipped content in PROGMEM.
+	uint32 Length; ///< Bytes of the content.
+} WebAsset_t;
+
+#pragma endregion
+
+/** @brief Web UI bundle generated from data/ by tools/embed_assets.py.
+ *
+ *  The UI is served from the program flash, so it needs no file system
+ *  lookups and keeps working with an empty or broken file system.
+ */
+class WebAssetsClass
+{
+public:
+
+	/** @brief Find an embedded file.
+	 *  @param path const String&, URL path, "/" is the index.
+	 *  @return const WebAsset_t*, The asset or NULL.
+	 */
+	const WebAsset_t* find(const String& path);
+
+	/** @brief Count of the embedded files.
+	 *  @return uint8, Files.
+	 */
+	uint8 count();
+};
+
+/* @brief Singelton web assets instance. */
+extern WebAssetsClass WebAssets;
+
+#endif
@@ -0,0 +1,155 @@
+// WebAssetsData.h
+
+// Generated by tools/embed_assets.py from data/, do not edit.
+
+#ifndef _WEBASSETSDATA_h
+#define _WEBASSETSDATA_h
+
+/* /index.htm, 2149 bytes gzipped. */
+static const uint8 WEB_ASSET_0[] PROGMEM = {
+	0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xED, 0x5A, 0x6D, 0x73, 0xDB, 0x36,
+	0x12, 0xFE, 0x4C, 0xFD, 0x0A, 0x14, 0x9D, 0x89, 0xA9, 0xB1, 0x44, 0xC9, 0x4E, 0xDC, 0xB9, 0xB3,
+	0x64, 0x75, 0x6C, 0xC7, 0xBD, 0xA4, 0xE3, 0xBC, 0x5C, 0xEC, 0xCC, 0xDD, 0x8C, 0x2F, 0x1F, 0x28,
+	0x12, 0x92, 0x38, 0xA1, 0x00, 0x96, 0x00, 0x25, 0xFB, 0x5A, 0xF7, 0xB7, 0xDF, 0x2E, 0x00, 0x82,
+	0xD4, 0xAB, 0x65, 0x3B, 0xED, 0x7D, 0xB8, 0xCB, 0x78, 0x42, 0x72, 0x81, 0x5D, 0xEC, 0xCB, 0xB3,
+	0xBB, 0x00, 0xEC, 0xFE, 0x44, 0x4D, 0xD3, 0x41, 0xA3, 0x3F, 0x61, 0x61, 0x0C, 0x0F, 0x95, 0xA8,
+	0x94, 0x0D, 0x4E, 0xF3, 0xB8, 0x48, 0xB8, 0x20, 0x1F, 0x73, 0x31, 0xCE, 0xC3, 0xE9, 0x94, 0xE5,
+	0xFD, 0x8E, 0x19, 0x69, 0x34, 0xFA, 0x52, 0xDD, 0xE9, 0x17, 0xEF, 0xFB, 0x7F, 0x1C, 0x76, 0xBB,
+	0xE4, 0x57, 0x12, 0x27, 0x32, 0x4B, 0xC3, 0xBB, 0x63, 0x92, 0xF0, 0x34, 0xE1, 0xAC, 0x3D, 0x4C,
+	0x45, 0xF4, 0xB5, 0x47, 0xE6, 0x49, 0xAC, 0x26, 0xC7, 0x04, 0xE6, 0x64, 0xB7, 0x3D, 0x32, 0x12,
+	0x5C, 0xB5, 0x65, 0xF2, 0x6F, 0x76, 0x4C, 0x0E, 0x5E, 0x21, 0xE1, 0x1E, 0x05, 0x1C, 0xEC, 0x20,
+	0xE0, 0x60, 0x9B, 0x80, 0xA3, 0x87, 0xF9, 0x8F, 0xB6, 0xB0, 0x83, 0x72, 0x67, 0x4F, 0xB6, 0x60,
+	0x28, 0xF2, 0x98, 0xE5, 0xED, 0xA1, 0x50, 0x4A, 0x4C, 0x81, 0x98, 0xDD, 0x12, 0x29, 0xD2, 0x24,
+	0x26, 0xC3, 0x34, 0x44, 0xF6, 0x69, 0x98, 0x8F, 0x13, 0x5E, 0x8E, 0xBF, 0x44, 0x16, 0x4B, 0x52,
+	0x22, 0x33, 0xDF, 0xA5, 0x13, 0xCE, 0x9E, 0xEC, 0x85, 0x6F, 0xA5, 0xC4, 0xD1, 0x0E, 0x3A, 0x1C,
+	0xFD, 0xA1, 0x2A, 0x9C, 0x8B, 0xE9, 0x34, 0xE4, 0xB1, 0x04, 0x35, 0x1E, 0x92, 0xF8, 0x80, 0xAB,
+	0x0E, 0xD7, 0xEB, 0x99, 0x85, 0x71, 0x9C, 0xF0, 0x71, 0x3B, 0x65, 0x23, 0x75, 0xFC, 0xB2, 0x5B,
+	0xD3, 0xA3, 0xA6, 0xDA, 0xAA, 0x66, 0xA0, 0xDA, 0x27, 0x31, 0xDF, 0xEC, 0x1C, 0xCB, 0xA1, 0xA5,
+	0x92, 0xA3, 0x9A, 0xD4, 0x3C, 0x19, 0x4F, 0x4A, 0x92, 0x16, 0x73, 0x1D, 0x0E, 0x53, 0x56, 0x17,
+	0xA4, 0x90, 0x60, 0xAC, 0xBF, 0x5E, 0x5A, 0x43, 0x0F, 0xB5, 0x73, 0x31, 0xB7, 0xC3, 0xE7, 0x2C,
+	0x4D, 0xDF, 0x8B, 0x7C, 0x1A, 0xA6, 0xAB, 0xB3, 0x22, 0x18, 0x73, 0xD6, 0xBF, 0xEA, 0xEE, 0x12,
+	0x13, 0x27, 0xF3, 0x0A, 0x24, 0x3E, 0x24, 0xF2, 0xF0, 0x68, 0x37, 0x91, 0x8D, 0x7E, 0xA7, 0x2C,
+	0x0E, 0xF8, 0x6E, 0x4A, 0x4A, 0xA3, 0x3F, 0x14, 0xF1, 0x1D, 0x3E, 0xE3, 0x64, 0x46, 0x92, 0xF8,
+	0x84, 0x16, 0x59, 0x2A, 0xC2, 0xF8, 0x5D, 0x98, 0x70, 0x4A, 0xF4, 0xFC, 0x13, 0x6A, 0x64, 0xAF,
+	0x11, 0x5A, 0x1A, 0xF5, 0xC3, 0x72, 0x48, 0xBB, 0xCB, 0xC1, 0x43, 0x3F, 0xD3, 0x41, 0xC3, 0x73,
+	0xCB, 0x80, 0x43, 0xF1, 0xBB, 0x22, 0x60, 0xB6, 0xD3, 0x41, 0x3F, 0xE1, 0x59, 0xA1, 0x88, 0xBA,
+	0xCB, 0x60, 0xDD, 0x51, 0x92, 0x32, 0xAA, 0x07, 0xF1, 0xAD, 0xAD, 0x87, 0x28, 0xE9, 0x0C, 0xFA,
+	0x1D, 0x60, 0x5A, 0x64, 0x3E, 0x02, 0xDE, 0x17, 0x7C, 0x28, 0xB3, 0xDE, 0x9A, 0x41, 0xC8, 0x4E,
+	0x4A, 0x78, 0x38, 0x65, 0xA5, 0x75, 0xAF, 0x93, 0x19, 0x1D, 0x7C, 0xD6, 0xAF, 0xDB, 0xA7, 0x47,
+	0x21, 0x07, 0x5F, 0xEB, 0xE9, 0xE7, 0xFA, 0xB5, 0x9C, 0x6E, 0x9F, 0xF6, 0x51, 0x79, 0xEF, 0x27,
+	0x50, 0x54, 0x3E, 0xDB, 0x79, 0x74, 0xB0, 0x22, 0x58, 0x17, 0x7B, 0x26, 0x9F, 0x2B, 0xDB, 0xE4,
+	0x5A, 0x2D, 0x8D, 0x4C, 0x02, 0xD8, 0xE4, 0x03, 0x30, 0x81, 0x24, 0xA4, 0xD0, 0xC1, 0xDB, 0x38,
+	0x65, 0x4E, 0x8B, 0x4E, 0x89, 0x12, 0x19, 0xE5, 0x49, 0xA6, 0xB0, 0xBF, 0xCC, 0xC2, 0x9C, 0x60,
+	0x58, 0x5E, 0x87, 0x2A, 0x24, 0x27, 0x84, 0x17, 0x00, 0xC9, 0x8A, 0x8A, 0xEE, 0xAB, 0xA8, 0x9D,
+	0x0E, 0xD2, 0x63, 0x36, 0x4B, 0x22, 0xF6, 0x39, 0x4F, 0x61, 0x80, 0x4E, 0x94, 0xCA, 0x8E, 0x3B,
+	0x9D, 0x83, 0xBF, 0x1E, 0x06, 0x07, 0x3F, 0xFC, 0x25, 0x38, 0x08, 0x5E, 0x1E, 0xD2, 0x9E, 0x67,
+	0x04, 0xAC, 0x9B, 0x48, 0xC9, 0x3E, 0x81, 0x8C, 0x0E, 0x55, 0x22, 0x78, 0x30, 0x11, 0x52, 0x81,
+	0xD8, 0x51, 0xC1, 0x23, 0xFC, 0x26, 0x92, 0xF1, 0x18, 0xF5, 0xF0, 0x9B, 0xE4, 0x57, 0x50, 0x4D,
+	0x0B, 0x41, 0x3E, 0xD4, 0x80, 0xCD, 0xC9, 0x3F, 0xDF, 0x5D, 0xBE, 0x81, 0xAF, 0x4F, 0xEC, 0x97,
+	0x82, 0x49, 0xE5, 0x37, 0x7B, 0x76, 0x4A, 0xA1, 0x57, 0xA8, 0x56, 0xDB, 0x27, 0xB4, 0x63, 0x00,
+	0xF2, 0x23, 0xDA, 0x70, 0x82, 0x6B, 0x32, 0x1E, 0x89, 0x98, 0x7D, 0xFE, 0xF4, 0x16, 0x0A, 0x60,
+	0x26, 0x38, 0xE3, 0xCA, 0x2F, 0xED, 0x6B, 0x5A, 0x31, 0x59, 0x08, 0x5D, 0x58, 0x82, 0xA4, 0xD2,
+	0x1D, 0x28, 0x1F, 0x97, 0x0F, 0x44, 0xC6, 0xB8, 0x4F, 0x3F, 0x7E, 0xB8, 0xBA, 0xA6, 0x2D, 0x5C,
+	0xAD, 0x45, 0x54, 0x5E, 0xB0, 0xA6, 0x1B, 0x47, 0xBD, 0x7D, 0xC3, 0x8E, 0x44, 0x2C, 0x43, 0xCE,
+	0x26, 0xA3, 0x08, 0xE2, 0x49, 0x5B, 0xE5, 0x79, 0x95, 0x91, 0xC8, 0x6F, 0x90, 0x69, 0x30, 0x6C,
+	0x28, 0x92, 0xA9, 0xEB, 0x64, 0xCA, 0x44, 0xA1, 0xFC, 0x31, 0x53, 0xC8, 0x78, 0x99, 0x48, 0xD5,
+	0xC2, 0x06, 0xD9, 0x5D, 0x91, 0x9E, 0x43, 0xF6, 0x5F, 0x41, 0xC4, 0x53, 0xA6, 0x57, 0x60, 0x66,
+	0x89, 0x32, 0x7A, 0x60, 0x0B, 0x0B, 0x14, 0x80, 0x84, 0xA9, 0x00, 0xBF, 0xE5, 0x4D, 0xF7, 0x0B,
+	0x2E, 0x51, 0x8B, 0x2C, 0xBE, 0x06, 0xF8, 0x8E, 0x41, 0xF3, 0x92, 0x11, 0xF1, 0xBF, 0x43, 0x12,
+	0xC8, 0x01, 0xD9, 0xAA, 0xC8, 0xB9, 0xAE, 0x62, 0x5A, 0x22, 0xAE, 0xC5, 0x72, 0x1B, 0x0B, 0x5C,
+	0xEE, 0x93, 0x26, 0x18, 0xAD, 0xCD, 0x60, 0x20, 0x38, 0x1A, 0x82, 0x72, 0xAD, 0x86, 0xA5, 0x4A,
+	0x5E, 0x0D, 0x63, 0x4E, 0x27, 0x48, 0x84, 0x22, 0x55, 0x3D, 0x0F, 0x97, 0xBE, 0xAF, 0x49, 0xC1,
+	0xC7, 0xA9, 0xBC, 0x66, 0xB7, 0x26, 0x48, 0x7A, 0x01, 0xF8, 0x61, 0xDC, 0xF8, 0xE9, 0x32, 0xE1,
+	0x5F, 0xA5, 0xBF, 0xE2, 0x8B, 0x9A, 0xB7, 0xFC, 0xCA, 0x0F, 0x4F, 0xC4, 0x8F, 0x76, 0x17, 0x85,
+	0x19, 0x8B, 0x18, 0xF8, 0xDB, 0xC5, 0x46, 0x08, 0x28, 0x2B, 0xF7, 0x8D, 0xF1, 0x0A, 0x3D, 0x87,
+	0x6C, 0x05, 0x98, 0xB5, 0xB1, 0x06, 0x02, 0x0F, 0x0D, 0xB3, 0x2C, 0x4D, 0x0C, 0xF0, 0x3B, 0xB7,
+	0xED, 0xF9, 0x7C, 0xDE, 0x1E, 0x41, 0xA7, 0x69, 0x83, 0x2C, 0x83, 0xCD, 0x98, 0x56, 0xD2, 0x04,
+	0x47, 0x17, 0xDC, 0x49, 0x15, 0x2A, 0x16, 0x4D, 0x42, 0x3E, 0x66, 0x75, 0x97, 0x5A, 0x8F, 0x26,
+	0x23, 0x5F, 0x4F, 0xD6, 0x53, 0xAF, 0x70, 0x2A, 0x39, 0x39, 0x21, 0xAF, 0xC8, 0x8B, 0x17, 0xC4,
+	0xA8, 0x04, 0xA4, 0x42, 0x22, 0x0D, 0xA0, 0x63, 0x79, 0x3C, 0x39, 0x11, 0x73, 0x5D, 0xDC, 0x4A,
+	0x5E, 0x09, 0xD9, 0x20, 0x19, 0xFA, 0x1A, 0x96, 0x27, 0xF0, 0x0F, 0x42, 0x41, 0x58, 0x2A, 0xD9,
+	0x32, 0xC3, 0x45, 0x9E, 0x0B, 0x1B, 0x6C, 0x0F, 0x21, 0x71, 0x6F, 0x82, 0x52, 0x25, 0xC0, 0x4A,
+	0x40, 0x62, 0x96, 0x32, 0x65, 0x80, 0xE9, 0x72, 0xED, 0xB9, 0x71, 0x31, 0x32, 0x77, 0xCB, 0xEB,
+	0xFF, 0x47, 0x6F, 0x7B, 0xF4, 0x96, 0x42, 0xE7, 0xD5, 0x63, 0x37, 0x4A, 0x43, 0x39, 0xF9, 0xB6,
+	0xA1, 0xD3, 0x22, 0xFF, 0x57, 0x23, 0x17, 0x8B, 0xA8, 0x98, 0x82, 0x5A, 0x01, 0x54, 0xA9, 0x8B,
+	0x94, 0xE1, 0xEB, 0xD9, 0xDD, 0xDB, 0xD8, 0xDF, 0xAB, 0x6F, 0x08, 0xF6, 0x9A, 0x41, 0xC2, 0x39,
+	0xCB, 0xDF, 0x5C, 0xBF, 0xBB, 0xC4, 0x9E, 0xF9, 0xF7, 0x82, 0x15, 0x2C, 0x26, 0xE8, 0xAD, 0xD2,
+	0x35, 0x2E, 0xCA, 0x3B, 0xC4, 0x10, 0x83, 0x5F, 0x8A, 0xAF, 0xB7, 0x06, 0x0C, 0xDE, 0xCF, 0x57,
+	0x1F, 0xDE, 0x07, 0xD0, 0xB2, 0x24, 0x34, 0x8D, 0x20, 0x86, 0xBA, 0xEC, 0x42, 0xA7, 0x00, 0x4C,
+	0x30, 0x21, 0x0B, 0xD0, 0x81, 0x18, 0x38, 0xF2, 0x3D, 0x2A, 0x90, 0x05, 0xB0, 0x2D, 0x81, 0xAF,
+	0x63, 0x62, 0xBE, 0xB2, 0x49, 0x28, 0x59, 0x4F, 0xF7, 0x0C, 0xDF, 0x7E, 0xA1, 0xC9, 0x34, 0x2F,
+	0x38, 0x87, 0x86, 0x44, 0xAD, 0xE1, 0x5A, 0xDA, 0x3E, 0xD0, 0x4B, 0xB6, 0x70, 0xCC, 0xE4, 0x6B,
+	0x08, 0xB7, 0x86, 0x04, 0xD2, 0x7C, 0x4B, 0xBC, 0x16, 0x0A, 0xB6, 0xDD, 0xBF, 0xFD, 0x46, 0xE8,
+	0x8F, 0xC0, 0x8C, 0xEB, 0x6A, 0x32, 0x44, 0x50, 0x3B, 0x10, 0x99, 0x87, 0x99, 0xD4, 0x03, 0x67,
+	0x1D, 0x49, 0xFC, 0x70, 0x36, 0xB6, 0x32, 0xE1, 0xED, 0xAC, 0x1A, 0x69, 0xB6, 0xC8, 0xC5, 0xF5,
+	0xA9, 0x1D, 0x62, 0xD0, 0x70, 0x90, 0xAE, 0x4B, 0xF9, 0x42, 0x6A, 0x6C, 0x55, 0xCC, 0x2C, 0x5D,
+	0xCA, 0xC0, 0xD4, 0xE9, 0x59, 0x7F, 0x3F, 0x25, 0x8E, 0xB8, 0xD4, 0x72, 0x6D, 0x4C, 0xA1, 0x4B,
+	0x31, 0xEE, 0xA2, 0x63, 0xBC, 0x05, 0xAE, 0xFC, 0x6E, 0x9E, 0xF0, 0x58, 0xCC, 0x83, 0x8B, 0x19,
+	0x48, 0xBE, 0x12, 0x45, 0x1E, 0xAD, 0xED, 0xC5, 0x52, 0x8F, 0xD8, 0x24, 0xAC, 0xCD, 0xF5, 0x17,
+	0x53, 0x2E, 0xCC, 0x92, 0xCE, 0xEC, 0xA0, 0xC3, 0x70, 0x82, 0x34, 0x38, 0x37, 0x9C, 0x01, 0x6C,
+	0x14, 0x35, 0xDB, 0xA5, 0xD6, 0x03, 0xF2, 0x66, 0x2F, 0xB3, 0xBA, 0xEC, 0xB5, 0x16, 0x80, 0xD3,
+	0x22, 0xA3, 0x10, 0x9C, 0xB6, 0xA9, 0xDB, 0xC2, 0xFE, 0xDF, 0xA5, 0x6D, 0x4B, 0xA3, 0x14, 0x37,
+	0xA8, 0x2D, 0x53, 0x3F, 0x54, 0x52, 0x2F, 0x1B, 0x70, 0xCC, 0xC2, 0x9A, 0x50, 0x3A, 0x30, 0x82,
+	0xFC, 0x51, 0xCC, 0xFA, 0xD0, 0xA7, 0xB0, 0x43, 0x35, 0x0A, 0xC2, 0x34, 0x84, 0x1A, 0x44, 0x06,
+	0xCF, 0x16, 0x25, 0x05, 0xB2, 0x18, 0x40, 0x7E, 0x3E, 0x49, 0xD2, 0x18, 0xB7, 0x45, 0xFA, 0x90,
+	0x87, 0x27, 0xAB, 0xDA, 0xE2, 0xE6, 0xE8, 0xD1, 0x6C, 0xEE, 0xC4, 0x62, 0xB4, 0x34, 0x87, 0x84,
+	0x8D, 0x2C, 0xE7, 0xD3, 0xF8, 0x43, 0xA6, 0x53, 0x9F, 0xFE, 0x84, 0xF6, 0x60, 0x39, 0xC1, 0x23,
+	0x4A, 0xCB, 0xA5, 0xA3, 0x61, 0x85, 0xB8, 0x39, 0x7B, 0xC9, 0x80, 0x94, 0x49, 0xBF, 0x55, 0x09,
+	0xFA, 0x3B, 0xA2, 0xEB, 0x5D, 0xA8, 0x26, 0x41, 0xC4, 0x92, 0xB4, 0x26, 0xA0, 0x83, 0xD7, 0x10,
+	0xDD, 0xA6, 0xC5, 0xAD, 0x5D, 0xD2, 0x2C, 0x54, 0x07, 0xF0, 0x76, 0x7D, 0xCD, 0x21, 0x6A, 0x93,
+	0xC2, 0xF7, 0x0F, 0xDA, 0xFB, 0x5A, 0xF7, 0xD9, 0xF5, 0xFC, 0x7A, 0xA3, 0x86, 0x78, 0xC4, 0x90,
+	0xAE, 0x54, 0x1D, 0xB4, 0x12, 0x00, 0x8F, 0xC0, 0xC0, 0x5B, 0xAF, 0xD3, 0x3C, 0x0F, 0xEF, 0x5A,
+	0x70, 0xF6, 0xD1, 0x2F, 0xDF, 0x00, 0x0D, 0x50, 0xBD, 0x7D, 0x14, 0x70, 0x0B, 0x44, 0x38, 0x9F,
+	0xDE, 0x92, 0x3E, 0x71, 0xEB, 0x04, 0xA0, 0xE4, 0x58, 0x4D, 0x80, 0xBA, 0xBF, 0xBF, 0x4B, 0x10,
+	0x1C, 0xE3, 0xCD, 0xED, 0x17, 0xA7, 0x23, 0xBC, 0x83, 0x95, 0x9E, 0xD9, 0x95, 0xAE, 0xD8, 0xBA,
+	0x5C, 0x60, 0xEB, 0xDD, 0x55, 0xAF, 0xB8, 0xB1, 0x42, 0xB8, 0x33, 0xE5, 0x72, 0x99, 0xBF, 0xB8,
+	0xFA, 0x48, 0x22, 0x01, 0x14, 0x23, 0x55, 0xD7, 0x9B, 0x80, 0xEA, 0x6D, 0xF1, 0x6A, 0x41, 0x37,
+	0xED, 0x3F, 0x9A, 0x49, 0xCC, 0xDC, 0xCA, 0x9D, 0x78, 0x57, 0x82, 0x67, 0x17, 0x3B, 0x10, 0x48,
+	0x68, 0x7A, 0xE0, 0xC7, 0x7F, 0x71, 0x5A, 0x22, 0x54, 0xCF, 0xB0, 0x0E, 0xC2, 0x4A, 0xDD, 0x6D,
+	0x6A, 0xFF, 0x3C, 0x5E, 0x5D, 0x1D, 0x05, 0xEB, 0x15, 0xBB, 0x77, 0x6F, 0x34, 0x9E, 0x26, 0xC8,
+	0xF3, 0x1A, 0x0B, 0x70, 0xA8, 0x61, 0xE7, 0x86, 0xF6, 0x87, 0x83, 0xF7, 0x80, 0x38, 0x38, 0xB4,
+	0x0E, 0x68, 0x0B, 0xBF, 0xAE, 0x20, 0x67, 0xAB, 0xAF, 0xF2, 0x26, 0x4B, 0x53, 0x20, 0x7A, 0x37,
+	0x3A, 0xFF, 0xCF, 0x60, 0x50, 0xDF, 0xF5, 0xC1, 0xB3, 0x9C, 0x41, 0xBF, 0x68, 0x1F, 0xEC, 0xA4,
+	0x60, 0x1D, 0x2A, 0xA0, 0x53, 0x79, 0xF4, 0xD0, 0x8D, 0x11, 0x1B, 0x14, 0xEA, 0xA0, 0x81, 0x57,
+	0x3B, 0x66, 0x9D, 0x8B, 0x82, 0xAB, 0x92, 0xB8, 0x06, 0x9E, 0x75, 0xCF, 0x1B, 0x68, 0x96, 0xFB,
+	0x08, 0x3D, 0x02, 0x78, 0x2B, 0xC3, 0xD2, 0x27, 0x47, 0xE5, 0x86, 0x01, 0x00, 0xA1, 0x12, 0x5E,
+	0x30, 0x0B, 0x44, 0x8D, 0x44, 0xCF, 0xAD, 0xB6, 0xBF, 0xAF, 0x83, 0x80, 0x0B, 0x31, 0x63, 0x0A,
+	0x06, 0xDF, 0x89, 0xB3, 0xD1, 0xEF, 0x99, 0xE0, 0x7B, 0x95, 0xE6, 0xD0, 0xF0, 0x74, 0xD3, 0x7F,
+	0x0B, 0x49, 0x56, 0x32, 0xDE, 0x1C, 0x18, 0xFF, 0x2C, 0xC6, 0xA1, 0x2C, 0xEE, 0x6E, 0x56, 0x17,
+	0x7C, 0x5C, 0x63, 0x69, 0xAD, 0x11, 0xF4, 0xF2, 0x4B, 0x13, 0x1B, 0x78, 0xD7, 0x88, 0x7B, 0x9A,
+	0xBF, 0x2B, 0x40, 0x6D, 0x80, 0x05, 0x04, 0xB6, 0xFA, 0x59, 0x1B, 0x77, 0xBC, 0x66, 0x5D, 0x7A,
+	0x3C, 0x0B, 0x01, 0x5B, 0x21, 0xAA, 0x59, 0x8F, 0xDD, 0x1E, 0xCD, 0x60, 0x01, 0x4A, 0x77, 0x05,
+	0x54, 0x1C, 0xAA, 0x45, 0xC0, 0x0D, 0x95, 0x25, 0x7A, 0xE5, 0xC5, 0x19, 0x65, 0x6D, 0x32, 0x46,
+	0x2C, 0xFC, 0xFF, 0x6C, 0x44, 0x2F, 0xF7, 0xF2, 0xAA, 0xF4, 0xBB, 0x14, 0xC5, 0x82, 0x58, 0x2B,
+	0xFC, 0xAE, 0xD4, 0xE0, 0xAD, 0xE5, 0x2E, 0xA5, 0x1B, 0xE7, 0x2D, 0x24, 0xBC, 0x7B, 0x77, 0xA3,
+	0xE5, 0xF5, 0x92, 0xDE, 0xD8, 0xEA, 0x8C, 0xA8, 0xCD, 0x87, 0x0A, 0x61, 0xBB, 0x90, 0xCD, 0x09,
+	0xCD, 0xB2, 0xBA, 0x71, 0x89, 0x60, 0x7B, 0xFF, 0x15, 0x76, 0x2D, 0xCE, 0x1C, 0x2C, 0xC4, 0x6B,
+	0x0F, 0x9F, 0xBD, 0x7B, 0xBB, 0x9B, 0x21, 0x06, 0xA1, 0x5A, 0xA0, 0xBE, 0x83, 0x0B, 0x22, 0x91,
+	0x0A, 0xBC, 0xDB, 0xA0, 0x67, 0x69, 0xC1, 0xE8, 0xCA, 0x68, 0x91, 0x4B, 0x33, 0xFC, 0x51, 0x24,
+	0x70, 0xBC, 0xC8, 0xEB, 0xDB, 0xC9, 0x15, 0xAD, 0xCD, 0x5E, 0xE1, 0x29, 0x4A, 0xAF, 0x39, 0x75,
+	0xFD, 0x49, 0x3A, 0x5B, 0xE8, 0xD5, 0x95, 0x16, 0x5C, 0x2B, 0x59, 0x3B, 0x01, 0x19, 0x25, 0xEF,
+	0x8D, 0x1C, 0x17, 0x61, 0xEC, 0xCE, 0x49, 0xDC, 0xAB, 0x3A, 0xA5, 0xBE, 0xD6, 0x5E, 0xB7, 0x2D,
+	0x70, 0x7D, 0x77, 0x01, 0x63, 0x7F, 0x08, 0xB2, 0x76, 0xD4, 0x6A, 0xE9, 0x4A, 0x69, 0x53, 0x03,
+	0x97, 0x67, 0x77, 0xD8, 0x8A, 0xFC, 0x3D, 0x77, 0xEF, 0xBC, 0xD7, 0x84, 0x82, 0xB8, 0xD8, 0xCE,
+	0x8C, 0x24, 0xDA, 0x7B, 0x9C, 0x88, 0x4D, 0xA1, 0x7C, 0xBC, 0x88, 0xB5, 0xF1, 0x7E, 0x84, 0x98,
+	0xCD, 0x20, 0xAD, 0xEE, 0x30, 0xDD, 0x69, 0xC0, 0x74, 0xEE, 0x6D, 0xD2, 0xDD, 0x9D, 0xFB, 0x1A,
+	0x57, 0x99, 0x4B, 0xF8, 0x07, 0x15, 0x5C, 0x12, 0xF1, 0x14, 0x57, 0xAD, 0x17, 0xF1, 0x68, 0x57,
+	0x2D, 0x89, 0xD9, 0xEC, 0xAA, 0xFA, 0x7D, 0x6E, 0xFD, 0xE8, 0xE4, 0xE1, 0x8D, 0x86, 0x83, 0xDD,
+	0xE2, 0xAD, 0xEF, 0xD6, 0x6D, 0x63, 0xFD, 0x77, 0x26, 0xCD, 0x60, 0x16, 0x82, 0xD1, 0x6E, 0x13,
+	0xF6, 0xDF, 0x07, 0x6B, 0x18, 0x7D, 0x7D, 0x2E, 0x5A, 0x4F, 0x0B, 0x25, 0x76, 0xB1, 0xE6, 0x4F,
+	0xC0, 0xD3, 0x2E, 0xD6, 0x3C, 0x00, 0xA8, 0xD2, 0x1A, 0x5D, 0x66, 0x36, 0xF6, 0xE7, 0x2A, 0xA6,
+	0xD8, 0xA0, 0x57, 0xC1, 0xA4, 0xAF, 0x9E, 0x00, 0x4D, 0x8B, 0xD7, 0xFB, 0x15, 0x9E, 0x1A, 0x9E,
+	0xBD, 0x26, 0x58, 0xB9, 0x6F, 0x37, 0x25, 0x7A, 0xE1, 0x2A, 0xBC, 0xB7, 0x72, 0xD9, 0xD0, 0xC3,
+	0x1A, 0xDE, 0xEF, 0xB8, 0x5F, 0x02, 0xF5, 0x3B, 0xE6, 0xEF, 0x13, 0xFE, 0x03, 0x82, 0xA4, 0x99,
+	0xE0, 0xA7, 0x20, 0x00, 0x00,
+};
+
+/** @brief Embedded assets, sorted by path. */
+static const WebAsset_t WEB_ASSETS[] = {
+	{ "/index.htm", "text/html", "\"b03559054115b82e4b13ab2a4653b30f\"", WEB_ASSET_0, 2149 },
+};
+
+/** @brief Count of the embedded assets. */
+#define WEB_ASSET_COUNT 1
+
+#endif
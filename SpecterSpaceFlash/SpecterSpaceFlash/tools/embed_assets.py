@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# Embed the web UI of data/ into WebAssetsData.h.
+#
+# Files with a .gz sibling are taken from it, the others are gzipped here.
+# Run it after every change of data/, the sketch builds from the header.
+#
+#   python3 tools/embed_assets.py [data_dir] [output_header]
+
+import gzip
+import hashlib
+import os
+import sys
+
+MIME_TYPES = {
+    ".htm": "text/html",
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".png": "image/png",
+    ".gif": "image/gif",
+    ".jpg": "image/jpeg",
+    ".ico": "image/x-icon",
+    ".svg": "image/svg+xml",
+    ".xml": "text/xml",
+    ".txt": "text/plain",
+}
+
+HEADER = """// WebAssetsData.h
+
+// Generated by tools/embed_assets.py from data/, do not edit.
+
+#ifndef _WEBASSETSDATA_h
+#define _WEBASSETSDATA_h
+
+"""
+
+FOOTER = """
+#endif
+"""
+
+
+def collect(data_dir):
+    """Path, MIME type and gzipped content of every asset, sorted by path."""
+    names = sorted(os.listdir(data_dir))
+    assets = []
+
+    for name in names:
+        full = os.path.join(data_dir, name)
+        if not os.path.isfile(full):
+            continue
+
+        if name.endswith(".gz"):
+            path = name[:-3]
+            with open(full, "rb") as source:
+                content = source.read()
+        elif name + ".gz" in names:
+            continue
+        else:
+            path = name
+            with open(full, "rb") as source:
+                # No time stamp, the output only changes with the content.
+                content = gzip.compress(source.read(), 9, mtime=0)
+
+        extension = os.path.splitext(path)[1].lower()
+        assets.append(("/" + path, MIME_TYPES.get(extension, "application/octet-stream"), content))
+
+    return assets
+
+
+def render(assets):
+    lines = [HEADER]
+
+    for index, (path, mime, content) in enumerate(assets):
+        lines.append("/* %s, %u bytes gzipped. */\n" % (path, len(content)))
+        lines.append("static const uint8 WEB_ASSET_%u[] PROGMEM = {\n" % index)
+        for offset in range(0, len(content), 16):
+            row = ", ".join("0x%02X" % byte for byte in content[offset:offset + 16])
+            lines.append("\t%s,\n" % row)
+        lines.append("};\n\n")
+
+    lines.append("/** @brief Embedded assets, sorted by path. */\n")
+    lines.append("static const WebAsset_t WEB_ASSETS[] = {\n")
+    for index, (path, mime, content) in enumerate(assets):
+        etag = hashlib.md5(content).hexdigest()
+        lines.append("\t{ \"%s\", \"%s\", \"\\\"%s\\\"\", WEB_ASSET_%u, %u },\n" % (path, mime, etag, index, len(content)))
+    lines.append("};\n\n")
+
+    lines.append("/** @brief Count of the embedded assets. */\n")
+    lines.append("#define WEB_ASSET_COUNT %u\n" % len(assets))
+    lines.append(FOOTER)
+
+    return "".join(lines)
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    data_dir = sys.argv[1] if len(sys.argv) > 1 else os.path.join(root, "data")
+    output = sys.argv[2] if len(sys.argv) > 2 else os.path.join(root, "WebAssetsData.h")
+
+    assets = collect(data_dir)
+    if not assets:
+        sys.exit("No assets in %s" % data_dir)
+
+    with open(output, "w", newline="\n") as target:
+        target.write(render(assets))
+
+    for path, mime, content in assets:
+        print("%-24s %-24s %6u bytes" % (path, mime, len(content)))
+
+
+if __name__ == "__main__":
+    main()
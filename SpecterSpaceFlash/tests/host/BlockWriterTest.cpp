@@ -0,0 +1,197 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include <vector>
+
+#include "BlockWriter.h"
+
+#include "HostTest.h"
+
+#pragma region Stubs
+
+/* @brief Debug port of the firmware. */
+NullPort Serial1;
+
+#pragma endregion
+
+#pragma region Helpers
+
+/* @brief File system of the tests. */
+static FS FileSystem_g;
+
+/** @brief Numbered bytes, a misplaced block shows in the content.
+ *  @param length size_t, Length.
+ *  @return std::vector<uint8>, Data.
+ */
+static std::vector<uint8> pattern(size_t length)
+{
+	std::vector<uint8> DataL(length);
+	for (size_t index = 0; index < length; index++)
+	{
+		DataL[index] = (uint8)(index * 7 + index / 251);
+	}
+	return DataL;
+}
+
+/** @brief Write the data in segments and close the file.
+ *  @param data const std::vector<uint8>&, Data.
+ *  @param segment size_t, Bytes per write.
+ *  @param block size_t, Block size, 0 for direct writes.
+ *  @param writer BlockWriter&, Writer, kept for its counters.
+ *  @return MemoryFile_t*, Written file.
+ */
+static MemoryFile_t* writeSegments(const std::vector<uint8>& data, size_t segment, size_t block, BlockWriter& writer)
+{
+	CHECK(writer.begin(FileSystem_g.open("/test", "w"), block));
+
+	for (size_t offset = 0; offset < data.size(); offset += segment)
+	{
+		size_t PartL = (data.size() - offset < segment) ? data.size() - offset : segment;
+		CHECK(writer.write(data.data() + offset, PartL) == PartL);
+	}
+
+	CHECK(writer.close());
+	CHECK(!writer);
+
+	return FileSystem_g.content("/test");
+}
+
+/** @brief Every write but the last one is a whole block.
+ *  @param file MemoryFile_t*, Written file.
+ *  @param block size_t, Block size.
+ *  @return bool, Block aligned.
+ */
+static bool isBlockAligned(MemoryFile_t* file, size_t block)
+{
+	for (size_t index = 0; index + 1 < file->Writes.size(); index++)
+	{
+		if (file->Writes[index] % block != 0)
+		{
+			return false;
+		}
+	}
+	return file->Writes.empty() || file->Writes.back() <= block;
+}
+
+#pragma endregion
+
+#pragma region Tests
+
+/** @brief TCP segments of 536 bytes, ten of them make five blocks and a tail. */
+static void testSmallSegments()
+{
+	std::vector<uint8> DataL = pattern(536 * 10);
+	BlockWriter WriterL;
+	MemoryFile_t* FileL = writeSegments(DataL, 536, 1024, WriterL);
+
+	CHECK(FileL->Data == DataL);
+	CHECK(WriterL.chunks() == 10);
+	CHECK(WriterL.writes() == 6);
+	CHECK(FileL->Writes.size() == 6);
+	CHECK(FileL->Writes.back() == 5360 - 5 * 1024);
+	CHECK(isBlockAligned(FileL, 1024));
+}
+
+/** @brief Segments of 1460 bytes, bigger than a block. */
+static void testLargeSegments()
+{
+	std::vector<uint8> DataL = pattern(1460 * 7);
+	BlockWriter WriterL;
+	MemoryFile_t* FileL = writeSegments(DataL, 1460, 1024, WriterL);
+
+	CHECK(FileL->Data == DataL);
+	CHECK(WriterL.chunks() == 7);
+	CHECK(WriterL.writes() == 10);
+	CHECK(FileL->Writes.back() == 10220 - 9 * 1024);
+	CHECK(isBlockAligned(FileL, 1024));
+}
+
+/** @brief Whole blocks to an empty buffer go out in one write. */
+static void testWholeBlocks()
+{
+	std::vector<uint8> DataL = pattern(4096);
+	BlockWriter WriterL;
+	MemoryFile_t* FileL = writeSegments(DataL, 4096, 1024, WriterL);
+
+	CHECK(FileL->Data == DataL);
+	CHECK(WriterL.writes() == 1);
+	CHECK(FileL->Writes.size() == 1 && FileL->Writes[0] == 4096);
+}
+
+/** @brief Without a buffer every segment is its own write. */
+static void testDirect()
+{
+	std::vector<uint8> DataL = pattern(536 * 5 + 100);
+	BlockWriter WriterL;
+	MemoryFile_t* FileL = writeSegments(DataL, 536, 0, WriterL);
+
+	CHECK(FileL->Data == DataL);
+	CHECK(WriterL.chunks() == 6);
+	CHECK(WriterL.writes() == 6);
+}
+
+/** @brief A short write fails the writer, later writes are refused. */
+static void testShortWrite()
+{
+	std::vector<uint8> DataL = pattern(4096);
+	BlockWriter WriterL;
+
+	CHECK(WriterL.begin(FileSystem_g.open("/test", "w"), 1024));
+	FileSystem_g.content("/test")->Capacity = 1500;
+
+	CHECK(WriterL.write(DataL.data(), 1000) == 1000);
+	CHECK(WriterL.write(DataL.data() + 1000, 1000) == 1000);
+	CHECK(WriterL.write(DataL.data() + 2000, 1000) < 1000);
+	CHECK(WriterL.write(DataL.data() + 3000, 100) == 0);
+	CHECK(!WriterL.close());
+}
+
+/** @brief Discard drops the buffered tail. */
+static void testDiscard()
+{
+	std::vector<uint8> DataL = pattern(1500);
+	BlockWriter WriterL;
+
+	CHECK(WriterL.begin(FileSystem_g.open("/test", "w"), 1024));
+	CHECK(WriterL.write(DataL.data(), DataL.size()) == DataL.size());
+	WriterL.discard();
+
+	CHECK(!WriterL);
+	CHECK(FileSystem_g.content("/test")->Data.size() == 1024);
+}
+
+#pragma endregion
+
+int main()
+{
+	testSmallSegments();
+	testLargeSegments();
+	testWholeBlocks();
+	testDirect();
+	testShortWrite();
+	testDiscard();
+
+	return report("BlockWriter");
+}
@@ -0,0 +1,296 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include <new>
+
+#include "HexLineReader.h"
+
+#include "IntelHexParser.h"
+
+#include "HostTest.h"
+
+#pragma region Allocation Counter
+
+/* @brief Heap allocations since the last reset of the counter. */
+static unsigned long Allocations_g = 0;
+
+extern "C" void* __real_malloc(size_t size);
+extern "C" void* __real_calloc(size_t count, size_t size);
+extern "C" void* __real_realloc(void* pointer, size_t size);
+
+extern "C" void* __wrap_malloc(size_t size)
+{
+	Allocations_g++;
+	return __real_malloc(size);
+}
+
+extern "C" void* __wrap_calloc(size_t count, size_t size)
+{
+	Allocations_g++;
+	return __real_calloc(count, size);
+}
+
+extern "C" void* __wrap_realloc(void* pointer, size_t size)
+{
+	Allocations_g++;
+	return __real_realloc(pointer, size);
+}
+
+void* operator new(size_t size)
+{
+	Allocations_g++;
+	void* PointerL = __real_malloc(size);
+	if (PointerL == NULL)
+	{
+		throw std::bad_alloc();
+	}
+	return PointerL;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, size_t size) noexcept
+{
+	(void)size;
+	free(pointer);
+}
+
+void operator delete[](void* pointer, size_t size) noexcept
+{
+	(void)size;
+	free(pointer);
+}
+
+#pragma endregion
+
+#pragma region Stubs
+
+/* @brief Debug port of the firmware. */
+NullPort Serial1;
+
+#pragma endregion
+
+#pragma region Helpers
+
+/** @brief Write an Intel HEX image of 16 byte records, CR LF line endings.
+ *  @param text char*, Destination.
+ *  @param size size_t, Size of the destination.
+ *  @param bytes uint32, Data bytes of the image.
+ *  @return size_t, Length of the text.
+ */
+static size_t makeImage(char* text, size_t size, uint32 bytes)
+{
+	size_t LengthL = 0;
+
+	for (uint32 address = 0; address < bytes; address += 16)
+	{
+		uint8 SumL = 16 + (address >> 8) + (address & 0xFF);
+		LengthL += snprintf(text + LengthL, size - LengthL, ":10%04X00", address);
+		for (uint8 index = 0; index < 16; index++)
+		{
+			uint8 ValueL = (uint8)(address + index);
+			SumL += ValueL;
+			LengthL += snprintf(text + LengthL, size - LengthL, "%02X", ValueL);
+		}
+		LengthL += snprintf(text + LengthL, size - LengthL, "%02X\r\n", (uint8)(0x100 - SumL));
+	}
+
+	LengthL += snprintf(text + LengthL, size - LengthL, ":00000001FF\r\n");
+
+	return LengthL;
+}
+
+/** @brief Read an image the way the flash pipeline does.
+ *  @param reader HexLineReader*, Line reader.
+ *  @param parser IntelHexParserClass*, Record parser.
+ *  @param source Stream*, The image.
+ *  @param pages uint32*, Flash pages found.
+ *  @return uint8, Ok at the end of file record, Error otherwise.
+ */
+static uint8 flashImage(HexLineReader* reader, IntelHexParserClass* parser, Stream* source, uint32* pages)
+{
+	reader->begin(source, true);
+	parser->Reset();
+	*pages = 0;
+
+	for (;;)
+	{
+		byte* LineL;
+		size_t LengthL;
+		uint8 StateL = reader->next(&LineL, &LengthL);
+
+		if (StateL == StatusCodes::Busy)
+		{
+			if (reader->isEnd())
+			{
+				return StatusCodes::Error;
+			}
+			continue;
+		}
+
+		if (StateL != StatusCodes::Ok)
+		{
+			return StateL;
+		}
+
+		if (LengthL < HEX_RECORD_MIN_LENGTH)
+		{
+			continue;
+		}
+
+		if (!parser->IsRecordValid(LineL, LengthL))
+		{
+			return StatusCodes::Error;
+		}
+
+		// The parser reads up to the checksum, it needs no terminator.
+		parser->ParseLine(LineL);
+
+		if (parser->IsPageReady())
+		{
+			parser->GetMemoryPage();
+			(*pages)++;
+		}
+
+		if (parser->IsEndOfFile())
+		{
+			return StatusCodes::Ok;
+		}
+	}
+}
+
+#pragma endregion
+
+#pragma region Tests
+
+/* @brief Image of 32 KB, the flash of an ATmega328P. */
+static char Image_g[96 * 1024];
+
+/** @brief A whole flash does not touch the heap, whatever the size of the reads.
+ *  @return Void.
+ */
+static void testFlashWithoutAllocations()
+{
+	size_t LengthL = makeImage(Image_g, sizeof(Image_g), 32768);
+
+	static HexLineReader ReaderL;
+	static IntelHexParserClass ParserL;
+
+	const size_t SlicesL[] = { 1, 7, 536, 1460, HEX_READER_BLOCK_SIZE, sizeof(Image_g) };
+	for (size_t index = 0; index < sizeof(SlicesL) / sizeof(SlicesL[0]); index++)
+	{
+		MemoryStream SourceL(Image_g, LengthL, SlicesL[index]);
+		uint32 PagesL = 0;
+
+		Allocations_g = 0;
+		uint8 StateL = flashImage(&ReaderL, &ParserL, &SourceL, &PagesL);
+		unsigned long AllocationsL = Allocations_g;
+
+		CHECK(StateL == StatusCodes::Ok);
+		CHECK(PagesL >= 32768 / 128);
+		CHECK(AllocationsL == 0);
+		CHECK(ReaderL.position() == LengthL);
+	}
+}
+
+/** @brief Line endings are cut, CR LF and LF alike, the last line may have none.
+ *  @return Void.
+ */
+static void testLineEndings()
+{
+	const char TextL[] = "abc\r\ndef\nghi";
+	MemoryStream SourceL(TextL, sizeof(TextL) - 1, 2);
+	HexLineReader ReaderL;
+	ReaderL.begin(&SourceL, true);
+
+	byte* LineL;
+	size_t LengthL;
+	CHECK(ReaderL.next(&LineL, &LengthL) == StatusCodes::Ok && LengthL == 3 && memcmp(LineL, "abc", 3) == 0);
+	CHECK(ReaderL.next(&LineL, &LengthL) == StatusCodes::Ok && LengthL == 3 && memcmp(LineL, "def", 3) == 0);
+	CHECK(ReaderL.next(&LineL, &LengthL) == StatusCodes::Ok && LengthL == 3 && memcmp(LineL, "ghi", 3) == 0);
+	CHECK(ReaderL.next(&LineL, &LengthL) == StatusCodes::Busy);
+	CHECK(ReaderL.isEnd());
+}
+
+/** @brief A source that is not finite waits for the rest of a line.
+ *  @return Void.
+ */
+static void testGrowingSource()
+{
+	const char TextL[] = "abc\ndef\n";
+	MemoryStream SourceL(TextL, 6, sizeof(TextL));
+	HexLineReader ReaderL;
+	ReaderL.begin(&SourceL, false);
+
+	byte* LineL;
+	size_t LengthL;
+	CHECK(ReaderL.next(&LineL, &LengthL) == StatusCodes::Ok && LengthL == 3);
+	CHECK(ReaderL.next(&LineL, &LengthL) == StatusCodes::Busy);
+	CHECK(!ReaderL.isEnd());
+
+	SourceL.grow(sizeof(TextL) - 1);
+	CHECK(ReaderL.next(&LineL, &LengthL) == StatusCodes::Ok && LengthL == 3 && memcmp(LineL, "def", 3) == 0);
+}
+
+/** @brief A line longer than the block is refused.
+ *  @return Void.
+ */
+static void testLongLine()
+{
+	static char TextL[HEX_READER_BLOCK_SIZE + 16];
+	memset(TextL, 'A', sizeof(TextL));
+	MemoryStream SourceL(TextL, sizeof(TextL), sizeof(TextL));
+	HexLineReader ReaderL;
+	ReaderL.begin(&SourceL, true);
+
+	byte* LineL;
+	size_t LengthL;
+	CHECK(ReaderL.next(&LineL, &LengthL) == StatusCodes::Error);
+}
+
+#pragma endregion
+
+int main()
+{
+	testFlashWithoutAllocations();
+	testLineEndings();
+	testGrowingSource();
+	testLongLine();
+
+	return report("HexLineReader");
+}
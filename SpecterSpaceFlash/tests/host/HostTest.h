@@ -0,0 +1,119 @@
+// HostTest.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _HOSTTEST_h
+#define _HOSTTEST_h
+
+/** @brief Checks shared by the host tests, each test is its own program. */
+
+#pragma region Headers
+
+#include <stdio.h>
+
+#include "arduino.h"
+
+#pragma endregion
+
+#pragma region Definitions
+
+/* @brief Failed checks of the program. */
+static int Failures_g = 0;
+
+/** @brief Count and print a failed condition, the test goes on. */
+#define CHECK(condition) do { if (!(condition)) { printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); Failures_g++; } } while (0)
+
+#pragma endregion
+
+/** @brief Stream over a fixed buffer, gives at most a slice per available() like a TCP segment or a file block. */
+class MemoryStream : public Stream
+{
+public:
+
+	MemoryStream(const char* data, size_t length, size_t slice) : _data(data), _length(length), _slice(slice) {}
+
+	int available() override
+	{
+		size_t LeftL = _length - _position;
+		return (int)((LeftL < _slice) ? LeftL : _slice);
+	}
+
+	int read() override
+	{
+		return (_position < _length) ? (uint8)_data[_position++] : -1;
+	}
+
+	int peek() override
+	{
+		return (_position < _length) ? (uint8)_data[_position] : -1;
+	}
+
+	size_t write(uint8_t data) override
+	{
+		(void)data;
+		return 0;
+	}
+
+	size_t readBytes(char* buffer, size_t length) override
+	{
+		// A short read, like a TCP segment or a file block.
+		return Stream::readBytes(buffer, (length < _slice) ? length : _slice);
+	}
+
+	/** @brief Add bytes at the end, for sources that grow while they are read.
+	 *  @param length size_t, New length.
+	 *  @return Void.
+	 */
+	void grow(size_t length)
+	{
+		_length = length;
+	}
+
+private:
+
+	const char* _data;
+	size_t _length;
+	size_t _slice;
+	size_t _position = 0;
+};
+
+/** @brief Print the outcome of the program.
+ *  @param name const char*, Name of the test.
+ *  @return int, Exit code, 0 when all checks passed.
+ */
+static inline int report(const char* name)
+{
+	if (Failures_g > 0)
+	{
+		printf("%s: %d check(s) failed\n", name, Failures_g);
+		return 1;
+	}
+
+	printf("%s: all checks passed\n", name);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,192 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include <vector>
+
+#include "ImageCodec.h"
+
+#include "HostTest.h"
+
+#pragma region Stubs
+
+/* @brief Debug port of the firmware. */
+NullPort Serial1;
+
+/** @brief Sink that keeps what is written. */
+class MemorySink : public Print
+{
+public:
+
+	using Print::write;
+
+	size_t write(uint8_t data) override
+	{
+		Data.push_back(data);
+		return 1;
+	}
+
+	/* @brief Written bytes. */
+	std::vector<uint8> Data;
+};
+
+#pragma endregion
+
+#pragma region Helpers
+
+/** @brief Compress a buffer and decompress it again.
+ *  @param data const std::vector<uint8>&, Original data.
+ *  @param writeSize size_t, Bytes per encoder write.
+ *  @param readSlice size_t, Bytes per source read while decoding.
+ *  @param packed uint32*, Compressed size, may be NULL.
+ *  @return bool, True when the output matches the input.
+ */
+static bool roundTrip(const std::vector<uint8>& data, size_t writeSize, size_t readSlice, uint32* packed)
+{
+	static LzssEncoder EncoderL;
+	static LzssStream DecoderL;
+	MemorySink SinkL;
+
+	EncoderL.begin(&SinkL);
+	for (size_t offset = 0; offset < data.size(); offset += writeSize)
+	{
+		size_t LengthL = data.size() - offset;
+		EncoderL.write(data.data() + offset, (LengthL < writeSize) ? LengthL : writeSize);
+	}
+	EncoderL.end();
+
+	CHECK(EncoderL.size() == SinkL.Data.size());
+	if (packed != NULL)
+	{
+		*packed = EncoderL.size();
+	}
+
+	MemoryStream SourceL((const char*)SinkL.Data.data(), SinkL.Data.size(), readSlice);
+	DecoderL.begin(&SourceL);
+
+	// Pages are taken with readBytes(), single bytes with read().
+	std::vector<uint8> OutputL;
+	char PageL[131];
+	size_t CountL;
+	while ((CountL = DecoderL.readBytes(PageL, sizeof(PageL))) > 0)
+	{
+		OutputL.insert(OutputL.end(), PageL, PageL + CountL);
+		int ByteL = DecoderL.read();
+		if (ByteL < 0)
+		{
+			break;
+		}
+		OutputL.push_back((uint8)ByteL);
+	}
+
+	CHECK(DecoderL.read() < 0);
+	CHECK(DecoderL.consumed() == SinkL.Data.size());
+
+	return OutputL == data;
+}
+
+#pragma endregion
+
+#pragma region Tests
+
+/** @brief Random data does not compress but survives.
+ *  @return Void.
+ */
+static void testRandom()
+{
+	std::vector<uint8> DataL(65536);
+	uint32 SeedL = 12345;
+	for (size_t index = 0; index < DataL.size(); index++)
+	{
+		SeedL = SeedL * 1103515245UL + 12345UL;
+		DataL[index] = (uint8)(SeedL >> 16);
+	}
+
+	uint32 PackedL = 0;
+	CHECK(roundTrip(DataL, 1460, LZSS_INPUT_SIZE, &PackedL));
+	// A flag byte per eight literals at worst.
+	CHECK(PackedL <= DataL.size() + (DataL.size() + 7) / 8);
+	CHECK(roundTrip(DataL, 1, 7, NULL));
+}
+
+/** @brief Erased flash, the common filler of an image, packs to almost nothing.
+ *  @return Void.
+ */
+static void testFilled()
+{
+	std::vector<uint8> DataL(32768, 0xFF);
+
+	uint32 PackedL = 0;
+	CHECK(roundTrip(DataL, 131, 1, &PackedL));
+	CHECK(PackedL < DataL.size() / 20);
+}
+
+/** @brief Repeats near and far in the window, and matches of every length.
+ *  @return Void.
+ */
+static void testRepetitive()
+{
+	std::vector<uint8> DataL;
+	for (uint16 run = 0; run < 400; run++)
+	{
+		for (uint16 index = 0; index < (run % (LZSS_MAX_MATCH + 3)) + 1; index++)
+		{
+			DataL.push_back((uint8)(index * 7 + (run & 3)));
+		}
+	}
+
+	// The same block again just inside and just outside of the window.
+	std::vector<uint8> BlockL(DataL.begin(), DataL.begin() + 300);
+	DataL.insert(DataL.end(), BlockL.begin(), BlockL.end());
+	DataL.insert(DataL.end(), LZSS_WINDOW_SIZE - 300, 0x00);
+	DataL.insert(DataL.end(), BlockL.begin(), BlockL.end());
+
+	uint32 PackedL = 0;
+	CHECK(roundTrip(DataL, 536, LZSS_INPUT_SIZE, &PackedL));
+	CHECK(PackedL < DataL.size() / 2);
+	CHECK(roundTrip(DataL, 3, 5, NULL));
+}
+
+/** @brief Short streams end cleanly.
+ *  @return Void.
+ */
+static void testShort()
+{
+	CHECK(roundTrip(std::vector<uint8>(), 1, 1, NULL));
+	CHECK(roundTrip(std::vector<uint8>(1, 0x42), 1, 1, NULL));
+	CHECK(roundTrip(std::vector<uint8>(LZSS_MIN_MATCH, 0x42), 1, 1, NULL));
+	CHECK(roundTrip(std::vector<uint8>(LZSS_MAX_MATCH * 2 + 1, 0x42), 1, 1, NULL));
+}
+
+#pragma endregion
+
+int main()
+{
+	testRandom();
+	testFilled();
+	testRepetitive();
+	testShort();
+
+	return report("ImageCodec");
+}
@@ -0,0 +1,208 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include <string>
+
+#include <zlib.h>
+
+#include "ImageWriter.h"
+
+#include "HostTest.h"
+
+extern "C" {
+#include "umm_malloc/umm_malloc.h"
+}
+
+#pragma region Stubs
+
+/* @brief Debug port of the firmware. */
+NullPort Serial1;
+
+/* @brief Heap statistics, GeneralHelper.cpp links against them. */
+UMM_HEAP_INFO ummHeapInfo;
+
+void* umm_info(void* ptr, int force)
+{
+	(void)force;
+	return ptr;
+}
+
+#pragma endregion
+
+#pragma region Helpers
+
+/* @brief File system of the tests. */
+static FS FileSystem_g;
+
+/** @brief Append an Intel HEX record with its checksum.
+ *  @param image std::string&, Image text.
+ *  @param type uint8, Record type.
+ *  @param address uint16, Address field.
+ *  @param length uint8, Data bytes.
+ *  @param value uint16, First word of the data, the rest is counted up from it.
+ *  @return Void.
+ */
+static void addRecord(std::string& image, uint8 type, uint16 address, uint8 length, uint16 value)
+{
+	uint8 DataL[256];
+	DataL[0] = (uint8)(value >> 8);
+	DataL[1] = (uint8)value;
+	for (uint16 index = 2; index < length; index++)
+	{
+		DataL[index] = (uint8)(index * 13);
+	}
+
+	char TextL[16];
+	uint8 SumL = length + (address >> 8) + (address & 0xFF) + type;
+	snprintf(TextL, sizeof(TextL), ":%02X%04X%02X", length, address, type);
+	image += TextL;
+
+	for (uint16 index = 0; index < length; index++)
+	{
+		snprintf(TextL, sizeof(TextL), "%02X", DataL[index]);
+		image += TextL;
+		SumL += DataL[index];
+	}
+
+	snprintf(TextL, sizeof(TextL), "%02X\r\n", (uint8)(0 - SumL));
+	image += TextL;
+}
+
+/** @brief Write an image in slices and close it.
+ *  @param image const std::string&, Image text.
+ *  @param slice size_t, Bytes per write.
+ *  @param writer ImageWriter&, Writer, kept for its properties.
+ *  @return Void.
+ */
+static void writeImage(const std::string& image, size_t slice, ImageWriter& writer)
+{
+	CHECK(writer.begin(&FileSystem_g, "/upload.tmp"));
+
+	for (size_t offset = 0; offset < image.size(); offset += slice)
+	{
+		size_t PartL = (image.size() - offset < slice) ? image.size() - offset : slice;
+		CHECK(writer.write((const uint8*)image.data() + offset, PartL) == PartL);
+	}
+
+	writer.close();
+	CHECK(!writer.hasFailed());
+	CHECK(writer.size() == image.size());
+
+	MemoryFile_t* FileL = FileSystem_g.content("/upload.tmp");
+	CHECK(FileL != NULL && std::string(FileL->Data.begin(), FileL->Data.end()) == image);
+}
+
+#pragma endregion
+
+#pragma region Tests
+
+/** @brief Records over both address extensions, the properties do not depend on how the upload is sliced. */
+static void testProperties()
+{
+	std::string ImageL;
+
+	// 0x0000 to 0x00FF in pages 0 and 1.
+	for (uint16 address = 0; address < 0x100; address += 16)
+	{
+		addRecord(ImageL, 0, address, 16, address);
+	}
+
+	// 0x017C to 0x0183 crosses from page 2 to page 3.
+	addRecord(ImageL, 0, 0x017C, 8, 0xA5A5);
+
+	// Segment 0x1000 puts 0x10010 in page 512, the first one above the page map.
+	addRecord(ImageL, 2, 0, 2, 0x1000);
+	addRecord(ImageL, 0, 0x0010, 4, 0x5A5A);
+
+	// Linear 0x0002 puts both records in page 1024, it is counted once.
+	addRecord(ImageL, 4, 0, 2, 0x0002);
+	addRecord(ImageL, 0, 0x0000, 16, 0x1234);
+	addRecord(ImageL, 0, 0x0010, 16, 0x5678);
+
+	addRecord(ImageL, 1, 0, 0, 0);
+
+	uint32 CrcL = (uint32)crc32(0L, (const Bytef*)ImageL.data(), (uInt)ImageL.size());
+
+	const size_t SlicesL[] = { 1, 7, 4096 };
+	for (size_t slice : SlicesL)
+	{
+		ImageWriter WriterL;
+		writeImage(ImageL, slice, WriterL);
+
+		const ImageInfo_t* InfoL = WriterL.info();
+		CHECK(InfoL->Crc32 == CrcL);
+		CHECK(InfoL->MinAddress == 0);
+		CHECK(InfoL->MaxAddress == 0x2001F);
+		CHECK(InfoL->UsedBytes == 256 + 8 + 4 + 32);
+		CHECK(InfoL->UsedPages == 6);
+		CHECK(WriterL.pages() == 6);
+		CHECK(InfoL->RecordTypes == ((1 << 0) | (1 << 1) | (1 << 2) | (1 << 4)));
+		CHECK(InfoL->FlashTime == ImageWriter::flashTime(6));
+	}
+}
+
+/** @brief A file without records has no addresses. */
+static void testNoRecords()
+{
+	std::string ImageL = "not an Intel HEX file\r\n";
+
+	ImageWriter WriterL;
+	writeImage(ImageL, 7, WriterL);
+
+	const ImageInfo_t* InfoL = WriterL.info();
+	CHECK(InfoL->Crc32 == (uint32)crc32(0L, (const Bytef*)ImageL.data(), (uInt)ImageL.size()));
+	CHECK(InfoL->MinAddress == 0);
+	CHECK(InfoL->MaxAddress == 0);
+	CHECK(InfoL->UsedBytes == 0);
+	CHECK(InfoL->UsedPages == 0);
+	CHECK(InfoL->RecordTypes == 0);
+}
+
+/** @brief Writes beyond the reservation are refused. */
+static void testReservation()
+{
+	std::string ImageL(100, '0');
+	ImageWriter WriterL;
+
+	CHECK(WriterL.begin(&FileSystem_g, "/upload.tmp"));
+	WriterL.setReserved(64);
+	CHECK(WriterL.write((const uint8*)ImageL.data(), 64) == 64);
+	CHECK(WriterL.write((const uint8*)ImageL.data(), 1) == 0);
+	CHECK(WriterL.hasFailed());
+
+	WriterL.discard();
+	CHECK(!FileSystem_g.exists("/upload.tmp"));
+}
+
+#pragma endregion
+
+int main()
+{
+	testProperties();
+	testNoRecords();
+	testReservation();
+
+	return report("ImageWriter");
+}
@@ -0,0 +1,205 @@
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#include "IntelHexParser.h"
+
+#include "HostTest.h"
+
+#pragma region Stubs
+
+/* @brief Debug port of the firmware. */
+NullPort Serial1;
+
+#pragma endregion
+
+#pragma region Helpers
+
+/** @brief Parser with guard bytes around it, a write past the page shows up in them.
+ */
+struct GuardedParser_t
+{
+	uint8 Before[16];
+	IntelHexParserClass Parser;
+	uint8 After[16];
+};
+
+/** @brief Check a record held in a string, without a terminator behind the line.
+ *  @param parser IntelHexParserClass*, Parser.
+ *  @param record const char*, The record.
+ *  @return bool, True when the parser takes it.
+ */
+static bool feed(IntelHexParserClass* parser, const char* record)
+{
+	static byte LineL[600];
+	size_t LengthL = strlen(record);
+
+	// Digits behind the line, a parser reading past it gets a valid looking record.
+	memset(LineL, '0', sizeof(LineL));
+	memcpy(LineL, record, LengthL);
+
+	if (!parser->IsRecordValid(LineL, LengthL))
+	{
+		return false;
+	}
+
+	parser->ParseLine(LineL);
+	return true;
+}
+
+/** @brief Write a data record.
+ *  @param text char*, Buffer of 48 characters.
+ *  @param address uint16, Load address.
+ *  @param length uint8, Data bytes, up to 16.
+ *  @return const char*, The record.
+ */
+static const char* dataRecord(char* text, uint16 address, uint8 length)
+{
+	uint8 SumL = length + (address >> 8) + (address & 0xFF);
+	int PositionL = sprintf(text, ":%02X%04X00", length, address);
+
+	for (uint8 index = 0; index < length; index++)
+	{
+		SumL += 0xA5;
+		PositionL += sprintf(text + PositionL, "A5");
+	}
+
+	sprintf(text + PositionL, "%02X", (uint8)(0x100 - SumL));
+
+	return text;
+}
+
+#pragma endregion
+
+#pragma region Tests
+
+/** @brief Well formed records pass.
+ *  @return Void.
+ */
+static void testValidRecords()
+{
+	IntelHexParserClass ParserL;
+	char TextL[48];
+
+	CHECK(feed(&ParserL, dataRecord(TextL, 0x0000, 16)));
+	CHECK(feed(&ParserL, ":00000001FF"));
+	CHECK(ParserL.IsEndOfFile());
+
+	// Lower case digits are valid too.
+	ParserL.Reset();
+	CHECK(feed(&ParserL, ":0400000001ab02034b"));
+}
+
+/** @brief Damaged records are refused before they are parsed.
+ *  @return Void.
+ */
+static void testDamagedRecords()
+{
+	IntelHexParserClass ParserL;
+
+	// Bad checksum.
+	CHECK(!feed(&ParserL, ":0400000001020304F1"));
+	// Length field beyond the line.
+	CHECK(!feed(&ParserL, ":FF00000001020304F5"));
+	// Length field short of the line.
+	CHECK(!feed(&ParserL, ":0300000001020304F2"));
+	// No start code.
+	CHECK(!feed(&ParserL, "00400000001020304F2"));
+	// Not a digit.
+	CHECK(!feed(&ParserL, ":04000000010203G4F2"));
+	// Too short.
+	CHECK(!feed(&ParserL, ":00000001F"));
+}
+
+/** @brief A record that runs over the page is refused, the parser memory stays untouched.
+ *  @return Void.
+ */
+static void testPageOverrun()
+{
+	static GuardedParser_t GuardedL;
+	memset(GuardedL.Before, 0x5A, sizeof(GuardedL.Before));
+	memset(GuardedL.After, 0x5A, sizeof(GuardedL.After));
+	GuardedL.Parser.Reset();
+
+	// A short record at a section boundary, then full ones.
+	char TextL[48];
+	uint16 AddressL = 0;
+	CHECK(feed(&GuardedL.Parser, dataRecord(TextL, AddressL, 10)));
+	AddressL += 10;
+
+	uint8 AcceptedL = 1;
+	while (feed(&GuardedL.Parser, dataRecord(TextL, AddressL, 16)))
+	{
+		AddressL += 16;
+		AcceptedL++;
+		if (AcceptedL > 16)
+		{
+			break;
+		}
+	}
+
+	// 10 + 7 * 16 bytes fit, the eighth full record would cross the page.
+	CHECK(AcceptedL == 8);
+	CHECK(!GuardedL.Parser.IsPageReady());
+
+	for (uint8 index = 0; index < sizeof(GuardedL.After); index++)
+	{
+		CHECK(GuardedL.Before[index] == 0x5A);
+		CHECK(GuardedL.After[index] == 0x5A);
+	}
+}
+
+/** @brief Pages come out at every 128 bytes of aligned data.
+ *  @return Void.
+ */
+static void testPages()
+{
+	IntelHexParserClass ParserL;
+	char TextL[48];
+	uint8 PagesL = 0;
+
+	for (uint16 address = 0; address < 512; address += 16)
+	{
+		CHECK(feed(&ParserL, dataRecord(TextL, address, 16)));
+		if (ParserL.IsPageReady())
+		{
+			CHECK(ParserL.GetMemoryPage()[0] == 0xA5);
+			PagesL++;
+		}
+	}
+
+	CHECK(PagesL == 4);
+}
+
+#pragma endregion
+
+int main()
+{
+	testValidRecords();
+	testDamagedRecords();
+	testPageOverrun();
+	testPages();
+
+	return report("IntelHexParser");
+}
@@ -0,0 +1,152 @@
+// FS.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _FS_STUB_h
+#define _FS_STUB_h
+
+/** @brief In memory file system of the host tests.
+ *  Files keep their content and the size of every write, so the tests can see how the data reached the flash.
+ */
+
+#pragma region Headers
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arduino.h"
+
+#pragma endregion
+
+#pragma region Structures
+
+/** @brief Content of a file in memory. */
+typedef struct {
+	std::vector<uint8> Data; ///< Bytes written.
+	std::vector<size_t> Writes; ///< Size of every write call.
+	size_t Capacity = SIZE_MAX; ///< Bytes the file takes before a write comes up short.
+} MemoryFile_t;
+
+#pragma endregion
+
+/** @brief Handle of an open file, copies share the content like on the device. */
+class File
+{
+public:
+
+	File() {}
+
+	File(std::shared_ptr<MemoryFile_t> content) : _content(content) {}
+
+	/** @brief Append to the file, short once the capacity is reached.
+	 *  @param data const uint8_t*, Data.
+	 *  @param len size_t, Length of the data.
+	 *  @return size_t, Written bytes.
+	 */
+	size_t write(const uint8_t* data, size_t len)
+	{
+		if (!_content)
+		{
+			return 0;
+		}
+
+		size_t RoomL = _content->Capacity - _content->Data.size();
+		size_t CountL = (len < RoomL) ? len : RoomL;
+		_content->Data.insert(_content->Data.end(), data, data + CountL);
+		_content->Writes.push_back(len);
+
+		return CountL;
+	}
+
+	size_t size()
+	{
+		return _content ? _content->Data.size() : 0;
+	}
+
+	void close()
+	{
+		_content.reset();
+	}
+
+	operator bool() const
+	{
+		return (bool)_content;
+	}
+
+private:
+
+	std::shared_ptr<MemoryFile_t> _content;
+};
+
+/** @brief Files by path. */
+class FS
+{
+public:
+
+	/** @brief Open a file, "w" creates it empty.
+	 *  @param path const char*, Path.
+	 *  @param mode const char*, Mode.
+	 *  @return File, Closed when the file does not exist.
+	 */
+	File open(const char* path, const char* mode)
+	{
+		if (mode[0] == 'w')
+		{
+			_files[path] = std::make_shared<MemoryFile_t>();
+		}
+
+		auto EntryL = _files.find(path);
+		return (EntryL == _files.end()) ? File() : File(EntryL->second);
+	}
+
+	bool exists(const char* path)
+	{
+		return _files.count(path) > 0;
+	}
+
+	bool remove(const char* path)
+	{
+		return _files.erase(path) > 0;
+	}
+
+	/** @brief Content of a file, for the checks.
+	 *  @param path const char*, Path.
+	 *  @return MemoryFile_t*, NULL when the file does not exist.
+	 */
+	MemoryFile_t* content(const char* path)
+	{
+		auto EntryL = _files.find(path);
+		return (EntryL == _files.end()) ? NULL : EntryL->second.get();
+	}
+
+private:
+
+	std::map<std::string, std::shared_ptr<MemoryFile_t>> _files;
+};
+
+#endif
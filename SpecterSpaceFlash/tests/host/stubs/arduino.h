@@ -0,0 +1,155 @@
+// arduino.h
+
+/*
+
+Copyright (c) [2019] [Orlin Dimitrov]
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+
+#ifndef _ARDUINO_STUB_h
+#define _ARDUINO_STUB_h
+
+/** @brief The few Arduino and ESP8266 core types the host tests need.
+ *  Only what the sources under test use, nothing allocates.
+ */
+
+#pragma region Headers
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdio.h>
+
+#include <string>
+
+#pragma endregion
+
+#pragma region Definitions
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int8_t int8;
+typedef uint8_t byte;
+typedef bool boolean;
+
+#pragma endregion
+
+/** @brief Output side of a stream. */
+class Print
+{
+public:
+
+	virtual ~Print() {}
+
+	virtual size_t write(uint8_t data) = 0;
+
+	/** @brief Write a buffer byte by byte.
+	 *  @param buffer const uint8_t*, Data.
+	 *  @param size size_t, Length of the data.
+	 *  @return size_t, Bytes written.
+	 */
+	virtual size_t write(const uint8_t* buffer, size_t size)
+	{
+		size_t CountL = 0;
+		while (CountL < size && write(buffer[CountL]) == 1)
+		{
+			CountL++;
+		}
+		return CountL;
+	}
+
+	/** @brief Debug output, dropped on the host.
+	 *  @return size_t, Always 0.
+	 */
+	size_t printf(const char* format, ...) { (void)format; return 0; }
+};
+
+/** @brief Input side of a stream. */
+class Stream : public Print
+{
+public:
+
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+	virtual void flush() {}
+
+	/** @brief Read up to length bytes, no timeout on the host.
+	 *  @param buffer char*, Destination.
+	 *  @param length size_t, Bytes wanted.
+	 *  @return size_t, Bytes read.
+	 */
+	virtual size_t readBytes(char* buffer, size_t length)
+	{
+		size_t CountL = 0;
+		int ByteL;
+		while (CountL < length && (ByteL = read()) >= 0)
+		{
+			buffer[CountL++] = (char)ByteL;
+		}
+		return CountL;
+	}
+};
+
+/** @brief Text of the core, only what GeneralHelper.cpp uses. */
+class String
+{
+public:
+
+	String(const char* text = "") : _text(text) {}
+
+	String(unsigned long value) : _text(std::to_string(value)) {}
+
+	String operator+(const char* text) const
+	{
+		return String((_text + text).c_str());
+	}
+
+	long toInt() const
+	{
+		return atol(_text.c_str());
+	}
+
+	const char* c_str() const
+	{
+		return _text.c_str();
+	}
+
+private:
+
+	std::string _text;
+};
+
+/* @brief Debug port of the firmware, prints nothing on the host. */
+class NullPort : public Print
+{
+public:
+
+	size_t write(uint8_t data) override { (void)data; return 1; }
+};
+
+extern NullPort Serial1;
+
+#endif